@@ -10,35 +10,88 @@
  * 
  */
 
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
 #include "pid.hpp"
 
-    /// @brief The Default constructor creates a Basic float-point PID controller
+// The object is its hot line, one line for the controllers in use, two for double
+static_assert(sizeof(pid_hot<float>) == PID_CACHE_LINE, "pid_hot<float> is one cache line");
+static_assert(sizeof(pid_hot<q15>) == PID_CACHE_LINE, "pid_hot<q15> is one cache line");
+static_assert(sizeof(pid_hot<q31>) == PID_CACHE_LINE, "pid_hot<q31> is one cache line");
+static_assert(sizeof(pid_hot<double>) == 2 * PID_CACHE_LINE, "pid_hot<double> is two cache lines");
+static_assert(sizeof(base_pid) == PID_CACHE_LINE, "base_pid is its hot line, the cold block is in the pool");
+static_assert(offsetof(pid_cold<float>, rate) == PID_CACHE_LINE, "The full step reads the first line of the cold block, a fixed-rate one the next");
+
+#define PID_COLD_CHUNK  64  // Blocks in the first chunk of the pool, every next one is twice as big
+#define PID_COLD_CHUNKS 26  // Chunks for the 2^31 slots of pid_hot::slot
+
+/// @brief The cold blocks of the controllers over T. The chunks never move once
+///        allocated, chunk k holds PID_COLD_CHUNK << k blocks, so a block is found
+///        from its slot with a bit scan and no lock; only taking and returning a
+///        slot lock the pool. The pool is constant-initialized and never destroyed,
+///        so controllers of static storage may be built and destroyed in any order.
+template <typename T>
+struct pid_cold_pool {
+    std::mutex lock;
+    pid_cold<T>* chunk[PID_COLD_CHUNKS] = {};
+    uint32_t used = 0;                          // Slots taken at least once
+    std::vector<uint32_t>* unused = nullptr;    // Slots returned
+
+    pid_cold<T>& at(uint32_t slot) const {
+        uint32_t p = slot + PID_COLD_CHUNK;
+        int k = 31 - __builtin_clz(p) - __builtin_ctz(PID_COLD_CHUNK);
+        return chunk[k][p - (PID_COLD_CHUNK << k)];
+    }
+
+    uint32_t take() {
+        std::lock_guard<std::mutex> guard(lock);
+        if (unused != nullptr && !unused->empty()) {
+            uint32_t slot = unused->back();
+            unused->pop_back();
+            return slot;
+        }
+        if (used == (1u << 31) - PID_COLD_CHUNK) {
+            throw std::bad_alloc();
+        }
+        uint32_t p = used + PID_COLD_CHUNK;
+        int k = 31 - __builtin_clz(p) - __builtin_ctz(PID_COLD_CHUNK);
+        if (chunk[k] == nullptr) {
+            chunk[k] = new pid_cold<T>[(size_t)PID_COLD_CHUNK << k];
+        }
+        return used++;
+    }
+
+    void give(uint32_t slot) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (unused == nullptr) {
+            unused = new std::vector<uint32_t>();
+        }
+        unused->push_back(slot);
+    }
+};
+
+template <typename T>
+static pid_cold_pool<T> cold_pool;
+
+/// @brief The state of pid_step as references into the hot line and the cold block
+template <typename T>
+struct pid_state_ref {
+    uint64_t& lts;  // The last calculation timestamp
+    T& Iterm;       // Integral term
+    T& lerr;        // The last calculated Error (sp - pv)
+    T& lco;         // The last calculated Control Output
+    bool& lman_on;  // The last run Manual Mode On/Off
+};
+
+    /// @brief The Default constructor creates a Basic PID controller
     ///        that unable to run without farther configuration
-    base_pid::base_pid() :
-        pv{nullptr},        // Process variable Input
-        sp{nullptr},        // Setpoint Input
-        tb{nullptr},        // Tieback Input, it directly drives the Controlthis Output in Manual mode
-        co{nullptr},        // Control Output
-
-        kp{0},              // Proportional Gain     
-        ki{0},              // Integral Gain, redused to usec by multiplying by 1.0e-6
-        kd{0},              // Differential Gain, redused to usec by multiplying by 1.0e+6
-        db{0},              // Deadband
-        pvll{-__FLT_MAX__}, // Process variable low limit
-        pvhl{__FLT_MAX__},  // Process variable high limit
-        spll{-__FLT_MAX__}, // Setpoint low limit
-        sphl{__FLT_MAX__},  // Setpoint high limit
-        coll{-__FLT_MAX__}, // Control output low limit
-        cohl{__FLT_MAX__},  // Control output high limit
-        dtmin{DT_MIN_PID},  // Minimum time interval between adjacent PID calculations expressed in usec
-        db_on{false},       // Deadband On/Off
-        man_on{true},       // Manual Mode On/Off
-
-        lts{0},             // The last calculation timestamp
-        lman_on{true},      // The last run Manual Mode On/Off  
-        Iterm{0},           // Integral term
-        lerr{0},             // The last calculated Error (sp - pv)
-        tmp_co{0}           // The last calculated Control Output
+    template <typename T>
+    basic_pid<T>::basic_pid() :
+        basic_pid(nullptr, nullptr, nullptr, nullptr)
         {};
 
     /// @brief The Simplified Constructor creates a basic float-point PID controller with minimal 
@@ -47,30 +100,9 @@
     /// @param psp  Setpoint pointer
     /// @param pco  Control output pointer
     /// @param ptie Tieback variable pointe, Default value is nullptr 
-    base_pid::base_pid(float* ppv, float* psp, float* pco, float* ptie) :
-        pv{ppv},            // Process variable Input
-        sp{psp},            // Setpoint Input
-        tb{ptie},           // Tieback Input, it directly drives the Controlthis Output in Manual mode
-        co{pco},            // Control Output
-        kp{0},              // Proportional Gain     
-        ki{0},              // Integral Gain, redused to usec by multiplying by 1.0e-6
-        kd{0},              // Differential Gain, redused to usec by multiplying by 1.0e+6
-        db{0},              // Deadband
-        pvll{-__FLT_MAX__}, // Process variable low limit
-        pvhl{__FLT_MAX__},  // Process variable high limit
-        spll{-__FLT_MAX__}, // Setpoint low limit
-        sphl{__FLT_MAX__},  // Setpoint high limit
-        coll{-__FLT_MAX__}, // Control output low limit
-        cohl{__FLT_MAX__},  // Control output high limit
-        dtmin{DT_MIN_PID},  // Minimum time interval between adjacent PID calculations expressed in usec
-        db_on{false},       // Deadband On/Off
-        man_on{true},       // Manual Mode On/Off
-
-        lts{0},             // The last calculation timestamp
-        lman_on{true},      // The last run Manual Mode On/Off  
-        Iterm{0},           // Integral term
-        lerr{0},            // The last calculated Error (sp - pv)
-        tmp_co{0}           // The last calculated Control Output
+    template <typename T>
+    basic_pid<T>::basic_pid(T* ppv, T* psp, T* pco, T* ptie) :
+        basic_pid(ppv, psp, pco, ptie, T(), T(), T(), T())
         {};
 
     /// @brief Constructor creates a basic float-point PID controller with full parameter set
@@ -91,43 +123,112 @@
     /// @param db_onv Deadband On/Off
     /// @param man_on Manual Mode On/Off
     /// @param dtminv Minimum time interval between adjacent PID calculations expressed in usec
-    base_pid::base_pid(float* ppv, float* psp, float* pco, float* ptie,
-                float kpv, float kiv, float kdv, float dbv,
-                float pvllv, float pvhlv,
-                float spllv, float sphlv,
-                float collv, float cohlv,
+    template <typename T>
+    basic_pid<T>::basic_pid(T* ppv, T* psp, T* pco, T* ptie,
+                T kpv, T kiv, T kdv, T dbv,
+                T pvllv, T pvhlv,
+                T spllv, T sphlv,
+                T collv, T cohlv,
                 bool db_onv, bool man_onv, uint64_t dtminv) :
-        pv{ppv},            // Process variable Input
-        sp{psp},            // Setpoint Input
-        tb{ptie},           // Tieback Input, it directly drives the Controlthis Output in Manual mode
-        co{pco},            // Control Output
-        kp{kpv},            // Proportional Gain     
-        ki{kiv*(float)1.0e-6},     // Integral Gain, redused to usec by multiplying by 1.0e-6
-        kd{kdv*(float)1.0e+6},     // Differential Gain, redused to usec by multiplying by 1.0e+6
-        db{dbv},            // Deadband
-        pvll{pvllv},        // Process variable low limit
-        pvhl{pvhlv},        // Process variable high limit
-        spll{spllv},        // Setpoint low limit
-        sphl{sphlv},        // Setpoint high limit
-        coll{collv},        // Control output low limit
-        cohl{cohlv},        // Control output high limit
-        dtmin{dtminv},      // Minimum time interval between adjacent PID calculations expressed in usec
-        db_on{db_onv},      // Deadband On/Off
-        man_on{man_onv},    // Manual Mode On/Off
-
-        lts{0},             // The last calculation timestamp
-        lman_on{true},      // The last run Manual Mode On/Off  
-        Iterm{0},           // Integral term
-        lerr{0},            // The last calculated Error (sp - pv)
-        tmp_co{0}           // The last calculated Control Output                
-        {};
+        hot{0,                  // The last calculation timestamp
+            nullptr,            // IO, set by refresh()
+            0,
+            0,
+            0,                  // Time Slice of a plain step, set by refresh()
+            kpv,                // Proportional Gain
+            traits::ki_in(kiv), // Integral Gain, redused to usec by multiplying by 1.0e-6
+            traits::kd_in(kdv), // Differential Gain, redused to usec by multiplying by 1.0e+6
+            collv,              // Control output low limit
+            cohlv,              // Control output high limit
+            T(),                // Integral term
+            T(),                // The last calculated Error (sp - pv)
+            T(),                // The last calculated Control Output
+            cold_pool<T>.take()}    // The cold block
+        {
+        cold() = pid_cold<T>{
+            ppv,            // Process variable Input
+            psp,            // Setpoint Input
+            ptie,           // Tieback Input, it directly drives the Controlthis Output in Manual mode
+            pco,            // Control Output
+            nullptr,        // Telemetry ring
+            nullptr,        // Execution-time statistics
+            dtminv,         // Minimum time interval between adjacent PID calculations expressed in usec
+            db_onv,         // Deadband On/Off
+            man_onv,        // Manual Mode On/Off
+            true,           // The last run Manual Mode On/Off
+            PID_EV_OFF,     // Every step reads PV and SP
+            true,           // The first step is never clean
+            false,          // CO hold of the last step
+            {DT_RATE_OFF, 0, T(), T(), false}, // Fixed-rate mode off
+            0,              // Steps rejected by the drift fault
+            dbv,            // Deadband
+            T(),            // Process variable of the last step
+            T(),            // Setpoint of the last step
+            pvllv,          // Process variable low limit
+            pvhlv,          // Process variable high limit
+            spllv,          // Setpoint low limit
+            sphlv};         // Setpoint high limit
+        refresh();
+        };
+
+        /// @brief The copy takes a cold block of its own and copies both parts
+        /// @param other - Controller to copy
+    template <typename T>
+    basic_pid<T>::basic_pid(const basic_pid& other) :
+        hot(other.hot)
+        {
+        hot.slot = cold_pool<T>.take();
+        cold() = other.cold();
+        };
+
+        /// @brief Copy both parts into the hot line and the cold block of this one
+        /// @param other - Controller to copy
+        /// @return This controller
+    template <typename T>
+    basic_pid<T>& basic_pid<T>::operator=(const basic_pid& other) {
+        uint32_t slot = hot.slot;
+        hot = other.hot;
+        hot.slot = slot;
+        cold() = other.cold();
+        return *this;
+    };
+
+    template <typename T>
+    basic_pid<T>::~basic_pid() {
+        cold_pool<T>.give(hot.slot);
+    };
+
+    template <typename T>
+    inline pid_cold<T>& basic_pid<T>::cold() const {
+        return cold_pool<T>.at(hot.slot);
+    };
+
+        /// @brief Point the hot line at the IO and keep its Time Slice for a plain step
+        ///        only, every other step goes the full path. *sp and *co are kept as
+        ///        byte offsets from *pv, IO further than 2 GiB apart is not plain.
+    template <typename T>
+    void basic_pid<T>::refresh() {
+        const pid_cold<T>& c = cold();
+        intptr_t sp_off = (intptr_t)((uintptr_t)c.sp - (uintptr_t)c.pv);
+        intptr_t co_off = (intptr_t)((uintptr_t)c.co - (uintptr_t)c.pv);
+        bool near = sp_off == (int32_t)sp_off && co_off == (int32_t)co_off;
+        bool plain = c.pv != nullptr && c.sp != nullptr && c.co != nullptr && near &&
+                     !c.db_on && !c.man_on && !c.lman_on && c.ev_mode == PID_EV_OFF && c.rate.period == DT_RATE_OFF &&
+                     c.tlm == nullptr && c.stats == nullptr && c.dtmin <= UINT32_MAX;
+        hot.pv = c.pv;
+        hot.sp_off = near ? (int32_t)sp_off : 0;
+        hot.co_off = near ? (int32_t)co_off : 0;
+        hot.dtmin = plain ? (uint32_t)c.dtmin : 0;
+    };
 
         /// @brief Get Process variable limits
         /// @param ll  - Referense to the Low Level limiter of the Process variable value 
         /// @param hl  - Referense to the High Level limiter of the Process variable value
-    void base_pid::get_pv_limits(float& ll, float& hl) {
-        ll = pvll;
-        hl = pvhl;
+    template <typename T>
+    void basic_pid<T>::get_pv_limits(T& ll, T& hl) {
+        const pid_cold<T>& cl = cold();
+        ll = cl.pvll;
+        hl = cl.pvhl;
     };
 
         /// @brief Get Process variable limits 
@@ -135,15 +236,17 @@
         /// @param hl  - Referense to the High Level limiter of the Process variable value
         /// @return 0  - O'k
         ///         -1 - Error
-    int base_pid::set_pv_limits(float& ll, float& hl) {
+    template <typename T>
+    int basic_pid<T>::set_pv_limits(T& ll, T& hl) {
+        pid_cold<T>& cl = cold();
         // Verify limits order
         if (hl < ll) {
-            pvll = hl;
-            pvhl = ll;
+            cl.pvll = hl;
+            cl.pvhl = ll;
             return -1;
         }
-        pvll = ll;
-        pvhl = hl;
+        cl.pvll = ll;
+        cl.pvhl = hl;
         return 0;
     };
 
@@ -151,9 +254,11 @@
         /// @brief Get Setpoint limits
         /// @param ll  - Referense to the Low Level limiter of the Setpoint variable value 
         /// @param hl  - Referense to the High Level limiter of the Setpoint variable value
-    void base_pid::get_sp_limits(float& ll, float& hl) {
-            ll = spll;
-            hl = sphl;
+    template <typename T>
+    void basic_pid<T>::get_sp_limits(T& ll, T& hl) {
+            const pid_cold<T>& cl = cold();
+            ll = cl.spll;
+            hl = cl.sphl;
     };
 
         /// @brief Set Setpoint limits
@@ -161,24 +266,27 @@
         /// @param hl  - Referense to the High Level limiter of the Process variable value
         /// @return 0  - O'k
         ///         -1 - Error
-    int base_pid::set_sp_limits(float& ll, float& hl) {
+    template <typename T>
+    int basic_pid<T>::set_sp_limits(T& ll, T& hl) {
+        pid_cold<T>& cl = cold();
         // Verify limits order
         if (hl < ll) {
-            spll = hl;
-            sphl = ll;
+            cl.spll = hl;
+            cl.sphl = ll;
             return -1;
         }
-        spll = ll;
-        sphl = hl;
+        cl.spll = ll;
+        cl.sphl = hl;
         return 0;
     };
 
         /// @brief Get Control Outputs limits
         /// @param ll  - Referense to the Low Level limiter of the Setpoint variable value 
         /// @param hl  - Referense to the High Level limiter of the Setpoint variable value
-    void base_pid::get_co_limits(float& ll, float& hl) {
-        ll = coll;
-        hl = cohl;
+    template <typename T>
+    void basic_pid<T>::get_co_limits(T& ll, T& hl) {
+        ll = hot.coll;
+        hl = hot.cohl;
     };
     
         /// @brief Set Control Outputs limits
@@ -186,15 +294,17 @@
         /// @param hl  - Referense to the High Level limiter of the Control output variable value
         /// @return 0  - O'k
         ///         -1 - Error
-    int base_pid::set_cp_limits(float& ll, float& hl) {
+    template <typename T>
+    int basic_pid<T>::set_cp_limits(T& ll, T& hl) {
         // Verify limits order
         if (hl < ll) {
-            coll = hl;
-            cohl = ll;
+            hot.coll = hl;
+            hot.cohl = ll;
             return -1;
         }
-        coll = ll;
-        cohl = hl;
+        hot.coll = ll;
+        hot.cohl = hl;
+        cold().dirty = true;
         return 0;
     };
     
@@ -202,10 +312,11 @@
         /// @param kpv - Referense to the Proportional Gain variable value 
         /// @param kiv - Referense to the Integer Gain variable value
         /// @param kdv - Referense to the Differential Gain variable value multiplified by 1.0e+6
-    void base_pid::get_gain_param(float& kpv, float& kiv, float& kdv) {
-        kpv = kp;
-        kiv = ki * 1.0e+6 ;
-        kdv = kd * 1.0e-6;
+    template <typename T>
+    void basic_pid<T>::get_gain_param(T& kpv, T& kiv, T& kdv) {
+        kpv = hot.kp;
+        kiv = traits::ki_get(hot.ki);
+        kdv = traits::kd_get(hot.kd);
     };
 
         /// @brief Set Gain parameters
@@ -214,25 +325,28 @@
         /// @param kdv  - Referense to the Differential Gain variable value
         /// @return 0  - O'k
         ///         -1 - Error
-    int base_pid::set_gain_param(float& kpv, float& kiv, float& kdv) {
+    template <typename T>
+    int basic_pid<T>::set_gain_param(T& kpv, T& kiv, T& kdv) {
         // Check values 
-        if ( kpv < -__FLT_MAX__ || kpv > __FLT_MAX__ ||
-             kiv < -__FLT_MAX__ || kiv > __FLT_MAX__ || 
-             kdv < -(__FLT_MAX__ * 1.0e-6) || kpv > (__FLT_MAX__ * 1.0e-6)) {
+        if (!traits::gains_valid(kpv, kiv, kdv)) {
                 return -1;
         }
-        kp = kpv;
-        ki = kiv * 1.0e-6;
-        kd = kdv * 1.0e+6;
+        hot.kp = kpv;
+        hot.ki = traits::ki_set(kiv);
+        hot.kd = traits::kd_set(kdv);
+        rate_update();
+        cold().dirty = true;
         return 0;
     };
 
         /// @brief Get Deadband parameters
         /// @param dbv - Referense to the Deadband variable value 
         /// @param db_onv - Referense to the Deadband mode switch
-    void base_pid::get_db_param(float& dbv, bool& db_onv) {
-        dbv = db;
-        db_onv = db_on;
+    template <typename T>
+    void basic_pid<T>::get_db_param(T& dbv, bool& db_onv) {
+        const pid_cold<T>& cl = cold();
+        dbv = cl.db;
+        db_onv = cl.db_on;
     };
 
         /// @brief Set Deadband parameters
@@ -240,125 +354,465 @@
         /// @param db_onv - Referense to the Deadband mode switch
         /// @return 0  - O'k
         ///         -1 - Error
-    int base_pid::set_db_param(float& dbv, bool& db_onv) {
-        if (dbv < -__FLT_MAX__ || dbv > __FLT_MAX__) {
+    template <typename T>
+    int basic_pid<T>::set_db_param(T& dbv, bool& db_onv) {
+        if (!traits::db_valid(dbv)) {
             return -1;
         }
-        db = dbv;
-        db_on = db_onv;
+        pid_cold<T>& cl = cold();
+        cl.db = dbv;
+        cl.db_on = db_onv;
+        cl.dirty = true;
+        refresh();
         return 0;
     }
 
         /// @brief Get Manual mode parameter
         /// @param man_onv - Referense to the Manual mode switch
-    void base_pid::get_man_param(bool& man_onv) {
-        man_onv = man_on;
+    template <typename T>
+    void basic_pid<T>::get_man_param(bool& man_onv) {
+        man_onv = cold().man_on;
     };
 
         /// @brief Set Manual mode parameter
         /// @param man_onv - Referense to the Manual mode switch
-    void base_pid::set_man_param(bool& man_onv) {
-        man_on = man_onv;
+    template <typename T>
+    void basic_pid<T>::set_man_param(bool& man_onv) {
+        cold().man_on = man_onv;
+        refresh();
     };
 
         /// @brief Get Time Slice parameter
         /// @param dtminv - Referense to the Time Slice parameter expressed in usec
-    void base_pid::get_dtmin_param(uint64_t& dtminv) {
-        dtminv = dtmin;
+    template <typename T>
+    void basic_pid<T>::get_dtmin_param(uint64_t& dtminv) {
+        dtminv = cold().dtmin;
     };
 
         /// @brief Set Time Slice parameter, 1 usec or more
         /// @param dtminv - Referense to the Time Slice parameter
         /// @return 0  - O'k
         ///         -1 - Error
-    int base_pid::set_dtmin_param(uint64_t& dtminv) {
-        dtmin = dtminv;
-        if (dtmin == 0) {
-            dtmin++;
+    template <typename T>
+    int basic_pid<T>::set_dtmin_param(uint64_t& dtminv) {
+        pid_cold<T>& cl = cold();
+        cl.dtmin = dtminv;
+        if (cl.dtmin == 0) {
+            cl.dtmin++;
+            refresh();
             return -1;
         }
+        refresh();
         return 0;
     };
 
-        /// @brief Process Basic float-point PID controller calclation 
-        /// @param tstamp - Time, when the calculation is performed
+        /// @brief Get Fixed-rate parameters
+        /// @param periodv      - Referense to the period expressed in usec, DT_RATE_OFF if off
+        /// @param driftv       - Referense to the largest accepted |dt - period| expressed in usec
+        /// @param drift_faultv - Referense to the drift fault switch
+    template <typename T>
+    void basic_pid<T>::get_rate_param(uint64_t& periodv, uint64_t& driftv, bool& drift_faultv) {
+        const pid_rate<T>& rate = cold().rate;
+        periodv = rate.period;
+        driftv = rate.drift;
+        drift_faultv = rate.drift_fault;
+    };
+
+        /// @brief Set Fixed-rate parameters. A loop called on a strict period steps with
+        ///        ki * period and kd / period computed here and on every gain change, so
+        ///        the step has no division and no dt conversion. A step whose dt is more
+        ///        than driftv away from the period runs on the measured dt, or, with
+        ///        drift_faultv, holds CO, counts a rate fault and returns -1.
+        /// @param periodv      - Referense to the period expressed in usec, DT_RATE_OFF turns the mode off
+        /// @param driftv       - Referense to the largest accepted |dt - period| expressed in usec
+        /// @param drift_faultv - Referense to the drift fault switch
         /// @return 0  - O'k
-        ///         -1 - Error
-    int base_pid::run_pid(uint64_t tstamp) {
-        // Check process variables
-        if (pv == nullptr || sp == nullptr || co == nullptr) {
+        ///         -1 - Error, the tolerance is not below the period
+    template <typename T>
+    int basic_pid<T>::set_rate_param(uint64_t& periodv, uint64_t& driftv, bool& drift_faultv) {
+        if (periodv != DT_RATE_OFF && driftv >= periodv) {
             return -1;
         }
+        pid_cold<T>& cl = cold();
+        cl.rate.period = periodv;
+        cl.rate.drift = driftv;
+        cl.rate.drift_fault = drift_faultv;
+        rate_update();
+        cl.dirty = true;
+        refresh();
+        return 0;
+    };
 
-        // Check dtmin param
-        if (dtmin == 0) {
-            dtmin == 1;
+        /// @brief Get Change-driven mode parameter
+        /// @param ev_modev - Referense to the mode, PID_EV_*
+    template <typename T>
+    void basic_pid<T>::get_event_param(uint8_t& ev_modev) {
+        ev_modev = cold().ev_mode;
+    };
+
+        /// @brief Set Change-driven mode parameter. A clean step, one with the inputs of
+        ///        the last step, reuses the last error, so the D term is 0 and only the
+        ///        integrator moves; once a clean step found CO held by the Deadband, the
+        ///        anti-windup or ki == 0, the clean steps after it only keep CO. The outputs
+        ///        are the same as with PID_EV_OFF. PID_EV_COMPARE compares *pv and *sp with
+        ///        the last ones, PID_EV_DIRTY trusts the IO layer to call set_dirty() after
+        ///        it writes them. Every setter makes the next step a full one.
+        /// @param ev_modev - Referense to the mode, PID_EV_*
+        /// @return 0  - O'k
+        ///         -1 - Error, unknown mode
+    template <typename T>
+    int basic_pid<T>::set_event_param(uint8_t& ev_modev) {
+        if (ev_modev > PID_EV_DIRTY) {
             return -1;
         }
+        pid_cold<T>& cl = cold();
+        cl.ev_mode = ev_modev;
+        cl.dirty = true;
+        refresh();
+        return 0;
+    };
 
-        // Only update CO if no minimal time slice elapsed
-        tmp_dt = tstamp - lts;
-        if (tmp_dt < dtmin) {
-            *co = tmp_co; 
-            return 0;
-        } 
-
-        // Update lts
-        lts = tstamp;
-
-        // Tieback drives CO if Manual mode is enabled, but CO limits still apply.
-        if (man_on) {
-            // Check Tieback connection 
-            tmp_co = (tb == nullptr) ? 0 : *tb;
-            tmp_co = (tmp_co < coll) ? coll : (tmp_co > cohl) ? cohl : tmp_co;
-            *co = tmp_co;
-            lman_on = true;     // For future bumpless switching back
-            return 0;
+    template <typename T>
+    void basic_pid<T>::rate_update() {
+        pid_rate<T>& rate = cold().rate;
+        if (rate.period != DT_RATE_OFF) {
+            rate.ki_dt = traits::ki_rate(hot.ki, rate.period);
+            rate.kd_dt = traits::kd_rate(hot.kd, rate.period);
         }
+    };
+
+        /// @brief Get all tuning parameters
+        /// @param p - Referense to the parameter block
+    template <typename T>
+    void basic_pid<T>::get_params(pid_params<T>& p) {
+        const pid_cold<T>& cl = cold();
+        get_gain_param(p.kp, p.ki, p.kd);
+        p.db = cl.db;
+        p.pvll = cl.pvll;
+        p.pvhl = cl.pvhl;
+        p.spll = cl.spll;
+        p.sphl = cl.sphl;
+        p.coll = hot.coll;
+        p.cohl = hot.cohl;
+        p.dtmin = cl.dtmin;
+        p.db_on = cl.db_on;
+    };
 
-        // Run bumpless if we come from Manual mode
-        if (lman_on) {
-            lman_on = false;
-            // Set Iterm to the last co value
-            Iterm = tmp_co; 
+        /// @brief Set all tuning parameters at once. The block is checked as a whole and
+        ///        either applied in full or not at all, so a rejected block never leaves
+        ///        a mix of old and new values.
+        /// @param p - Referense to the parameter block
+        /// @return 0  - O'k
+        ///         -1 - Error, nothing is changed
+    template <typename T>
+    int basic_pid<T>::set_params(const pid_params<T>& p) {
+        if (!pid_params_valid(p)) {
+            return -1;
         }
+        pid_cold<T>& cl = cold();
+        hot.kp = p.kp;
+        hot.ki = traits::ki_set(p.ki);
+        hot.kd = traits::kd_set(p.kd);
+        cl.db = p.db;
+        cl.pvll = p.pvll;
+        cl.pvhl = p.pvhl;
+        cl.spll = p.spll;
+        cl.sphl = p.sphl;
+        hot.coll = p.coll;
+        hot.cohl = p.cohl;
+        cl.dtmin = p.dtmin;
+        cl.db_on = p.db_on;
+        rate_update();
+        cl.dirty = true;
+        refresh();
+        return 0;
+    };
+
+        /// @brief Get the dynamic state
+        /// @param st - Referense to the state
+    template <typename T>
+    void basic_pid<T>::get_state(pid_state<T>& st) {
+        st.lts = hot.lts;
+        st.Iterm = hot.Iterm;
+        st.lerr = hot.lerr;
+        st.lco = hot.lco;
+        st.lman_on = cold().lman_on;
+    };
 
-        // Now we are ready to calculate the new co value
-        tmp_err = *sp - *pv;
+        /// @brief Set the dynamic state, the next step continues from it as if the
+        ///        controller had never stopped
+        /// @param st - Referense to the state
+    template <typename T>
+    void basic_pid<T>::set_state(const pid_state<T>& st) {
+        hot.lts = st.lts;
+        hot.Iterm = st.Iterm;
+        hot.lerr = st.lerr;
+        hot.lco = st.lco;
+        pid_cold<T>& cl = cold();
+        cl.lman_on = st.lman_on;
+        cl.dirty = true;
+        refresh();
+    };
+
+        /// @brief Number of steps rejected by the drift fault
+        /// @return The count
+    template <typename T>
+    uint64_t basic_pid<T>::get_rate_faults() {
+        return cold().rate_faults;
+    };
+
+        /// @brief The IO layer wrote a new PV or SP, the next step is not clean
+    template <typename T>
+    void basic_pid<T>::set_dirty() {
+        cold().dirty = true;
+    };
+
+        /// @brief Attach a telemetry ring, nullptr detaches it
+        /// @param ptlm - Telemetry ring
+    template <typename T>
+    void basic_pid<T>::set_telemetry(pid_telemetry<T>* ptlm) {
+        cold().tlm = ptlm;
+        refresh();
+    };
+
+        /// @brief Attach execution-time statistics, nullptr detaches them
+        /// @param pstats - Statistics
+    template <typename T>
+    void basic_pid<T>::set_stats(pid_stats* pstats) {
+        cold().stats = pstats;
+        refresh();
+    };
+
+        /// @brief Process Basic PID controller calclation. A plain controller steps over
+        ///        its hot line alone, any other takes the full path over its cold block.
+        /// @param tstamp - Time, when the calculation is performed
+        /// @return 0  - O'k
+        ///         -1 - Error
+    template <typename T>
+    int basic_pid<T>::run_pid(uint64_t tstamp) {
+        if (hot.dtmin != 0) {
+            return plain_step(tstamp);
+        }
+        return run_full(tstamp);
+    };
 
-        // Skip further calculations if Deadband is Enabled
-        // and we are in the Deadband region 
-        if (db_on && tmp_err < db) {
-            lerr = tmp_err;
-            *co = tmp_co;
+        /// @brief The step of a plain controller: Auto mode, no Deadband and no other
+        ///        mode and no bumpless transfer due, so pid_step runs on the hot line with
+        ///        switches that are constants and its branches fold away. *sp and *co are
+        ///        at their offsets from *pv, every pointer is checked by refresh().
+        /// @param tstamp - Time, when the calculation is performed
+        /// @return 0  - O'k
+    template <typename T>
+    inline int basic_pid<T>::plain_step(uint64_t tstamp) {
+        T* co = (T*)((uintptr_t)hot.pv + (uintptr_t)(intptr_t)hot.co_off);
+        // Only update CO if no minimal time slice elapsed, as pid_step would, before
+        // the inputs are read
+        if (tstamp - hot.lts < hot.dtmin) {
+            *co = hot.lco;
             return 0;
         }
+        const T* sp = (const T*)((uintptr_t)hot.pv + (uintptr_t)(intptr_t)hot.sp_off);
+        pid_step_config<T> c{hot.dtmin, hot.kp, hot.ki, hot.kd, T(), hot.coll, hot.cohl, false, false};
+        bool lman_on = false;
+        pid_state_ref<T> s{hot.lts, hot.Iterm, hot.lerr, hot.lco, lman_on};
+        *co = pid_step(c, s, pid_inputs<T>{tstamp, *hot.pv, *sp, T(), false, false}).co;
+        return 0;
+    };
+
+        /// @brief run_pid of a controller that is not plain, with or without telemetry
+        ///        and statistics
+        /// @param tstamp - Time, when the calculation is performed
+        /// @return 0  - O'k
+        ///         -1 - Error
+    template <typename T>
+    int basic_pid<T>::run_full(uint64_t tstamp) {
+        pid_cold<T>& cl = cold();
+        if (cl.stats == nullptr) {
+            return (cl.tlm == nullptr) ? run_step<false>(cl, tstamp) : run_step<true>(cl, tstamp);
+        }
+        if (cl.stats->call()) {
+            return run_timed(cl, tstamp);
+        }
+        return (cl.tlm == nullptr) ? run_step<false, true>(cl, tstamp) : run_step<true, true>(cl, tstamp);
+    };
 
-        // Add Proportional kick
-        tmp_co = kp * tmp_err;
+        /// @brief run_pid timed with the steady clock, one call out of the sampling rate
+        ///        of the statistics takes this path
+        /// @param cl     - Cold block of the controller
+        /// @param tstamp - Time, when the calculation is performed
+        /// @return 0  - O'k
+        ///         -1 - Error
+    template <typename T>
+    int basic_pid<T>::run_timed(pid_cold<T>& cl, uint64_t tstamp) {
+        uint64_t lts_prev = hot.lts;
+        uint64_t t0 = pid_stats::now_ns();
+        int rc = (cl.tlm == nullptr) ? run_step<false, true>(cl, tstamp) : run_step<true, true>(cl, tstamp);
+        cl.stats->timed(pid_stats::now_ns() - t0);
+        // Only a step moves lts, the first one has no previous step to be late from
+        if (hot.lts != lts_prev && lts_prev != 0) {
+            cl.stats->timed_step(tstamp - lts_prev - cl.dtmin);
+        }
+        return rc;
+    };
 
-        // Add Dterm and update lerr
-        tmp_co += kd * (tmp_err - lerr) / (float)tmp_dt;
-        lerr = tmp_err;
+        /// @brief Run the controller over a recorded trace, the outputs are bit-identical to
+        ///        run_pid called once per sample. The state is written back at the end,
+        ///        *pv, *sp and *co are not touched and Tieback is read from *tb as usual.
+        /// @param t   - Times of the samples
+        /// @param pvv - Process variable samples
+        /// @param spv - Setpoint samples
+        /// @param cov - Control Output of every sample
+        /// @param n   - Number of samples
+        /// @return 0  - O'k
+        ///         -1 - Error, a null array or a step returned an error
+    template <typename T>
+    int basic_pid<T>::process(const uint64_t* t, const T* pvv, const T* spv, T* cov, size_t n) {
+        if (n != 0 && (t == nullptr || pvv == nullptr || spv == nullptr || cov == nullptr)) {
+            return -1;
+        }
+        return (cold().tlm == nullptr) ? replay<false>(t, pvv, spv, cov, n) : replay<true>(t, pvv, spv, cov, n);
+    };
 
-        // Process Iterm
-        // Reset Iterm if ki == 0
-        if (ki == 0) {
-            Iterm = 0;
+        /// @brief Steps of process(). They run on a copy of the controller on the stack,
+        ///        pointed at locals for its IO, whose addresses never escape the untraced
+        ///        loop, so the compiler keeps the state in registers instead of reloading
+        ///        it after every store to cov. A plain copy takes the plain step.
+    template <typename T>
+    template <bool traced>
+    int basic_pid<T>::replay(const uint64_t* t, const T* pvv, const T* spv, T* cov, size_t n) {
+        basic_pid<T> c(*this);
+        pid_cold<T>& ccl = c.cold();
+        // A step that fails leaves CO as it was, as run_pid leaves *co
+        T io[3];
+        io[2] = (ccl.co != nullptr) ? *ccl.co : c.hot.lco;
+        ccl.pv = &io[0];
+        ccl.sp = &io[1];
+        ccl.co = &io[2];
+        c.refresh();
+        int rc = 0;
+        for (size_t k = 0; k < n; k++) {
+            io[0] = pvv[k];
+            io[1] = spv[k];
+            if (!traced && c.hot.dtmin != 0) {
+                rc |= c.plain_step(t[k]);
+            }
+            else {
+                rc |= c.template run_step<traced>(ccl, t[k]);
+            }
+            cov[k] = io[2];
+        }
+        const pid_cold<T>& cl = cold();
+        ccl.pv = cl.pv;
+        ccl.sp = cl.sp;
+        ccl.co = cl.co;
+        *this = c;
+        refresh();
+        return rc;
+    };
+
+        /// @brief One PID step over the hot line and the cold block, traced pushes the
+        ///        internals to the telemetry ring and counted counts the step in the
+        ///        statistics, the untraced step carries no telemetry or statistics code at
+        ///        all. The calculation is pid_step, the change-driven mode is kept around it.
+        /// @param cl     - Cold block of the controller
+        /// @param tstamp - Time, when the calculation is performed
+        /// @return 0  - O'k
+        ///         -1 - Error
+    template <typename T>
+    template <bool traced, bool counted>
+    int basic_pid<T>::run_step(pid_cold<T>& cl, uint64_t tstamp) {
+        // Check process variables
+        if (cl.pv == nullptr || cl.sp == nullptr || cl.co == nullptr) {
+            return -1;
+        }
+
+        // Check dtmin param
+        if (cl.dtmin == 0) {
+            return -1;
+        }
+
+        // Only update CO if no minimal time slice elapsed, as pid_step would, before
+        // the inputs are read
+        if (tstamp - hot.lts < cl.dtmin) {
+            *cl.co = hot.lco;
+            if constexpr (counted) {
+                cl.stats->skip();
+            }
+            return 0;
+        }
+
+        pid_inputs<T> in{tstamp, *cl.pv, *cl.sp, (cl.man_on && cl.tb != nullptr) ? *cl.tb : T(), false, false};
+        pid_step_config<T> c{cl.dtmin, hot.kp, hot.ki, hot.kd, cl.db, hot.coll, hot.cohl, cl.db_on, cl.man_on};
+        const pid_rate<T>* rate = (cl.rate.period != DT_RATE_OFF) ? &cl.rate : nullptr;
+        uint64_t lts_prev = hot.lts;
+        bool lman_prev = cl.lman_on;
+        pid_outputs<T> o;
+        if (cl.ev_mode == PID_EV_OFF) {
+            pid_state_ref<T> s{hot.lts, hot.Iterm, hot.lerr, hot.lco, cl.lman_on};
+            o = pid_step<traced>(c, s, in, rate);
         }
         else {
-            // Add the last Iterm, calculate Iterm delta,
-            // and check results against the limits (anti-windup)
-            d_iterm = ki * tmp_err * (float)tmp_dt;
-            tmp_co += Iterm;
-            if (!((tmp_co > cohl && d_iterm > 0) ||
-                (tmp_co < coll && d_iterm < 0))) {
-                tmp_co += d_iterm;
-                Iterm  += d_iterm; 
+            o = event_step(cl, c, in, rate);
+        }
+        *cl.co = o.co;
+        // The bumpless transfer is done, the next step may be plain
+        if (cl.lman_on != lman_prev) {
+            refresh();
+        }
+        if constexpr (counted) {
+            if (lts_prev != 0) {
+                cl.stats->step(o.dt - cl.dtmin);
             }
         }
-        // Check results against limits and set Control output
-        tmp_co = (tmp_co < coll) ? coll : (tmp_co > cohl) ? cohl : tmp_co;
-        *co = tmp_co;
-        return 0;
+        if (o.rc != 0) {
+            cl.rate_faults++;
+        }
+        if constexpr (traced) {
+            trace(cl, tstamp, o);
+        }
+        return o.rc;
     };
+
+        /// @brief The change-driven step. A clean step has the inputs of the last step; if it
+        /// also comes after a clean step that left CO held, pid_step only keeps CO
+        /// @param cl   - Cold block of the controller
+        /// @param c    - Configuration of the step
+        /// @param in   - Inputs of the step, clean and hold are set here
+        /// @param rate - Fixed-rate coefficients, nullptr when off
+        /// @return Outputs of the step
+    template <typename T>
+    pid_outputs<T> basic_pid<T>::event_step(pid_cold<T>& cl, const pid_step_config<T>& c, pid_inputs<T>& in, const pid_rate<T>* rate) {
+        // Once the Deadband, ki == 0 or the anti-windup kept a clean step from moving
+        // the integrator, nothing moves until the inputs change
+        in.clean = !cl.dirty && (cl.ev_mode == PID_EV_DIRTY || (in.pv == cl.lpv && in.sp == cl.lsp));
+        in.hold = in.clean && cl.lhold;
+        pid_state_ref<T> s{hot.lts, hot.Iterm, hot.lerr, hot.lco, cl.lman_on};
+        pid_outputs<T> o = pid_step<true>(c, s, in, rate);
+        if (o.rc == 0 && !(o.flags & PID_TLM_MANUAL)) {
+            cl.dirty = false;
+            if (o.flags & PID_TLM_CLEAN) {
+                cl.lhold = cl.lhold || (o.flags & (PID_TLM_DEADBAND | PID_TLM_WINDUP)) || hot.ki == T();
+            }
+            else {
+                cl.lpv = in.pv;
+                cl.lsp = in.sp;
+                cl.lhold = false;
+            }
+        }
+        return o;
+    };
+
+        /// @brief Push the internals of the step to the telemetry ring
+        /// @param cl     - Cold block of the controller
+        /// @param tstamp - Time of the step
+        /// @param o      - Outputs of the step
+    template <typename T>
+    void basic_pid<T>::trace(const pid_cold<T>& cl, uint64_t tstamp, const pid_outputs<T>& o) {
+        cl.tlm->push(pid_sample<T>{tstamp, o.dt, 0, o.flags, o.err, o.p, o.d, o.di, hot.Iterm, hot.lco});
+    };
+
+// Supported arithmetic types
+template class basic_pid<float>;
+template class basic_pid<double>;
+template class basic_pid<q15>;
+template class basic_pid<q31>;
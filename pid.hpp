@@ -11,84 +11,488 @@
 #ifndef _PID_H
 #define _PID_H
 
+#include <cstddef>
 #include <cstdint>
+#include <limits>
+
+#include "pid_alloc.hpp"
+#include "pid_fixed.hpp"
+#include "pid_stats.hpp"
+#include "pid_telemetry.hpp"
 
 #define DT_MIN_PID 10 // Minimal PID time slice expressed in us
+#define DT_RATE_OFF 0 // Fixed-rate period of a controller that runs on the measured dt
+
+// Change-driven modes
+#define PID_EV_OFF     0 // Every step reads PV and SP
+#define PID_EV_COMPARE 1 // A step whose PV and SP equal those of the last step is clean
+#define PID_EV_DIRTY   2 // A step is clean unless set_dirty() was called since the last one
+
+/// @brief Arithmetic of the PID controller for a floating-point type.
+///        The internal gains are reduced to usec: ki by 1.0e-6, kd by 1.0e+6.
+template <typename T>
+struct pid_traits {
+    static T max() { return std::numeric_limits<T>::max(); }
+    static T lowest() { return std::numeric_limits<T>::lowest(); }
+
+    // Gain scaling of the full constructor
+    static T ki_in(T kiv) { return kiv*(T)1.0e-6; }
+    static T kd_in(T kdv) { return kdv*(T)1.0e+6; }
+
+    // Gain scaling of the setters and getters, done in double
+    static T ki_set(T kiv) { return kiv * 1.0e-6; }
+    static T kd_set(T kdv) { return kdv * 1.0e+6; }
+    static T ki_get(T ki) { return ki * 1.0e+6; }
+    static T kd_get(T kd) { return kd * 1.0e-6; }
+
+    // Gain and Deadband limits accepted by the setters, NaN is rejected
+    static bool gains_valid(T kpv, T kiv, T kdv) {
+        return (kpv >= -max()) & (kpv <= max()) &
+               (kiv >= -max()) & (kiv <= max()) &
+               (kdv >= -(max() * 1.0e-6)) & (kdv <= (max() * 1.0e-6));
+    }
+    static bool db_valid(T dbv) { return (dbv >= lowest()) & (dbv <= max()); }
+
+    /// @brief Dterm, kd * (err - lerr) / dt
+    static T dterm(T kd, T derr, uint64_t dt) { return kd * derr / (T)dt; }
+
+    /// @brief Iterm delta, ki * err * dt
+    static T iterm(T ki, T err, uint64_t dt) { return ki * err * (T)dt; }
+
+    /// @brief Fixed-rate coefficients, ki * dt and kd / dt
+    static T ki_rate(T ki, uint64_t dt) { return ki * (T)dt; }
+    static T kd_rate(T kd, uint64_t dt) { return kd / (T)dt; }
+};
+
+/// @brief Arithmetic of the PID controller for a Q-format type. Gains are kept
+///        unscaled, ki per second and kd in seconds, so they stay representable;
+///        the usec time base is applied in 64-bit intermediates that saturate.
+///        All gains and signals must fit the Q range, e.g. [-1, 1) for q15/q31.
+template <typename Raw, int Frac>
+struct pid_traits<q_fixed<Raw, Frac>> {
+    typedef q_fixed<Raw, Frac> T;
+
+    static T max() { return T::max(); }
+    static T lowest() { return T::lowest(); }
+
+    static T ki_in(T kiv) { return kiv; }
+    static T kd_in(T kdv) { return kdv; }
+    static T ki_set(T kiv) { return kiv; }
+    static T kd_set(T kdv) { return kdv; }
+    static T ki_get(T ki) { return ki; }
+    static T kd_get(T kd) { return kd; }
+
+    // Every Q value is in range
+    static bool gains_valid(T, T, T) { return true; }
+    static bool db_valid(T) { return true; }
+
+    /// @brief Dterm, kd * (err - lerr) * 1.0e+6 / dt
+    static T dterm(T kd, T derr, uint64_t dt) {
+        int64_t q = ((int64_t)kd.v * derr.v) >> Frac;
+        if (dt > (uint64_t)INT64_MAX) {
+            return T();
+        }
+        return T::from_raw(T::sat(q * 1000000 / (int64_t)dt));
+    }
+
+    /// @brief Iterm delta, ki * err * dt * 1.0e-6
+    static T iterm(T ki, T err, uint64_t dt) {
+        int64_t q = ((int64_t)ki.v * err.v) >> Frac;
+        uint64_t sec = dt / 1000000;
+        if (sec > (uint64_t)INT32_MAX) {
+            return (q == 0) ? T() : (q > 0) ? T::max() : T::lowest();
+        }
+        return T::from_raw(T::sat(q * (int64_t)sec + q * (int64_t)(dt % 1000000) / 1000000));
+    }
+
+    /// @brief Fixed-rate coefficients, ki * dt * 1.0e-6 and kd * 1.0e+6 / dt, saturated.
+    ///        They are computed when the gains change, so the double arithmetic stays off
+    ///        the step; a short period leaves few bits in ki * dt.
+    static T ki_rate(T ki, uint64_t dt) { return T::from_raw(T::sat((double)ki.v * (double)dt * 1.0e-6)); }
+    static T kd_rate(T kd, uint64_t dt) { return T::from_raw(T::sat((double)kd.v * 1.0e+6 / (double)dt)); }
+};
+
+/// @brief Tuning parameters of a loop, set_params applies them as one block
+template <typename T>
+struct pid_params {
+    T kp;           // Proportional Gain
+    T ki;           // Integral Gain, as passed to set_gain_param
+    T kd;           // Differential Gain, as passed to set_gain_param
+    T db;           // Deadband
+    T pvll;         // Process variable low limit
+    T pvhl;         // Process variable high limit
+    T spll;         // Setpoint low limit
+    T sphl;         // Setpoint high limit
+    T coll;         // Control output low limit
+    T cohl;         // Control output high limit
+    uint64_t dtmin; // Minimum time interval between adjacent PID calculations expressed in us
+    bool db_on;     // Deadband On/Off
+};
+
+/// @brief Checks of set_params, shared by the controllers, the banks and the configuration
+///        file: valid gains and Deadband, ordered limits and a Time Slice of 1 usec or more
+template <typename T>
+inline bool pid_params_valid(const pid_params<T>& p) {
+    typedef pid_traits<T> traits;
+    return traits::gains_valid(p.kp, p.ki, p.kd) & traits::db_valid(p.db) &
+           (p.pvll <= p.pvhl) & (p.spll <= p.sphl) & (p.coll <= p.cohl) & (p.dtmin != 0);
+}
+
+/// @brief Dynamic state of a loop, what a warm restart needs to continue without a bump
+template <typename T>
+struct pid_state {
+    uint64_t lts;   // The last calculation timestamp
+    T Iterm;        // Integral term
+    T lerr;         // The last calculated Error (sp - pv)
+    T lco;          // The last calculated Control Output
+    bool lman_on;   // The last run Manual Mode On/Off
+};
+
+/// @brief Fixed-rate mode of a loop, see basic_pid::set_rate_param
+template <typename T>
+struct pid_rate {
+    uint64_t period;    // Fixed-rate period expressed in us, DT_RATE_OFF runs on the measured dt
+    uint64_t drift;     // Largest |dt - period| a fixed-rate step accepts, in us
+    T ki_dt;            // ki * period, precomputed
+    T kd_dt;            // kd / period, precomputed
+    bool drift_fault;   // A drifted step faults instead of falling back to the measured dt
+};
+
+/// @brief Configuration of pid_step, the gains are reduced to usec as in basic_pid
+template <typename T>
+struct pid_step_config {
+    uint64_t dtmin; // Minimum time interval between adjacent PID calculations expressed in us
+    T kp;           // Proportional Gain
+    T ki;           // Integral Gain, redused to usec by dividing by 1.0e+6
+    T kd;           // Differential Gain, redused to usec by multiplying by 1.0e+6
+    T db;           // Deadband
+    T coll;         // Control output low limit
+    T cohl;         // Control output high limit
+    bool db_on;     // Deadband On/Off
+    bool man_on;    // Manual Mode On/Off
+};
+
+/// @brief Inputs of pid_step
+template <typename T>
+struct pid_inputs {
+    uint64_t tstamp;    // Time, when the calculation is performed
+    T pv;               // Process variable
+    T sp;               // Setpoint
+    T tb;               // Tieback, read in Manual mode only
+    bool clean;         // PV and SP are those of the last step, see basic_pid::set_event_param
+    bool hold;          // Clean, and the last clean step left CO held
+};
+
+/// @brief Outputs of pid_step, the internals are those of the telemetry sample and are
+///        filled by a traced step only
+template <typename T>
+struct pid_outputs {
+    T co;           // Control Output
+    int rc;         // 0 - O'k, -1 - the drift fault kept CO
+    bool stepped;   // The Time Slice had elapsed, the step moved lts
+    uint32_t flags; // PID_TLM_* flags, traced only
+    uint64_t dt;    // Time since the last step
+    T err;          // Error, sp - pv, traced only
+    T p;            // Proportional contribution, traced only
+    T d;            // Differential contribution, traced only
+    T di;           // Integral term delta, traced only
+};
+
+/// @brief One step of the Basic PID controller: Time Slice, Manual mode with Tieback,
+///        the fixed-rate mode, bumpless transfer, Deadband, the three terms, anti-windup
+///        and the CO limits, in the order and with the operations of basic_pid::run_pid.
+///        It reads its arguments only, writes nothing but s, allocates nothing and keeps
+///        no intermediates anywhere else, so an interrupt and any number of threads may
+///        step their own states at the same time. The inputs are values, no store can
+///        alias them, so once inlined the whole step stays in registers.
+///        A clean step reuses lerr as its error and has no error difference to divide,
+///        a held one only keeps CO. The untraced step leaves the internals of the
+///        outputs alone, so it costs no more than the calculation.
+///        C and S are pid_step_config<T> and pid_state<T> or any struct with their
+///        members, so basic_pid passes references into its hot line and nothing is copied.
+/// @param c    - Configuration
+/// @param s    - Dynamic state, updated by the step
+/// @param in   - Inputs
+/// @param rate - Fixed-rate mode, nullptr runs on the measured dt
+/// @return CO, the status and, traced, the internals of the step
+template <bool traced = false, typename C, typename S, typename T>
+inline pid_outputs<T> pid_step(const C& c, S& s, const pid_inputs<T>& in, const pid_rate<T>* rate = nullptr) noexcept {
+    typedef pid_traits<T> traits;
+    pid_outputs<T> o{s.lco, 0, false, 0, in.tstamp - s.lts, T(), T(), T(), T()};
+
+    // Only update CO if no minimal time slice elapsed
+    if (o.dt < c.dtmin) {
+        return o;
+    }
+    o.stepped = true;
+
+    // Update lts
+    uint64_t lts_prev = s.lts;
+    s.lts = in.tstamp;
+
+    // Tieback drives CO if Manual mode is enabled, but CO limits still apply.
+    if (c.man_on) {
+        T tmp_co = in.tb;
+        if constexpr (traced) {
+            o.flags = PID_TLM_MANUAL | ((tmp_co > c.cohl) ? PID_TLM_CO_HIGH : 0) |
+                      ((tmp_co < c.coll) ? PID_TLM_CO_LOW : 0);
+        }
+        s.lco = o.co = (tmp_co < c.coll) ? c.coll : (tmp_co > c.cohl) ? c.cohl : tmp_co;
+        s.lman_on = true;   // For future bumpless switching back
+        return o;
+    }
+
+    // Fixed-rate mode, a step on the period uses the precomputed coefficients.
+    // |dt - period| <= drift is one unsigned compare, the first step has no
+    // previous one to measure from and never drifts.
+    bool fixed = false;
+    if (rate != nullptr) {
+        fixed = o.dt - (rate->period - rate->drift) <= 2 * rate->drift;
+        if (!fixed && lts_prev != 0) {
+            if constexpr (traced) {
+                o.flags = PID_TLM_DRIFT;
+            }
+            if (rate->drift_fault) {
+                o.rc = -1;
+                return o;
+            }
+        }
+    }
+
+    // Run bumpless if we come from Manual mode, set Iterm to the last co value.
+    // Otherwise a clean step has the error of the last step, a held one keeps CO.
+    bool clean = false;
+    if (s.lman_on) {
+        s.lman_on = false;
+        s.Iterm = s.lco;
+        if constexpr (traced) {
+            o.flags |= PID_TLM_BUMPLESS;
+        }
+    }
+    else if (in.clean) {
+        clean = true;
+        if constexpr (traced) {
+            o.flags |= PID_TLM_CLEAN;
+            o.err = s.lerr;
+        }
+        if (in.hold) {
+            return o;
+        }
+    }
+
+    // Now we are ready to calculate the new co value
+    T tmp_err = clean ? s.lerr : in.sp - in.pv;
+    if constexpr (traced) {
+        o.err = tmp_err;
+    }
+
+    // Skip further calculations if Deadband is Enabled
+    // and we are in the Deadband region
+    if (c.db_on && tmp_err < c.db) {
+        s.lerr = tmp_err;
+        if constexpr (traced) {
+            o.flags |= PID_TLM_DEADBAND;
+        }
+        return o;
+    }
+
+    // Add Proportional kick
+    T p_term = c.kp * tmp_err;
+    T tmp_co = p_term;
 
-/// @brief Basic float-point PID controller, Independent Gain mode only
-class base_pid {
+    // Add Dterm and update lerr, a clean step has no error difference
+    T d_term = clean ? c.kd * T() :
+               fixed ? rate->kd_dt * (tmp_err - s.lerr) : traits::dterm(c.kd, tmp_err - s.lerr, o.dt);
+    tmp_co += d_term;
+    s.lerr = tmp_err;
+    if constexpr (traced) {
+        o.p = p_term;
+        o.d = d_term;
+    }
 
-    // Variables used to store intermediate calculation results
-    uint64_t tmp_dt;
-    float tmp_co;
-    float tmp_err;
-    float d_iterm;
+    // Process Iterm
+    // Reset Iterm if ki == 0
+    if (c.ki == T()) {
+        s.Iterm = T();
+    }
+    else {
+        // Add the last Iterm, calculate Iterm delta,
+        // and check results against the limits (anti-windup)
+        T d_iterm = fixed ? rate->ki_dt * tmp_err : traits::iterm(c.ki, tmp_err, o.dt);
+        tmp_co += s.Iterm;
+        if (!((tmp_co > c.cohl && d_iterm > T()) ||
+            (tmp_co < c.coll && d_iterm < T()))) {
+            tmp_co += d_iterm;
+            s.Iterm += d_iterm;
+        }
+        else if constexpr (traced) {
+            o.flags |= PID_TLM_WINDUP;
+        }
+        if constexpr (traced) {
+            o.di = d_iterm;
+        }
+    }
+    if constexpr (traced) {
+        o.flags |= ((tmp_co > c.cohl) ? PID_TLM_CO_HIGH : 0) | ((tmp_co < c.coll) ? PID_TLM_CO_LOW : 0);
+    }
+    // Check results against limits and set Control output
+    s.lco = o.co = (tmp_co < c.coll) ? c.coll : (tmp_co > c.cohl) ? c.cohl : tmp_co;
+    return o;
+}
+
+/// @brief The object of basic_pid, everything a plain step reads and writes: the dynamic
+///        state, the gains, the CO limits and the IO. *pv is read through a pointer,
+///        *sp and *co at byte offsets from it, so three IO references fit the line. A
+///        plain step runs in Auto mode, after the bumpless transfer, without Deadband,
+///        fixed-rate, change-driven mode, telemetry or statistics, and its IO lies within
+///        2 GiB of *pv; dtmin is 0 for any other controller and sends its step to the
+///        full path over pid_cold.
+///        One cache line for a 4-byte T, two for double, see pid.cpp.
+template <typename T>
+struct alignas(PID_CACHE_LINE) pid_hot {
+    uint64_t lts;   // The last calculation timestamp
+    T* pv;          // Process variable Input
+    int32_t sp_off; // Setpoint Input, bytes from pv
+    int32_t co_off; // Control Output, bytes from pv
+    uint32_t dtmin; // Time Slice of a plain step expressed in us, 0 if the step is not plain
+    T kp;           // Proportional Gain
+    T ki;           // Integral Gain, redused to usec by dividing by 1.0e+6
+    T kd;           // Differential Gain, redused to usec by multiplying by 1.0e+6
+    T coll;         // Control output low limit
+    T cohl;         // Control output high limit
+    T Iterm;        // Integral term
+    T lerr;         // The last calculated Error (sp - pv)
+    T lco;          // The last calculated Control Output
+    uint32_t slot;  // Index of the cold block in the pool of pid.cpp
+};
+
+/// @brief What a plain step never reads: the IO pointers, the full Time Slice, the
+///        switches of the other paths and the settings of the fixed-rate and the
+///        change-driven modes. One block per controller, kept in a pool of blocks in
+///        pid.cpp and reached through pid_hot::slot, so the objects themselves stay
+///        one line each. The full step reads the first line, the fixed-rate values
+///        start the next one.
+template <typename T>
+struct alignas(PID_CACHE_LINE) pid_cold {
+    T* pv;          // Process variable Input
+    T* sp;          // Setpoint Input
+    T* tb;          // Tieback Input, it directly drives the Controlthis Output in Manual mode
+    T* co;          // Control Output
+    pid_telemetry<T>* tlm;  // Telemetry ring, nullptr when off
+    pid_stats* stats;       // Execution-time statistics, nullptr when off
+    uint64_t dtmin;     // Minimum time interval between adjacent PID calculations expressed in us
+    bool db_on;         // Deadband On/Off
+    bool man_on;        // Manual Mode On/Off
+    bool lman_on;       // The last run Manual Mode On/Off
+    uint8_t ev_mode;    // Change-driven mode, PID_EV_*
+    bool dirty;         // The next step is not clean, set by the IO layer and by every setter
+    bool lhold;         // The last step left CO where a clean step would leave it
+    pid_rate<T> rate;   // Fixed-rate mode
+    uint64_t rate_faults;   // Steps rejected by the drift fault
+    T db;               // Deadband
+    T lpv;              // Process variable of the last step
+    T lsp;              // Setpoint of the last step
+    T pvll;             // Process variable low limit
+    T pvhl;             // Process variable high limit
+    T spll;             // Setpoint low limit
+    T sphl;             // Setpoint high limit
+};
+
+/// @brief Basic PID controller over an arithmetic type T, Independent Gain mode only.
+///        T is float, double or a saturating Q-format type (q15, q31), see pid_traits.
+///        The object is its hot line, a copy gets a cold block of its own.
+template <typename T>
+class basic_pid {
+
+    typedef pid_traits<T> traits;
+
+    /// @brief Recalculate the fixed-rate coefficients
+    void rate_update();
+
+    /// @brief Point the hot line at the IO and decide whether the step is plain,
+    ///        called by every setter of the IO and of the paths
+    void refresh();
 
     protected :
-        float* pv;     // Process variable Input
-        float* sp;     // Setpoint Input
-        float* tb;     // Tieback Input, it directly drives the Controlthis Output in Manual mode
-        float* co;     // Control Output
-
-        float kp;       // Proportional Gain     
-        float ki;       // Integral Gain, redused to usec by dividing by 1.0e+6
-        float kd;       // Differential Gain, redused to usec by multiplying by 1.0e+6
-        float db;       // Deadband
-        float pvll;     // Process variable low limit
-        float pvhl;     // Process variable high limit
-        float spll;     // Setpoint low limit
-        float sphl;     // Setpoint high limit
-        float coll;     // Control output low limit
-        float cohl;     // Control output high limit
-        uint64_t dtmin; // Minimum time interval between adjacent PID calculations expressed in us
-        bool  db_on;    // Deadband On/Off
-        bool  man_on;   // Manual Mode On/Off
-
-        uint64_t lts;   // The last calculation timestamp
-        bool lman_on;   // The last run Manual Mode On/Off        
-        float Iterm;    // Integral term
-        float lerr;      // The last calculated Error (sp - pv)
+        pid_hot<T> hot;     // The whole object, everything a plain step reads and writes
+
+        /// @brief The cold block of the controller
+        pid_cold<T>& cold() const;
+
+        /// @brief Push the internals of the step to the telemetry ring
+        void trace(const pid_cold<T>& cl, uint64_t tstamp, const pid_outputs<T>& o);
+
+        /// @brief The change-driven step, kept out of the plain run_step
+        __attribute__((noinline))
+        pid_outputs<T> event_step(pid_cold<T>& cl, const pid_step_config<T>& c, pid_inputs<T>& in, const pid_rate<T>* rate);
+
+        /// @brief The step of a plain controller, over the hot line alone
+        int plain_step(uint64_t tstamp);
+
+        /// @brief One PID step over the hot line and the cold block, with or without
+        ///        telemetry and statistics
+        template <bool traced, bool counted = false>
+        int run_step(pid_cold<T>& cl, uint64_t tstamp);
+
+        /// @brief run_pid of a controller that is not plain
+        int run_full(uint64_t tstamp);
+
+        /// @brief run_pid timed for the statistics
+        int run_timed(pid_cold<T>& cl, uint64_t tstamp);
+
+        /// @brief The steps of process(), with or without telemetry
+        template <bool traced>
+        int replay(const uint64_t* t, const T* pvv, const T* spv, T* cov, size_t n);
 
     public:
+        typedef T value_type;
+
         /// @brief Constructors
-        base_pid();
-        base_pid(float* ppv, float* psp, float* pco, float* ptie = nullptr);
-        base_pid(float* ppv, float* psp, float* pco, float* ptie,
-                float kpv, float kiv, float kdv, float dbv,
-                float pvllv = -__FLT_MAX__, float pvhlv = __FLT_MAX__,
-                float spllv = -__FLT_MAX__, float sphlv = __FLT_MAX__,
-                float collv = -__FLT_MAX__, float cohlv = __FLT_MAX__,
+        basic_pid();
+        basic_pid(T* ppv, T* psp, T* pco, T* ptie = nullptr);
+        basic_pid(T* ppv, T* psp, T* pco, T* ptie,
+                T kpv, T kiv, T kdv, T dbv,
+                T pvllv = pid_traits<T>::lowest(), T pvhlv = pid_traits<T>::max(),
+                T spllv = pid_traits<T>::lowest(), T sphlv = pid_traits<T>::max(),
+                T collv = pid_traits<T>::lowest(), T cohlv = pid_traits<T>::max(),
                 bool db_onv = false, bool man_on = true, uint64_t dtminv = DT_MIN_PID);
 
+        /// @brief A copy has a cold block of its own, a move copies
+        basic_pid(const basic_pid& other);
+        basic_pid& operator=(const basic_pid& other);
+
+        /// @brief Returns the cold block to the pool
+        ~basic_pid();
+
         /// @brief Get Process variable limits
-        void get_pv_limits(float& ll, float& hl);
+        void get_pv_limits(T& ll, T& hl);
 
         /// @brief Get Process variable limits 
-        int set_pv_limits(float& ll, float& hl);
+        int set_pv_limits(T& ll, T& hl);
 
         /// @brief Get Setpoint limits
-        void get_sp_limits(float& ll, float& hl);
+        void get_sp_limits(T& ll, T& hl);
 
         /// @brief Set Setpoint limits
-        int set_sp_limits(float& ll, float& hl);
+        int set_sp_limits(T& ll, T& hl);
 
         /// @brief Get Control Outputs limits
-        void get_co_limits(float& ll, float& hl);
+        void get_co_limits(T& ll, T& hl);
 
         /// @brief Set Control Outputs limits
-        int set_cp_limits(float& ll, float& hl);
+        int set_cp_limits(T& ll, T& hl);
 
         /// @brief Get Gain parameters
-        void get_gain_param(float& kpv, float& kiv, float& kdv);
+        void get_gain_param(T& kpv, T& kiv, T& kdv);
 
         /// @brief Set Gain parameters
-        int set_gain_param(float& kpv, float& kiv, float& kdv);
+        int set_gain_param(T& kpv, T& kiv, T& kdv);
 
         /// @brief Get Deadband parameters
-        void get_db_param(float& dbv, bool& db_onv);
+        void get_db_param(T& dbv, bool& db_onv);
 
         /// @brief Set Deadband parameters
-        int set_db_param(float& dbv, bool& db_onv);
+        int set_db_param(T& dbv, bool& db_onv);
 
         /// @brief Get Manual mode parameter
         void get_man_param(bool& man_onv);
@@ -102,8 +506,59 @@ class base_pid {
         /// @brief Set Time Slice parameter, 1 usec or more
         int set_dtmin_param(uint64_t& dtminv);
 
-        /// @brief Process Basic float-point PID controller calclation 
+        /// @brief Get Fixed-rate parameters
+        void get_rate_param(uint64_t& periodv, uint64_t& driftv, bool& drift_faultv);
+
+        /// @brief Set Fixed-rate parameters, DT_RATE_OFF turns the fixed-rate mode off
+        int set_rate_param(uint64_t& periodv, uint64_t& driftv, bool& drift_faultv);
+
+        /// @brief Number of steps rejected by the drift fault
+        uint64_t get_rate_faults();
+
+        /// @brief Get Change-driven mode parameter
+        void get_event_param(uint8_t& ev_modev);
+
+        /// @brief Set Change-driven mode parameter, PID_EV_*
+        int set_event_param(uint8_t& ev_modev);
+
+        /// @brief The IO layer wrote a new PV or SP, the next step is not clean
+        void set_dirty();
+
+        /// @brief Get all tuning parameters
+        void get_params(pid_params<T>& p);
+
+        /// @brief Set all tuning parameters at once, nothing is set if any of them is rejected
+        int set_params(const pid_params<T>& p);
+
+        /// @brief Get the dynamic state
+        void get_state(pid_state<T>& st);
+
+        /// @brief Set the dynamic state, e.g. from a checkpoint
+        void set_state(const pid_state<T>& st);
+
+        /// @brief Attach a telemetry ring, nullptr detaches it
+        void set_telemetry(pid_telemetry<T>* ptlm);
+
+        /// @brief Attach execution-time statistics, nullptr detaches them
+        void set_stats(pid_stats* pstats);
+
+        /// @brief Process Basic PID controller calclation
         int run_pid(uint64_t tstamp);
+
+        /// @brief Run the controller over a recorded trace, cov[k] is what run_pid(t[k])
+        ///        would leave in *co after pvv[k] and spv[k] were written to *pv and *sp
+        int process(const uint64_t* t, const T* pvv, const T* spv, T* cov, size_t n);
     };
 
+// The controller is instantiated once in pid.cpp for every supported type
+extern template class basic_pid<float>;
+extern template class basic_pid<double>;
+extern template class basic_pid<q15>;
+extern template class basic_pid<q31>;
+
+typedef basic_pid<float> base_pid;      // Basic float-point PID controller
+typedef basic_pid<double> base_pid_d;   // Double precision, for long-horizon simulations
+typedef basic_pid<q15> base_pid_q15;    // Saturating Q1.15 fixed-point, for FPU-less cores
+typedef basic_pid<q31> base_pid_q31;    // Saturating Q1.31 fixed-point, for FPU-less cores
+
 #endif /* _PID_H */
\ No newline at end of file
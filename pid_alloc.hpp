@@ -0,0 +1,48 @@
+/**
+ * @file pid_alloc.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Cache-line aligned storage used by the batch PID engines
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ */
+#ifndef _PID_ALLOC_H
+#define _PID_ALLOC_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#define PID_CACHE_LINE 64 // Alignment of every SoA column, bytes
+
+/// @brief Minimal allocator that aligns every block to PID_CACHE_LINE,
+///        so SoA columns start on a cache line and vector loads never split
+template <typename T>
+struct pid_allocator {
+    typedef T value_type;
+
+    pid_allocator() noexcept {}
+    template <typename U>
+    pid_allocator(const pid_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(PID_CACHE_LINE)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(PID_CACHE_LINE));
+    }
+
+    template <typename U>
+    bool operator==(const pid_allocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const pid_allocator<U>&) const noexcept { return false; }
+};
+
+/// @brief SoA column type
+template <typename T>
+using pid_vector = std::vector<T, pid_allocator<T>>;
+
+#endif /* _PID_ALLOC_H */
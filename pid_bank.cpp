@@ -0,0 +1,599 @@
+/**
+ * @file pid_bank.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Structure-of-arrays PID bank
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "pid_bank.hpp"
+#include "pid_checkpoint.hpp"
+#include "pid_config.hpp"
+
+#define PID_TRACE_CHUNK 64 // Traced loops snapshotted per kernel call
+
+    /// @brief The Constructor creates a bank of nloops PID controllers, every loop is
+    ///        configured as the base_pid default constructor does, Tieback is 0
+    /// @param nloops Number of loops
+    pid_bank::pid_bank(size_t nloops) :
+        n{nloops},
+        npad{(nloops + PID_BANK_LANES - 1) / PID_BANK_LANES * PID_BANK_LANES},
+        tlm{nullptr},
+        traced(),
+        pv(npad, 0.0f),
+        sp(npad, 0.0f),
+        tb(npad, 0.0f),
+        co(npad, 0.0f),
+        kp(npad, 0.0f),
+        ki(npad, 0.0f),
+        kd(npad, 0.0f),
+        db(npad, 0.0f),
+        pvll(npad, -__FLT_MAX__),
+        pvhl(npad, __FLT_MAX__),
+        spll(npad, -__FLT_MAX__),
+        sphl(npad, __FLT_MAX__),
+        coll(npad, -__FLT_MAX__),
+        cohl(npad, __FLT_MAX__),
+        dtmin(npad, DT_MIN_PID),
+        db_on(npad, 0),
+        man_on(npad, 1),
+        lts(npad, 0),
+        lman_on(npad, 1),
+        Iterm(npad, 0.0f),
+        lerr(npad, 0.0f),
+        lco(npad, 0.0f)
+        {};
+
+        /// @brief Configure a loop, mirrors the full base_pid constructor and resets the loop state
+        /// @param i      Loop number
+        /// @param kpv    Proportional Gain
+        /// @param kiv    Integral Gain, redused to usec by dividing by 1.0e+6
+        /// @param kdv    Differential Gain, redused to usec by multiplying by 1.0e+6
+        /// @param dbv    Deadband
+        /// @param pvllv  Process variable low limit
+        /// @param pvhlv  Process variable high limit
+        /// @param spllv  Setpoint low limit
+        /// @param sphlv  Setpoint high limit
+        /// @param collv  Control output low limit
+        /// @param cohlv  Control output high limit
+        /// @param db_onv Deadband On/Off
+        /// @param man_on Manual Mode On/Off
+        /// @param dtminv Minimum time interval between adjacent PID calculations expressed in usec
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::set_loop(size_t i, float kpv, float kiv, float kdv, float dbv,
+                float pvllv, float pvhlv,
+                float spllv, float sphlv,
+                float collv, float cohlv,
+                bool db_onv, bool man_onv, uint64_t dtminv) {
+        if (i >= n) {
+            return -1;
+        }
+        kp[i] = kpv;
+        ki[i] = kiv*(float)1.0e-6;
+        kd[i] = kdv*(float)1.0e+6;
+        db[i] = dbv;
+        pvll[i] = pvllv;
+        pvhl[i] = pvhlv;
+        spll[i] = spllv;
+        sphl[i] = sphlv;
+        coll[i] = collv;
+        cohl[i] = cohlv;
+        db_on[i] = db_onv;
+        man_on[i] = man_onv;
+        lts[i] = 0;
+        lman_on[i] = 1;
+        Iterm[i] = 0;
+        lerr[i] = 0;
+        lco[i] = 0;
+        // A zero time slice would stall the loop forever, force it to 1 usec
+        dtmin[i] = (dtminv == 0) ? 1 : dtminv;
+        return (dtminv == 0) ? -1 : 0;
+    };
+
+        /// @brief Get Process variable limits
+        /// @param i   - Loop number
+        /// @param ll  - Referense to the Low Level limiter of the Process variable value
+        /// @param hl  - Referense to the High Level limiter of the Process variable value
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::get_pv_limits(size_t i, float& ll, float& hl) {
+        if (i >= n) {
+            return -1;
+        }
+        ll = pvll[i];
+        hl = pvhl[i];
+        return 0;
+    };
+
+        /// @brief Set Process variable limits
+        /// @param i   - Loop number
+        /// @param ll  - Referense to the Low Level limiter of the Process variable value
+        /// @param hl  - Referense to the High Level limiter of the Process variable value
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::set_pv_limits(size_t i, float& ll, float& hl) {
+        if (i >= n) {
+            return -1;
+        }
+        // Verify limits order
+        if (hl < ll) {
+            pvll[i] = hl;
+            pvhl[i] = ll;
+            return -1;
+        }
+        pvll[i] = ll;
+        pvhl[i] = hl;
+        return 0;
+    };
+
+        /// @brief Get Setpoint limits
+        /// @param i   - Loop number
+        /// @param ll  - Referense to the Low Level limiter of the Setpoint variable value
+        /// @param hl  - Referense to the High Level limiter of the Setpoint variable value
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::get_sp_limits(size_t i, float& ll, float& hl) {
+        if (i >= n) {
+            return -1;
+        }
+        ll = spll[i];
+        hl = sphl[i];
+        return 0;
+    };
+
+        /// @brief Set Setpoint limits
+        /// @param i   - Loop number
+        /// @param ll  - Referense to the Low Level limiter of the Setpoint variable value
+        /// @param hl  - Referense to the High Level limiter of the Setpoint variable value
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::set_sp_limits(size_t i, float& ll, float& hl) {
+        if (i >= n) {
+            return -1;
+        }
+        // Verify limits order
+        if (hl < ll) {
+            spll[i] = hl;
+            sphl[i] = ll;
+            return -1;
+        }
+        spll[i] = ll;
+        sphl[i] = hl;
+        return 0;
+    };
+
+        /// @brief Get Control Outputs limits
+        /// @param i   - Loop number
+        /// @param ll  - Referense to the Low Level limiter of the Control Output variable value
+        /// @param hl  - Referense to the High Level limiter of the Control Output variable value
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::get_co_limits(size_t i, float& ll, float& hl) {
+        if (i >= n) {
+            return -1;
+        }
+        ll = coll[i];
+        hl = cohl[i];
+        return 0;
+    };
+
+        /// @brief Set Control Outputs limits
+        /// @param i   - Loop number
+        /// @param ll  - Referense to the Low Level limiter of the Control Output variable value
+        /// @param hl  - Referense to the High Level limiter of the Control output variable value
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::set_cp_limits(size_t i, float& ll, float& hl) {
+        if (i >= n) {
+            return -1;
+        }
+        // Verify limits order
+        if (hl < ll) {
+            coll[i] = hl;
+            cohl[i] = ll;
+            return -1;
+        }
+        coll[i] = ll;
+        cohl[i] = hl;
+        return 0;
+    };
+
+        /// @brief Get Gain parameters
+        /// @param i   - Loop number
+        /// @param kpv - Referense to the Proportional Gain variable value
+        /// @param kiv - Referense to the Integer Gain variable value
+        /// @param kdv - Referense to the Differential Gain variable value
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::get_gain_param(size_t i, float& kpv, float& kiv, float& kdv) {
+        if (i >= n) {
+            return -1;
+        }
+        kpv = kp[i];
+        kiv = ki[i] * 1.0e+6;
+        kdv = kd[i] * 1.0e-6;
+        return 0;
+    };
+
+        /// @brief Set Gain parameters
+        /// @param i   - Loop number
+        /// @param kpv - Referense to the Proportional Gain variable value
+        /// @param kiv - Referense to the Integer Gain variable value
+        /// @param kdv - Referense to the Differential Gain variable value
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::set_gain_param(size_t i, float& kpv, float& kiv, float& kdv) {
+        // Check values
+        if (i >= n || !pid_traits<float>::gains_valid(kpv, kiv, kdv)) {
+            return -1;
+        }
+        kp[i] = kpv;
+        ki[i] = kiv * 1.0e-6;
+        kd[i] = kdv * 1.0e+6;
+        return 0;
+    };
+
+        /// @brief Get Deadband parameters
+        /// @param i      - Loop number
+        /// @param dbv    - Referense to the Deadband variable value
+        /// @param db_onv - Referense to the Deadband mode switch
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::get_db_param(size_t i, float& dbv, bool& db_onv) {
+        if (i >= n) {
+            return -1;
+        }
+        dbv = db[i];
+        db_onv = db_on[i];
+        return 0;
+    };
+
+        /// @brief Set Deadband parameters
+        /// @param i      - Loop number
+        /// @param dbv    - Referense to the Deadband variable value
+        /// @param db_onv - Referense to the Deadband mode switch
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::set_db_param(size_t i, float& dbv, bool& db_onv) {
+        if (i >= n || !pid_traits<float>::db_valid(dbv)) {
+            return -1;
+        }
+        db[i] = dbv;
+        db_on[i] = db_onv;
+        return 0;
+    };
+
+        /// @brief Get Manual mode parameter
+        /// @param i       - Loop number
+        /// @param man_onv - Referense to the Manual mode switch
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::get_man_param(size_t i, bool& man_onv) {
+        if (i >= n) {
+            return -1;
+        }
+        man_onv = man_on[i];
+        return 0;
+    };
+
+        /// @brief Set Manual mode parameter
+        /// @param i       - Loop number
+        /// @param man_onv - Referense to the Manual mode switch
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::set_man_param(size_t i, bool& man_onv) {
+        if (i >= n) {
+            return -1;
+        }
+        man_on[i] = man_onv;
+        return 0;
+    };
+
+        /// @brief Get Time Slice parameter
+        /// @param i      - Loop number
+        /// @param dtminv - Referense to the Time Slice parameter expressed in usec
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::get_dtmin_param(size_t i, uint64_t& dtminv) {
+        if (i >= n) {
+            return -1;
+        }
+        dtminv = dtmin[i];
+        return 0;
+    };
+
+        /// @brief Set Time Slice parameter, 1 usec or more
+        /// @param i      - Loop number
+        /// @param dtminv - Referense to the Time Slice parameter
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::set_dtmin_param(size_t i, uint64_t& dtminv) {
+        if (i >= n) {
+            return -1;
+        }
+        dtmin[i] = dtminv;
+        if (dtminv == 0) {
+            dtmin[i] = 1;
+            return -1;
+        }
+        return 0;
+    };
+
+        /// @brief Get all tuning parameters
+        /// @param i - Loop number
+        /// @param p - Referense to the parameter block
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::get_params(size_t i, pid_params<float>& p) {
+        if (i >= n) {
+            return -1;
+        }
+        get_gain_param(i, p.kp, p.ki, p.kd);
+        p.db = db[i];
+        p.pvll = pvll[i];
+        p.pvhl = pvhl[i];
+        p.spll = spll[i];
+        p.sphl = sphl[i];
+        p.coll = coll[i];
+        p.cohl = cohl[i];
+        p.dtmin = dtmin[i];
+        p.db_on = db_on[i];
+        return 0;
+    };
+
+        /// @brief Set all tuning parameters at once, the loop state is kept. The block is
+        ///        either applied in full or not at all.
+        /// @param i - Loop number
+        /// @param p - Referense to the parameter block
+        /// @return 0  - O'k
+        ///         -1 - Error, nothing is changed
+    int pid_bank::set_params(size_t i, const pid_params<float>& p) {
+        if (i >= n || !pid_params_valid(p)) {
+            return -1;
+        }
+        kp[i] = p.kp;
+        ki[i] = p.ki * 1.0e-6;
+        kd[i] = p.kd * 1.0e+6;
+        db[i] = p.db;
+        pvll[i] = p.pvll;
+        pvhl[i] = p.pvhl;
+        spll[i] = p.spll;
+        sphl[i] = p.sphl;
+        coll[i] = p.coll;
+        cohl[i] = p.cohl;
+        dtmin[i] = p.dtmin;
+        db_on[i] = p.db_on;
+        return 0;
+    };
+
+        /// @param i  - Loop number
+        /// @param st - Referense to the state
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::get_state(size_t i, pid_state<float>& st) {
+        if (i >= n) {
+            return -1;
+        }
+        st.lts = lts[i];
+        st.Iterm = Iterm[i];
+        st.lerr = lerr[i];
+        st.lco = lco[i];
+        st.lman_on = lman_on[i];
+        return 0;
+    };
+
+        /// @param i  - Loop number
+        /// @param st - Referense to the state
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::set_state(size_t i, const pid_state<float>& st) {
+        if (i >= n) {
+            return -1;
+        }
+        lts[i] = st.lts;
+        Iterm[i] = st.Iterm;
+        lerr[i] = st.lerr;
+        lco[i] = st.lco;
+        lman_on[i] = st.lman_on;
+        return 0;
+    };
+
+        /// @brief One copy per state column into the free slot, then the slot is committed
+        /// @param cp     - The checkpoint, it must hold as many loops as the bank
+        /// @param tstamp - Clock the snapshot is taken at, usually the last step time
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::save_state(pid_checkpoint& cp, uint64_t tstamp) const {
+        if (cp.size() != n) {
+            return -1;
+        }
+        pid_state_columns c = cp.write_slot();
+        std::memcpy(c.lts, lts.data(), n * sizeof(uint64_t));
+        std::memcpy(c.Iterm, Iterm.data(), n * sizeof(float));
+        std::memcpy(c.lerr, lerr.data(), n * sizeof(float));
+        std::memcpy(c.lco, lco.data(), n * sizeof(float));
+        std::memcpy(c.lman_on, lman_on.data(), n);
+        cp.commit(tstamp);
+        return 0;
+    };
+
+        /// @param cp  - The checkpoint, it must hold a snapshot of as many loops as the bank
+        /// @param now - Clock of the restarted process
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::restore_state(const pid_checkpoint& cp, uint64_t now) {
+        if (!cp.has_snapshot() || cp.size() != n) {
+            return -1;
+        }
+        pid_state_columns c = cp.read_slot();
+        uint64_t snap = cp.tstamp();
+        for (size_t i = 0; i < n; i++) {
+            lts[i] = pid_rebase(c.lts[i], snap, now);
+            lman_on[i] = c.lman_on[i] != 0;
+        }
+        std::memcpy(Iterm.data(), c.Iterm, n * sizeof(float));
+        std::memcpy(lerr.data(), c.lerr, n * sizeof(float));
+        std::memcpy(lco.data(), c.lco, n * sizeof(float));
+        return 0;
+    };
+
+        /// @brief Copy every column of a validated file into the bank, the loop state is
+        ///        reset as set_loop() does and the IO columns are kept
+        /// @param cfg - The mapped file, it must hold as many loops as the bank
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::load_config(const pid_config& cfg) {
+        if (cfg.size() != n) {
+            return -1;
+        }
+        pid_config_columns c = cfg.columns();
+        std::memcpy(kp.data(), c.kp, n * sizeof(float));
+        std::memcpy(ki.data(), c.ki, n * sizeof(float));
+        std::memcpy(kd.data(), c.kd, n * sizeof(float));
+        std::memcpy(db.data(), c.db, n * sizeof(float));
+        std::memcpy(pvll.data(), c.pvll, n * sizeof(float));
+        std::memcpy(pvhl.data(), c.pvhl, n * sizeof(float));
+        std::memcpy(spll.data(), c.spll, n * sizeof(float));
+        std::memcpy(sphl.data(), c.sphl, n * sizeof(float));
+        std::memcpy(coll.data(), c.coll, n * sizeof(float));
+        std::memcpy(cohl.data(), c.cohl, n * sizeof(float));
+        std::memcpy(dtmin.data(), c.dtmin, n * sizeof(uint64_t));
+        std::memcpy(db_on.data(), c.db_on, n);
+        std::memcpy(man_on.data(), c.man_on, n);
+        std::fill(lts.begin(), lts.begin() + n, 0);
+        std::fill(lman_on.begin(), lman_on.begin() + n, 1);
+        std::fill(Iterm.begin(), Iterm.begin() + n, 0.0f);
+        std::fill(lerr.begin(), lerr.begin() + n, 0.0f);
+        std::fill(lco.begin(), lco.begin() + n, 0.0f);
+        return 0;
+    };
+
+        /// @param path - File to write, replaced as a whole
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::save_config(const char* path) const {
+        pid_config_columns c{kp.data(), ki.data(), kd.data(), db.data(),
+                             pvll.data(), pvhl.data(), spll.data(), sphl.data(),
+                             coll.data(), cohl.data(), dtmin.data(), db_on.data(), man_on.data()};
+        return pid_config_write(path, n, c);
+    };
+
+        /// @brief Process all loops of the bank
+        /// @param tstamp - Time, when the calculation is performed
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::step_all(uint64_t tstamp) {
+        return step_range(tstamp, 0, n);
+    };
+
+        /// @brief Process loops [first, last) of the bank, every loop follows base_pid::run_pid
+        ///        step by step, so the outputs are bit-identical to a base_pid per loop
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first loop number
+        /// @param last   - The loop number after the last one
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::step_range(uint64_t tstamp, size_t first, size_t last) {
+        if (first > last || last > n) {
+            return -1;
+        }
+        if (tlm != nullptr && !traced.empty()) {
+            return step_traced(tstamp, first, last);
+        }
+        pid_kernel_run(view(), tstamp, first, last);
+        return 0;
+    };
+
+        /// @brief Add a loop to or remove it from the traced loops
+        /// @param i  - Loop number
+        /// @param on - Trace the loop
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_bank::trace_loop(size_t i, bool on) {
+        if (i >= n) {
+            return -1;
+        }
+        std::vector<uint32_t>::iterator it = std::lower_bound(traced.begin(), traced.end(), (uint32_t)i);
+        bool found = it != traced.end() && *it == i;
+        if (on && !found) {
+            traced.insert(it, (uint32_t)i);
+        }
+        if (!on && found) {
+            traced.erase(it);
+        }
+        return 0;
+    };
+
+    /// @brief Run pid_step of loop i again on a copy of its state before the step, the
+    ///        kernels use the same operations, and push the internals to the ring
+    static void trace_step(const pid_bank_view& v, size_t i, pid_state<float> s, uint64_t tstamp,
+                           pid_telemetry<float>* tlm) {
+        pid_step_config<float> c{v.dtmin[i], v.kp[i], v.ki[i], v.kd[i], v.db[i], v.coll[i], v.cohl[i],
+                                 v.db_on[i] != 0, v.man_on[i] != 0};
+        pid_outputs<float> o = pid_step<true>(c, s, pid_inputs<float>{tstamp, v.pv[i], v.sp[i], c.man_on ? v.tb[i] : 0.0f, false, false});
+        if (!o.stepped) {
+            return;
+        }
+        tlm->push(pid_sample<float>{tstamp, o.dt, (uint32_t)i, o.flags, o.err, o.p, o.d, o.di, v.Iterm[i], v.co[i]});
+    };
+
+        /// @brief Process loops [first, last) and trace the traced ones. The range is cut
+        ///        after every PID_TRACE_CHUNK traced loops, their state is saved, the chunk
+        ///        is stepped by the kernel and the samples are rebuilt from the saved state.
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first loop number
+        /// @param last   - The loop number after the last one
+        /// @return 0  - O'k
+    int pid_bank::step_traced(uint64_t tstamp, size_t first, size_t last) {
+        pid_bank_view v = view();
+        pid_state<float> pre[PID_TRACE_CHUNK];
+        std::vector<uint32_t>::const_iterator it = std::lower_bound(traced.begin(), traced.end(), (uint32_t)first);
+        while (first < last) {
+            std::vector<uint32_t>::const_iterator from = it;
+            size_t k = 0;
+            for (; it != traced.end() && *it < last && k < PID_TRACE_CHUNK; it++, k++) {
+                pre[k] = pid_state<float>{lts[*it], Iterm[*it], lerr[*it], lco[*it], lman_on[*it] != 0};
+            }
+            size_t end = (k == PID_TRACE_CHUNK) ? (size_t)*(it - 1) + 1 : last;
+            pid_kernel_run(v, tstamp, first, end);
+            for (size_t j = 0; j < k; j++) {
+                trace_step(v, from[j], pre[j], tstamp, tlm);
+            }
+            first = end;
+        }
+        return 0;
+    };
+
+        /// @brief Process the listed loops, each loop number at most once, the outputs are
+        ///        the same as step_range would give for these loops
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param idx    - Loop numbers
+        /// @param count  - Number of loop numbers
+        /// @return 0  - O'k
+        ///         -1 - Error, a loop number is out of range, nothing is stepped
+    int pid_bank::step_list(uint64_t tstamp, const uint32_t* idx, size_t count) {
+        for (size_t k = 0; k < count; k++) {
+            if (idx[k] >= n) {
+                return -1;
+            }
+        }
+        pid_kernel_list(view(), tstamp, idx, count);
+        return 0;
+    };
+
+        /// @brief Raw column pointers for the stepping kernels
+        /// @return The bank view
+    pid_bank_view pid_bank::view() {
+        return pid_bank_view{pv.data(), sp.data(), tb.data(), co.data(),
+                             kp.data(), ki.data(), kd.data(), db.data(),
+                             coll.data(), cohl.data(), dtmin.data(), db_on.data(), man_on.data(),
+                             lts.data(), lman_on.data(), Iterm.data(), lerr.data(), lco.data()};
+    };
@@ -0,0 +1,185 @@
+/**
+ * @file pid_bank.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the structure-of-arrays PID bank
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ */
+#ifndef _PID_BANK_H
+#define _PID_BANK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pid.hpp"
+#include "pid_alloc.hpp"
+#include "pid_kernels.hpp"
+#include "pid_telemetry.hpp"
+
+#define PID_BANK_LANES 16 // Columns are padded to a multiple of this many loops
+
+class pid_checkpoint;
+class pid_config;
+
+/// @brief A bank of Basic float-point PID controllers stored as structure-of-arrays.
+///        Every loop behaves exactly like a base_pid, but the IO values live in the
+///        bank itself and all loops are stepped by a single step_all() call.
+class pid_bank {
+
+    size_t n;       // Number of loops
+    size_t npad;    // Number of loops rounded up to PID_BANK_LANES
+
+    pid_telemetry<float>* tlm;      // Telemetry ring, nullptr when off
+    std::vector<uint32_t> traced;   // Loops traced to tlm, sorted
+
+    int step_traced(uint64_t tstamp, size_t first, size_t last);
+
+    protected :
+        // IO, owned by the bank
+        pid_vector<float> pv;       // Process variable Input
+        pid_vector<float> sp;       // Setpoint Input
+        pid_vector<float> tb;       // Tieback Input, 0 when not connected
+        pid_vector<float> co;       // Control Output
+
+        // Configuration
+        pid_vector<float> kp;       // Proportional Gain
+        pid_vector<float> ki;       // Integral Gain, redused to usec by dividing by 1.0e+6
+        pid_vector<float> kd;       // Differential Gain, redused to usec by multiplying by 1.0e+6
+        pid_vector<float> db;       // Deadband
+        pid_vector<float> pvll;     // Process variable low limit
+        pid_vector<float> pvhl;     // Process variable high limit
+        pid_vector<float> spll;     // Setpoint low limit
+        pid_vector<float> sphl;     // Setpoint high limit
+        pid_vector<float> coll;     // Control output low limit
+        pid_vector<float> cohl;     // Control output high limit
+        pid_vector<uint64_t> dtmin; // Minimum time interval between adjacent PID calculations expressed in us
+        pid_vector<uint8_t> db_on;  // Deadband On/Off
+        pid_vector<uint8_t> man_on; // Manual Mode On/Off
+
+        // Dynamic state
+        pid_vector<uint64_t> lts;   // The last calculation timestamp
+        pid_vector<uint8_t> lman_on;// The last run Manual Mode On/Off
+        pid_vector<float> Iterm;    // Integral term
+        pid_vector<float> lerr;     // The last calculated Error (sp - pv)
+        pid_vector<float> lco;      // The last calculated Control Output
+
+    public:
+        /// @brief Constructor
+        explicit pid_bank(size_t nloops);
+
+        /// @brief Number of loops in the bank
+        size_t size() const { return n; }
+
+        /// @brief Column length including the padding loops
+        size_t padded_size() const { return npad; }
+
+        /// @brief IO columns, indexed by loop number
+        float* pv_data() { return pv.data(); }
+        float* sp_data() { return sp.data(); }
+        float* tb_data() { return tb.data(); }
+        const float* co_data() const { return co.data(); }
+
+        /// @brief Configure a loop, same arguments and defaults as the full base_pid constructor
+        int set_loop(size_t i, float kpv, float kiv, float kdv, float dbv,
+                float pvllv = -__FLT_MAX__, float pvhlv = __FLT_MAX__,
+                float spllv = -__FLT_MAX__, float sphlv = __FLT_MAX__,
+                float collv = -__FLT_MAX__, float cohlv = __FLT_MAX__,
+                bool db_onv = false, bool man_onv = true, uint64_t dtminv = DT_MIN_PID);
+
+        /// @brief Get Process variable limits
+        int get_pv_limits(size_t i, float& ll, float& hl);
+
+        /// @brief Set Process variable limits
+        int set_pv_limits(size_t i, float& ll, float& hl);
+
+        /// @brief Get Setpoint limits
+        int get_sp_limits(size_t i, float& ll, float& hl);
+
+        /// @brief Set Setpoint limits
+        int set_sp_limits(size_t i, float& ll, float& hl);
+
+        /// @brief Get Control Outputs limits
+        int get_co_limits(size_t i, float& ll, float& hl);
+
+        /// @brief Set Control Outputs limits
+        int set_cp_limits(size_t i, float& ll, float& hl);
+
+        /// @brief Get Gain parameters
+        int get_gain_param(size_t i, float& kpv, float& kiv, float& kdv);
+
+        /// @brief Set Gain parameters
+        int set_gain_param(size_t i, float& kpv, float& kiv, float& kdv);
+
+        /// @brief Get Deadband parameters
+        int get_db_param(size_t i, float& dbv, bool& db_onv);
+
+        /// @brief Set Deadband parameters
+        int set_db_param(size_t i, float& dbv, bool& db_onv);
+
+        /// @brief Get Manual mode parameter
+        int get_man_param(size_t i, bool& man_onv);
+
+        /// @brief Set Manual mode parameter
+        int set_man_param(size_t i, bool& man_onv);
+
+        /// @brief Get Time Slice parameter
+        int get_dtmin_param(size_t i, uint64_t& dtminv);
+
+        /// @brief Set Time Slice parameter, 1 usec or more
+        int set_dtmin_param(size_t i, uint64_t& dtminv);
+
+        /// @brief Get all tuning parameters
+        int get_params(size_t i, pid_params<float>& p);
+
+        /// @brief Set all tuning parameters at once, nothing is set if any of them is rejected
+        int set_params(size_t i, const pid_params<float>& p);
+
+        /// @brief Get the dynamic state of a loop
+        int get_state(size_t i, pid_state<float>& st);
+
+        /// @brief Set the dynamic state of a loop
+        int set_state(size_t i, const pid_state<float>& st);
+
+        /// @brief Write the dynamic state of every loop to a checkpoint
+        int save_state(pid_checkpoint& cp, uint64_t tstamp) const;
+
+        /// @brief Restore the dynamic state of every loop from a checkpoint, rebased onto the clock now
+        int restore_state(const pid_checkpoint& cp, uint64_t now);
+
+        /// @brief Configure every loop from a mapped configuration file and reset the loop state
+        int load_config(const pid_config& cfg);
+
+        /// @brief Write the configuration of every loop to a file
+        int save_config(const char* path) const;
+
+        /// @brief Attach a telemetry ring, nullptr detaches it. The traced loops push a
+        ///        sample per step, so the bank must be stepped from one thread at a time.
+        void set_telemetry(pid_telemetry<float>* ptlm) { tlm = ptlm; }
+
+        /// @brief The attached telemetry ring, nullptr when off
+        pid_telemetry<float>* telemetry() const { return tlm; }
+
+        /// @brief Add a loop to or remove it from the traced loops
+        int trace_loop(size_t i, bool on);
+
+        /// @brief Process all loops of the bank
+        int step_all(uint64_t tstamp);
+
+        /// @brief Process loops [first, last) of the bank
+        int step_range(uint64_t tstamp, size_t first, size_t last);
+
+        /// @brief Process the loops listed in idx[0..count)
+        int step_list(uint64_t tstamp, const uint32_t* idx, size_t count);
+
+        /// @brief Time the loop is next due, the last calculation timestamp plus the Time Slice
+        uint64_t next_due(size_t i) const { return lts[i] + dtmin[i]; }
+
+        /// @brief Raw column pointers for the stepping kernels
+        pid_bank_view view();
+    };
+
+#endif /* _PID_BANK_H */
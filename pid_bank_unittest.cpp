@@ -0,0 +1,145 @@
+#include "pid_bank.hpp"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+// Configuration
+TEST(pid_bank, Configuration) {
+
+  pid_bank bank(5);
+  float kpv{4}, kiv{3}, kdv{2}, ll{1}, hl{0};
+  float rez0, rez1, rez2;
+  uint64_t tts0{0};
+
+  EXPECT_EQ(bank.size(), 5u);
+  EXPECT_EQ(bank.padded_size() % PID_BANK_LANES, 0u);
+
+  // Out of range loops are rejected
+  EXPECT_EQ(bank.set_gain_param(5, kpv, kiv, kdv), -1);
+  EXPECT_EQ(bank.set_loop(5, 1, 1, 1, 0), -1);
+
+  // Gain parameters round trip
+  EXPECT_EQ(bank.set_gain_param(2, kpv, kiv, kdv), 0);
+  bank.get_gain_param(2, rez0, rez1, rez2);
+  EXPECT_FLOAT_EQ(rez0, 4);
+  EXPECT_FLOAT_EQ(rez1, 3);
+  EXPECT_FLOAT_EQ(rez2, 2);
+
+  // Swapped limits are reordered and reported
+  EXPECT_EQ(bank.set_cp_limits(1, ll, hl), -1);
+  bank.get_co_limits(1, rez0, rez1);
+  EXPECT_FLOAT_EQ(rez0, 0);
+  EXPECT_FLOAT_EQ(rez1, 1);
+
+  // Wrong time slice
+  EXPECT_EQ(bank.set_dtmin_param(0, tts0), -1);
+  bank.get_dtmin_param(0, tts0);
+  EXPECT_EQ(tts0, 1u);
+
+  // Default loops run in Manual mode with Tieback 0
+  bank.tb_data()[3] = 7;
+  EXPECT_EQ(bank.step_all(100), 0);
+  EXPECT_FLOAT_EQ(bank.co_data()[3], 7);
+  EXPECT_FLOAT_EQ(bank.co_data()[4], 0);
+
+  EXPECT_EQ(bank.step_range(100, 3, 6), -1);
+}
+
+// The same scenarios as base_pid.Execution
+TEST(pid_bank, Execution) {
+
+  pid_bank bank(4);
+  bool man_sw{false};
+
+  bank.set_loop(0, 1, 0, 0, 0);
+  bank.set_loop(1, 0, 1, 0, 0);
+  bank.set_loop(2, 0, 0, 1, 0);
+  bank.set_loop(3, 1, 1, 1, 0);
+  for (size_t i = 0; i < 4; i++) {
+    bank.set_man_param(i, man_sw);
+  }
+
+  float* pv = bank.pv_data();
+  float* sp = bank.sp_data();
+  const float* co = bank.co_data();
+
+  pv[0] = 1; sp[0] = 0;
+  pv[1] = 0; sp[1] = 1;
+  pv[2] = 1; sp[2] = 0;
+  pv[3] = 0; sp[3] = 1;
+  bank.step_all(1000);
+
+  // StepUp
+  EXPECT_FLOAT_EQ(co[0], -1);
+  EXPECT_FLOAT_EQ(co[1], 0.001);
+  EXPECT_FLOAT_EQ(co[2], -1000);
+  EXPECT_FLOAT_EQ(co[3], 1001.001);
+
+  // StepDown
+  pv[0] = -1;
+  sp[1] = -1;
+  pv[2] = -1;
+  sp[3] = -1;
+  bank.step_all(2000);
+
+  EXPECT_FLOAT_EQ(co[0], 1);
+  EXPECT_FLOAT_EQ(co[1], 0.0);
+  EXPECT_FLOAT_EQ(co[2], 2000);
+  EXPECT_FLOAT_EQ(co[3], -2001);
+}
+
+// Every loop of the bank must be bit-identical to its own base_pid
+TEST(pid_bank, MatchesBasePid) {
+
+  const size_t nloops = 37;
+  std::mt19937 gen(12345);
+  std::uniform_real_distribution<float> val(-10, 10);
+  std::uniform_real_distribution<float> gain(0, 2);
+  std::uniform_int_distribution<int> coin(0, 3);
+  std::uniform_int_distribution<uint64_t> step(1, 400);
+
+  pid_bank bank(nloops);
+  std::vector<float> pv(nloops), sp(nloops), tb(nloops), co(nloops);
+  std::vector<base_pid> ref;
+  ref.reserve(nloops);
+
+  for (size_t i = 0; i < nloops; i++) {
+    float kpv = gain(gen), kiv = (coin(gen) == 0) ? 0 : gain(gen) * 100, kdv = gain(gen) * 1.0e-3f;
+    float dbv = gain(gen), collv = -5 - gain(gen), cohlv = 5 + gain(gen);
+    bool db_onv = coin(gen) == 0;
+    uint64_t dtminv = step(gen);
+    ref.emplace_back(&pv[i], &sp[i], &co[i], &tb[i], kpv, kiv, kdv, dbv,
+                     -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                     collv, cohlv, db_onv, true, dtminv);
+    bank.set_loop(i, kpv, kiv, kdv, dbv,
+                  -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                  collv, cohlv, db_onv, true, dtminv);
+  }
+
+  uint64_t tstamp = 0;
+  for (int cycle = 0; cycle < 2000; cycle++) {
+    tstamp += step(gen);
+    for (size_t i = 0; i < nloops; i++) {
+      pv[i] = bank.pv_data()[i] = val(gen);
+      sp[i] = bank.sp_data()[i] = val(gen);
+      tb[i] = bank.tb_data()[i] = val(gen);
+      if (coin(gen) == 0 && cycle % 50 == 0) {
+        bool man_sw = coin(gen) == 0;
+        ref[i].set_man_param(man_sw);
+        bank.set_man_param(i, man_sw);
+      }
+    }
+    for (size_t i = 0; i < nloops; i++) {
+      ref[i].run_pid(tstamp);
+    }
+    bank.step_all(tstamp);
+    for (size_t i = 0; i < nloops; i++) {
+      ASSERT_EQ(std::memcmp(&co[i], &bank.co_data()[i], sizeof(float)), 0)
+          << "loop " << i << " cycle " << cycle;
+    }
+  }
+}
+}  // namespace
@@ -0,0 +1,747 @@
+/**
+ * @file pid_bench.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief PID controller benchmarks, ns/step and cycles/step
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ * cycles/step is measured with the time stamp counter, i.e. in reference cycles
+ * at the nominal frequency, not in core cycles.
+ *
+ * BM_path_* time one path through base_pid::run_pid each, BM_path_step the throughput
+ * of pid_step on a local state. BM_bank_*, BM_vbank_* and
+ * BM_objects sweep the number of loops from 1 to 1M, so the per-loop cost shows where the
+ * working set falls out of L1, L2 and L3. BM_objects_shuffled steps the objects in a random
+ * order, a step then costs a miss per cache line of its controller and of its IO.
+ *
+ * BM_closed_loop_* step controllers and FOPDT plants together, a step is one loop
+ * and one plant sample.
+ *
+ * BM_replay runs a recorded trace sample by sample or through process(), a step is one
+ * sample.
+ *
+ * BM_startup_* configure a bank, through set_loop() per loop or from a binary config
+ * file, a step is one loop.
+ *
+ * BM_checkpoint_save is the per-cycle cost of a bank state snapshot, a step is one loop.
+ *
+ * BM_graph_* run cascades of two PIDs behind a lag filter, a step is one block.
+ *
+ * BM_historian_capture is the control-thread cost of exception reporting, a step is
+ * one loop, a given percentage of which moves every cycle.
+ *
+ * BM_image_cycle runs a bank over a process image, consecutive bindings are copied
+ * with memcpy, scattered ones (every loop in another page order) one by one.
+ */
+
+#include "pid.hpp"
+#include "pid_bank.hpp"
+#include "pid_checkpoint.hpp"
+#include "pid_config.hpp"
+#include "pid_executor.hpp"
+#include "pid_graph.hpp"
+#include "pid_historian.hpp"
+#include "pid_image.hpp"
+#include "pid_policy.hpp"
+#include "pid_scheduler.hpp"
+#include "pid_stats.hpp"
+#include "pid_velocity.hpp"
+#include "plant.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+// Call step(tstamp) once per iteration, every call runs nsteps controller steps,
+// report ns and cycles per controller step
+template <typename F>
+void run_steps(benchmark::State& state, uint64_t dt, double nsteps, F step) {
+  uint64_t tstamp = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  uint64_t c0 = cycles();
+  for (auto _ : state) {
+    tstamp += dt;
+    step(tstamp);
+  }
+  uint64_t c1 = cycles();
+  auto t1 = std::chrono::steady_clock::now();
+  double steps = nsteps * (double)state.iterations();
+  state.counters["ns/step"] = std::chrono::duration<double, std::nano>(t1 - t0).count() / steps;
+  state.counters["cycles/step"] = (double)(c1 - c0) / steps;
+}
+
+template <typename F>
+void run_steps(benchmark::State& state, uint64_t dt, F step) {
+  run_steps(state, dt, 1, step);
+}
+
+// Fixed-structure PI loop, base_pid against pid<Terms::PI>
+void BM_base_pid_PI(benchmark::State& state) {
+  float pv{0}, sp{1}, co{0}, kpv{0.5f}, kiv{10}, kdv{0}, ll{-100}, hl{100};
+  bool man_sw{false};
+  base_pid p(&pv, &sp, &co);
+  p.set_gain_param(kpv, kiv, kdv);
+  p.set_cp_limits(ll, hl);
+  p.set_man_param(man_sw);
+  run_steps(state, 100, [&](uint64_t t) {
+    pv = co * 0.01f;
+    p.run_pid(t);
+    benchmark::DoNotOptimize(co);
+  });
+}
+BENCHMARK(BM_base_pid_PI);
+
+void BM_policy_PI(benchmark::State& state) {
+  float pv{0}, sp{1}, co{0};
+  pid<Terms::PI> p(pv, sp, co);
+  p.set_gain_param(0.5f, 10, 0);
+  p.set_cp_limits(-100, 100);
+  run_steps(state, 100, [&](uint64_t t) {
+    pv = co * 0.01f;
+    p.run_pid(t);
+    benchmark::DoNotOptimize(co);
+  });
+}
+BENCHMARK(BM_policy_PI);
+
+// Full structure, base_pid against pid<Terms::PID, Deadband::On, Manual::On>
+void BM_base_pid_PID_full(benchmark::State& state) {
+  float pv{0}, sp{1}, co{0}, tb{0}, kpv{0.5f}, kiv{10}, kdv{0.001f}, ll{-100}, hl{100}, dbv{-1};
+  bool man_sw{false}, db_on{true};
+  base_pid p(&pv, &sp, &co, &tb);
+  p.set_gain_param(kpv, kiv, kdv);
+  p.set_cp_limits(ll, hl);
+  p.set_db_param(dbv, db_on);
+  p.set_man_param(man_sw);
+  run_steps(state, 100, [&](uint64_t t) {
+    pv = co * 0.01f;
+    p.run_pid(t);
+    benchmark::DoNotOptimize(co);
+  });
+}
+BENCHMARK(BM_base_pid_PID_full);
+
+void BM_policy_PID_full(benchmark::State& state) {
+  float pv{0}, sp{1}, co{0}, tb{0};
+  pid<Terms::PID, Deadband::On, Manual::On> p(pv, sp, co);
+  p.set_tieback(&tb);
+  p.set_gain_param(0.5f, 10, 0.001f);
+  p.set_cp_limits(-100, 100);
+  p.set_db_param(-1);
+  p.set_man_param(false);
+  run_steps(state, 100, [&](uint64_t t) {
+    pv = co * 0.01f;
+    p.run_pid(t);
+    benchmark::DoNotOptimize(co);
+  });
+}
+BENCHMARK(BM_policy_PID_full);
+
+// A full PID loop in Auto mode, tb is connected, limits are wide
+struct path_fixture {
+  float pv{0}, sp{1}, co{0}, tb{0.5f};
+  float kpv{0.5f}, kiv{10}, kdv{0.001f}, ll{-100}, hl{100};
+  base_pid p{&pv, &sp, &co, &tb};
+
+  path_fixture() {
+    bool man_sw{false};
+    p.set_gain_param(kpv, kiv, kdv);
+    p.set_cp_limits(ll, hl);
+    p.set_man_param(man_sw);
+  }
+};
+
+// dtmin early-out, the time slice never elapses
+void BM_path_dtmin_skip(benchmark::State& state) {
+  path_fixture f;
+  f.p.run_pid(1000);
+  run_steps(state, 0, [&](uint64_t) {
+    f.p.run_pid(1000);
+    benchmark::DoNotOptimize(f.co);
+  });
+}
+BENCHMARK(BM_path_dtmin_skip);
+
+// Manual mode, Tieback drives CO
+void BM_path_manual(benchmark::State& state) {
+  path_fixture f;
+  bool man_sw{true};
+  f.p.set_man_param(man_sw);
+  run_steps(state, 100, [&](uint64_t t) {
+    f.p.run_pid(t);
+    benchmark::DoNotOptimize(f.co);
+  });
+}
+BENCHMARK(BM_path_manual);
+
+// Manual step followed by the bumpless transfer step back to Auto, two steps per iteration
+void BM_path_bumpless(benchmark::State& state) {
+  path_fixture f;
+  bool man_on{true}, man_off{false};
+  run_steps(state, 200, 2, [&](uint64_t t) {
+    f.p.set_man_param(man_on);
+    f.p.run_pid(t);
+    f.p.set_man_param(man_off);
+    f.p.run_pid(t + 100);
+    benchmark::DoNotOptimize(f.co);
+  });
+}
+BENCHMARK(BM_path_bumpless);
+
+// Deadband skip, the error never leaves the Deadband
+void BM_path_deadband(benchmark::State& state) {
+  path_fixture f;
+  float dbv{10};
+  bool db_on{true};
+  f.p.set_db_param(dbv, db_on);
+  run_steps(state, 100, [&](uint64_t t) {
+    f.pv = (float)(t & 1);
+    f.p.run_pid(t);
+    benchmark::DoNotOptimize(f.co);
+  });
+}
+BENCHMARK(BM_path_deadband);
+
+// Unsaturated PID, CO stays inside the limits
+void BM_path_pid(benchmark::State& state) {
+  path_fixture f;
+  run_steps(state, 100, [&](uint64_t t) {
+    f.pv = f.co * 0.01f;
+    f.p.run_pid(t);
+    benchmark::DoNotOptimize(f.co);
+  });
+}
+BENCHMARK(BM_path_pid);
+
+// Unsaturated PID, pid_step on a local config and state, no controller around it.
+// PV follows a fixed sequence instead of CO, so the steps overlap and this is the
+// throughput of the step, not the latency of a closed loop.
+void BM_path_step(benchmark::State& state) {
+  path_fixture f;
+  pid_step_config<float> c{1, f.kpv, pid_traits<float>::ki_set(f.kiv), pid_traits<float>::kd_set(f.kdv),
+                           0, f.ll, f.hl, false, false};
+  pid_state<float> s{0, 0, 0, 0, false};
+  run_steps(state, 100, [&](uint64_t t) {
+    f.co = pid_step(c, s, pid_inputs<float>{t, (float)(t & 255) * 0.001f, f.sp, f.tb, false, false}).co;
+    benchmark::DoNotOptimize(f.co);
+  });
+}
+BENCHMARK(BM_path_step);
+
+// Unsaturated PID in the fixed-rate mode, steps on the period
+void BM_path_fixed_rate(benchmark::State& state) {
+  path_fixture f;
+  uint64_t per{100}, tol{10};
+  bool fault{false};
+  f.p.set_rate_param(per, tol, fault);
+  run_steps(state, 100, [&](uint64_t t) {
+    f.pv = f.co * 0.01f;
+    f.p.run_pid(t);
+    benchmark::DoNotOptimize(f.co);
+  });
+}
+BENCHMARK(BM_path_fixed_rate);
+
+// Sparse inputs, PV moves one step out of 16, first argument is the PID_EV_* mode;
+// saturated (1) leaves the clean steps nothing but keeping CO
+void BM_path_event(benchmark::State& state) {
+  path_fixture f;
+  uint8_t mode = (uint8_t)state.range(0);
+  f.p.set_event_param(mode);
+  f.sp = (state.range(1) != 0) ? 1000.0f : 1.0f;
+  uint64_t k = 0;
+  run_steps(state, 100, [&](uint64_t t) {
+    if ((++k & 15) == 0) {
+      f.pv = (float)(k & 255) * 0.001f;
+      f.p.set_dirty();
+    }
+    f.p.run_pid(t);
+    benchmark::DoNotOptimize(f.co);
+  });
+}
+BENCHMARK(BM_path_event)->ArgsProduct({{PID_EV_OFF, PID_EV_COMPARE, PID_EV_DIRTY}, {0, 1}})
+                        ->ArgNames({"mode", "saturated"});
+
+// Unsaturated PID counted in pid_stats, one call out of the argument is timed
+void BM_path_stats(benchmark::State& state) {
+  path_fixture f;
+  std::unique_ptr<pid_stats> st(new pid_stats((uint32_t)state.range(0)));
+  f.p.set_stats(st.get());
+  run_steps(state, 100, [&](uint64_t t) {
+    f.pv = f.co * 0.01f;
+    f.p.run_pid(t);
+    benchmark::DoNotOptimize(f.co);
+  });
+}
+BENCHMARK(BM_path_stats)->Arg(1)->Arg(64)->Arg(PID_STATS_EVERY)->Arg(4096)->ArgName("every");
+
+// Saturated PID, the anti-windup holds Iterm and CO is clamped
+void BM_path_antiwindup(benchmark::State& state) {
+  path_fixture f;
+  float ll{-1}, hl{1};
+  f.sp = 1000;
+  f.p.set_cp_limits(ll, hl);
+  run_steps(state, 100, [&](uint64_t t) {
+    f.p.run_pid(t);
+    benchmark::DoNotOptimize(f.co);
+  });
+}
+BENCHMARK(BM_path_antiwindup);
+
+// Bank sizes from 1 to 1M loops, the loops are in Auto and never saturate
+void bank_sizes(benchmark::internal::Benchmark* b) {
+  for (int64_t isa = 0; isa < 4; isa++) {
+    for (int64_t n = 1; n <= (1 << 20); n *= 4) {
+      b->Args({n, isa});
+    }
+  }
+}
+
+// One pid_bank::step_all per iteration, the second argument is the forced pid_isa tier
+void BM_bank_step_all(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  pid_isa isa = (pid_isa)state.range(1);
+  if (pid_isa_force(isa) != 0) {
+    state.SkipWithError("kernel tier is not supported");
+    return;
+  }
+  state.SetLabel(pid_isa_name(isa));
+
+  pid_bank bank(n);
+  for (size_t i = 0; i < n; i++) {
+    bank.set_loop(i, 0.5f, 10, 0.001f, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                  -100, 100, false, false, 10);
+    bank.sp_data()[i] = 1;
+    bank.pv_data()[i] = (float)(i % 7) * 0.1f;
+  }
+  run_steps(state, 100, (double)n, [&](uint64_t t) {
+    bank.step_all(t);
+    benchmark::ClobberMemory();
+  });
+  pid_isa_force(pid_isa_detect());
+}
+BENCHMARK(BM_bank_step_all)->Apply(bank_sizes)->ArgNames({"loops", "isa"});
+
+// One pid_vbank::step_all per iteration, the velocity form on the same loops
+void BM_vbank_step_all(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  pid_isa isa = (pid_isa)state.range(1);
+  if (pid_isa_force(isa) != 0) {
+    state.SkipWithError("kernel tier is not supported");
+    return;
+  }
+  state.SetLabel(pid_isa_name(isa));
+
+  pid_vbank bank(n);
+  pid_params<float> p{0.5f, 10, 0.001f, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                      -100, 100, 10, false};
+  bool man_sw{false};
+  for (size_t i = 0; i < n; i++) {
+    bank.set_params(i, p);
+    bank.set_man_param(i, man_sw);
+    bank.sp_data()[i] = 1;
+    bank.pv_data()[i] = (float)(i % 7) * 0.1f;
+  }
+  run_steps(state, 100, (double)n, [&](uint64_t t) {
+    bank.step_all(t);
+    benchmark::ClobberMemory();
+  });
+  pid_isa_force(pid_isa_detect());
+}
+BENCHMARK(BM_vbank_step_all)->Apply(bank_sizes)->ArgNames({"loops", "isa"});
+
+// Mixed rates, 1 loop in 64 runs every 100 usec tick, the rest every 10 to 100 ticks
+void mixed_rates(pid_bank& bank) {
+  for (size_t i = 0; i < bank.size(); i++) {
+    uint64_t dtmin = (i % 64 == 0) ? 100 : 1000 * (1 + i % 10);
+    bank.set_loop(i, 0.5f, 10, 0.001f, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                  -100, 100, false, false, dtmin);
+    bank.sp_data()[i] = 1;
+  }
+}
+
+void BM_mixed_step_all(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  pid_bank bank(n);
+  mixed_rates(bank);
+  run_steps(state, 100, (double)n, [&](uint64_t t) {
+    bank.step_all(t);
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_mixed_step_all)->RangeMultiplier(16)->Range(1 << 8, 1 << 20)->ArgName("loops");
+
+void BM_mixed_scheduler(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  pid_bank bank(n);
+  mixed_rates(bank);
+  pid_scheduler sched(bank, 100);
+  run_steps(state, 100, (double)n, [&](uint64_t t) {
+    sched.run_tick(t);
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_mixed_scheduler)->RangeMultiplier(16)->Range(1 << 8, 1 << 20)->ArgName("loops");
+
+// pid_executor cycles over 64K loops, the second argument is the number of workers
+void BM_executor(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  pid_bank bank(n);
+  for (size_t i = 0; i < n; i++) {
+    bank.set_loop(i, 0.5f, 10, 0.001f, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                  -100, 100, false, false, 10);
+    bank.sp_data()[i] = 1;
+  }
+  pid_executor ex(bank, (size_t)state.range(1));
+  run_steps(state, 100, (double)n, [&](uint64_t t) {
+    ex.run_cycle(t);
+  });
+  pid_executor_stats st = ex.stats();
+  state.counters["max_cycle_us"] = (double)st.max_ns * 1e-3;
+  state.counters["steals"] = (double)st.steals;
+}
+BENCHMARK(BM_executor)->ArgsProduct({{1 << 16}, {1, 2, 4, 8}})->ArgNames({"loops", "threads"})->UseRealTime();
+
+// The same loops as one base_pid object each
+void BM_objects(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  std::vector<float> pv(n), sp(n, 1.0f), co(n), tb(n);
+  std::vector<base_pid> loops;
+  loops.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    pv[i] = (float)(i % 7) * 0.1f;
+    loops.emplace_back(&pv[i], &sp[i], &co[i], &tb[i], 0.5f, 10.0f, 0.001f, 0.0f,
+                       -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__, -100.0f, 100.0f, false, false, 10);
+  }
+  run_steps(state, 100, (double)n, [&](uint64_t t) {
+    for (base_pid& p : loops) {
+      p.run_pid(t);
+    }
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_objects)->RangeMultiplier(4)->Range(1, 1 << 20)->ArgName("loops");
+
+// IO of one loop, kept together as a process image keeps it
+struct loop_io {
+  float pv, sp, co, tb;
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+// TSC cycles of a load
+uint64_t load_cycles(const void* p) {
+  unsigned aux;
+  _mm_mfence();
+  uint64_t t0 = __rdtscp(&aux);
+  (void)*static_cast<const volatile char*>(p);
+  return __rdtscp(&aux) - t0;
+}
+
+// Reaches the protected cold block of any base_pid
+struct cold_probe : base_pid {
+  static const pid_cold<float>& of(const base_pid& p) { return (p.*&cold_probe::cold)(); }
+};
+
+// Lines a step reads or writes of its controller, the controller's cold block and its IO,
+// counted by flush and reload: every line is flushed, the loop stepped, and a line that
+// loads in cache time was touched by the step
+double lines_touched(std::vector<base_pid>& loops, std::vector<loop_io>& io, uint64_t tstamp) {
+  const uint64_t hit = 120;   // Cycles, well above a hit in L2 and below a miss to DRAM
+  const size_t nsamples = 1000;
+  size_t touched = 0;
+  for (size_t k = 0; k < nsamples; k++) {
+    size_t i = (k * 7919) % loops.size();
+    std::vector<const char*> lines;
+    for (size_t o = 0; o < sizeof(base_pid); o += PID_CACHE_LINE) {
+      lines.push_back(reinterpret_cast<const char*>(&loops[i]) + o);
+    }
+    const pid_cold<float>& cold = cold_probe::of(loops[i]);
+    for (size_t o = 0; o < sizeof(cold); o += PID_CACHE_LINE) {
+      lines.push_back(reinterpret_cast<const char*>(&cold) + o);
+    }
+    lines.push_back(reinterpret_cast<const char*>(&io[i]));
+    for (const char* l : lines) {
+      _mm_clflush(l);
+    }
+    _mm_mfence();
+    tstamp += 100;
+    loops[i].run_pid(tstamp);
+    for (const char* l : lines) {
+      touched += (load_cycles(l) < hit) ? 1 : 0;
+    }
+  }
+  return (double)touched / (double)nsamples;
+}
+#endif
+
+// The same objects stepped in a shuffled order, so the prefetcher cannot hide the misses
+// and every step pays for each line it touches: its controller and its IO. lines/loop is
+// the count of those lines, measured by flush and reload where no miss counter is at hand
+void BM_objects_shuffled(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  std::vector<loop_io> io(n);
+  std::vector<base_pid> loops;
+  std::vector<uint32_t> order(n);
+  loops.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    io[i] = loop_io{(float)(i % 7) * 0.1f, 1.0f, 0.0f, 0.0f};
+    loops.emplace_back(&io[i].pv, &io[i].sp, &io[i].co, &io[i].tb, 0.5f, 10.0f, 0.001f, 0.0f,
+                       -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__, -100.0f, 100.0f, false, false, 10);
+    order[i] = (uint32_t)i;
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(1));
+  uint64_t last = 0;
+  run_steps(state, 100, (double)n, [&](uint64_t t) {
+    for (uint32_t i : order) {
+      loops[i].run_pid(t);
+    }
+    last = t;
+    benchmark::ClobberMemory();
+  });
+#if defined(__x86_64__) || defined(__i386__)
+  state.counters["lines/loop"] = lines_touched(loops, io, last);
+#endif
+}
+BENCHMARK(BM_objects_shuffled)->Arg(1 << 14)->Arg(1 << 20)->ArgName("loops");
+
+// PI loops against FOPDT plants, one closed-loop sample per loop per iteration
+void BM_closed_loop_bank(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  pid_bank pids(n);
+  plant_bank plants(n, 16);
+  plant_model model = plant_fopdt(2.0, 0.1, 0.01, 0.001);
+  for (size_t i = 0; i < n; i++) {
+    pids.set_loop(i, 0.5f, 2.0f, 0, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                  -10, 10, false, false, 1);
+    pids.sp_data()[i] = 1;
+    plants.set_plant(i, model);
+  }
+  run_steps(state, 1000, (double)n, [&](uint64_t t) {
+    run_closed_loop(pids, plants, t, 1000, 1);
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_closed_loop_bank)->RangeMultiplier(16)->Range(1, 1 << 20)->ArgName("loops");
+
+void BM_closed_loop_scalar(benchmark::State& state) {
+  float pv{0}, sp{1}, co{0}, tb{0};
+  base_pid p(&pv, &sp, &co, &tb, 0.5f, 2.0f, 0, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+             -10, 10, false, false, 1);
+  plant fopdt(plant_fopdt(2.0, 0.1, 0.01, 0.001));
+  run_steps(state, 1000, [&](uint64_t t) {
+    run_closed_loop(p, pv, co, fopdt, t, 1000, 1);
+    benchmark::DoNotOptimize(pv);
+  });
+}
+BENCHMARK(BM_closed_loop_scalar);
+
+// Replay of a recorded trace, per sample through run_pid (0) or in one process() call (1)
+void BM_replay(benchmark::State& state) {
+  const size_t n = 4096;
+  bool block = state.range(0) != 0;
+  std::vector<uint64_t> t(n);
+  std::vector<float> pvs(n), sps(n), cos(n);
+  for (size_t k = 0; k < n; k++) {
+    pvs[k] = (float)(k % 13) * 0.1f;
+    sps[k] = (k % 1000 < 500) ? 1.0f : 2.0f;
+  }
+  path_fixture f;
+  run_steps(state, n * 100, (double)n, [&](uint64_t t0) {
+    for (size_t k = 0; k < n; k++) {
+      t[k] = t0 + k * 100;
+    }
+    if (block) {
+      f.p.process(t.data(), pvs.data(), sps.data(), cos.data(), n);
+    }
+    else {
+      for (size_t k = 0; k < n; k++) {
+        f.pv = pvs[k];
+        f.sp = sps[k];
+        f.p.run_pid(t[k]);
+        cos[k] = f.co;
+      }
+    }
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_replay)->Arg(0)->Arg(1)->ArgName("block");
+
+// gather, step_all and scatter over a process image
+void BM_image_cycle(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  bool scattered = state.range(1) != 0;
+  pid_image img;
+  img.create(3 * n, n);
+  pid_bank bank(n);
+  pid_image_map map(n);
+  for (size_t i = 0; i < n; i++) {
+    bank.set_loop(i, 0.5f, 2.0f, 0, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                  -10, 10, false, false, 1);
+    if (scattered) {
+      // An odd multiplier permutes the power of two loop counts, the signals of a loop are interleaved
+      uint32_t k = (uint32_t)((i * 40503) % n);
+      map.bind(i, 3 * k, 3 * k + 1, 3 * k + 2, k);
+    }
+    else {
+      map.bind(i, (uint32_t)i, (uint32_t)(n + i), (uint32_t)(2 * n + i), (uint32_t)i);
+    }
+  }
+  run_steps(state, 1000, (double)n, [&](uint64_t t) {
+    img.publish_inputs();
+    map.run_cycle(img, bank, t);
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_image_cycle)->ArgsProduct({{1 << 8, 1 << 14, 1 << 20}, {0, 1}})->ArgNames({"loops", "scattered"});
+
+
+// Cascades of two PIDs, PV of the secondary through a lag filter, built in one graph
+void build_cascades(pid_graph& g, size_t ncas) {
+  float kpv{1}, kiv{5}, kdv{0}, ll{-100}, hl{100};
+  bool man_sw{false};
+  for (uint32_t c = 0; c < ncas; c++) {
+    uint32_t b = c * 6;
+    g.add_lag(b + 3, b + 5, 1000);
+    uint32_t blk[2] = {g.add_pid(b, b + 1, b + 2), g.add_pid(b + 5, b + 2, b + 4)};
+    for (uint32_t k : blk) {
+      g.pid(k)->set_gain_param(kpv, kiv, kdv);
+      g.pid(k)->set_cp_limits(ll, hl);
+      g.pid(k)->set_man_param(man_sw);
+    }
+  }
+  g.compile();
+}
+
+void BM_graph_run(benchmark::State& state) {
+  size_t ncas = (size_t)state.range(0);
+  pid_graph g(ncas * 6);
+  build_cascades(g, ncas);
+  run_steps(state, 1000, (double)g.size(), [&](uint64_t t) {
+    g.run(t);
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_graph_run)->RangeMultiplier(16)->Range(1, 1 << 16)->ArgName("cascades");
+
+void BM_graph_executor(benchmark::State& state) {
+  size_t ncas = (size_t)state.range(0);
+  pid_graph g(ncas * 6);
+  build_cascades(g, ncas);
+  pid_graph_executor ex(g, (size_t)state.range(1));
+  run_steps(state, 1000, (double)g.size(), [&](uint64_t t) {
+    ex.run_cycle(t);
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_graph_executor)->ArgsProduct({{1 << 14}, {1, 2, 4}})->ArgNames({"cascades", "threads"})->UseRealTime();
+
+
+void BM_startup_set_loop(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  pid_bank bank(n);
+  run_steps(state, 1, (double)n, [&](uint64_t) {
+    for (size_t i = 0; i < n; i++) {
+      bank.set_loop(i, 0.5f, 2.0f, 0, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                    -10, 10, false, false, 1 + i % 4);
+    }
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_startup_set_loop)->Arg(100000)->Arg(1 << 20)->ArgName("loops");
+
+// One base_pid per loop through the full constructor
+void BM_startup_objects(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  std::vector<float> io(4 * n);
+  run_steps(state, 1, (double)n, [&](uint64_t) {
+    std::vector<base_pid> loops;
+    loops.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+      loops.emplace_back(&io[4 * i], &io[4 * i + 1], &io[4 * i + 2], &io[4 * i + 3], 0.5f, 2.0f, 0.0f, 0.0f,
+                         -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__, -10.0f, 10.0f, false, false, 1 + i % 4);
+    }
+    benchmark::DoNotOptimize(loops.data());
+  });
+}
+BENCHMARK(BM_startup_objects)->Arg(100000)->Arg(1 << 20)->ArgName("loops");
+
+// mmap, validation and column copies of a file in the page cache
+void BM_startup_config(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  pid_bank bank(n);
+  for (size_t i = 0; i < n; i++) {
+    bank.set_loop(i, 0.5f, 2.0f, 0, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                  -10, 10, false, false, 1 + i % 4);
+  }
+  const char* path = "/tmp/pid_bench_config";
+  bank.save_config(path);
+  run_steps(state, 1, (double)n, [&](uint64_t) {
+    pid_config cfg;
+    cfg.open(path);
+    bank.load_config(cfg);
+    benchmark::ClobberMemory();
+  });
+  std::remove(path);
+}
+BENCHMARK(BM_startup_config)->Arg(100000)->Arg(1 << 20)->ArgName("loops");
+
+
+void BM_checkpoint_save(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  pid_bank bank(n);
+  pid_checkpoint cp;
+  const char* path = "/tmp/pid_bench_checkpoint";
+  cp.open(path, n);
+  run_steps(state, 1000, (double)n, [&](uint64_t t) {
+    bank.save_state(cp, t);
+    benchmark::ClobberMemory();
+  });
+  cp.close();
+  std::remove(path);
+}
+BENCHMARK(BM_checkpoint_save)->RangeMultiplier(16)->Range(1 << 8, 1 << 20)->ArgName("loops");
+
+
+void BM_historian_capture(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  size_t moving = n * (size_t)state.range(1) / 100;
+  std::vector<float> sp(n, 1.0f), pv(n, 0.0f), co(n, 0.0f);
+  pid_historian h(n, 1 << 20);
+  const char* path = "/tmp/pid_bench_historian";
+  h.open(path);
+  run_steps(state, 1000, (double)n, [&](uint64_t t) {
+    for (size_t i = 0; i < moving; i++) {
+      pv[i] = (float)(t & 0xff);
+    }
+    h.capture(t, sp.data(), pv.data(), co.data());
+  });
+  h.close();
+  state.counters["dropped"] = (double)h.dropped();
+  std::remove(path);
+}
+BENCHMARK(BM_historian_capture)->ArgsProduct({{1 << 10, 1 << 16}, {0, 1, 10}})->ArgNames({"loops", "moving%"});
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,165 @@
+/**
+ * @file pid_checkpoint.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Checkpoint of the controller dynamic state
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pid_checkpoint.hpp"
+
+static_assert(sizeof(pid_checkpoint_header) <= PID_CHECKPOINT_PAGE, "the header must fit in one page");
+
+    static inline uint64_t align_up(uint64_t bytes, uint64_t align) {
+        return (bytes + align - 1) / align * align;
+    };
+
+    /// @brief Size of one slot of nloops loops, the columns are cache line aligned
+    static uint64_t slot_bytes(uint64_t nloops) {
+        uint64_t wide = align_up(nloops * sizeof(uint64_t), PID_CACHE_LINE);
+        uint64_t narrow = align_up(nloops * sizeof(float), PID_CACHE_LINE);
+        uint64_t flags = align_up(nloops, PID_CACHE_LINE);
+        return align_up(wide + 3 * narrow + flags, PID_CHECKPOINT_PAGE);
+    };
+
+    pid_checkpoint::pid_checkpoint() :
+        base{nullptr},
+        bytes{0},
+        hdr{nullptr}
+        {};
+
+    pid_checkpoint::~pid_checkpoint() {
+        close();
+    };
+
+    pid_state_columns pid_checkpoint::slot(uint64_t k) const {
+        char* p = (char*)base + hdr->slot_off[k & 1];
+        uint64_t wide = align_up(hdr->nloops * sizeof(uint64_t), PID_CACHE_LINE);
+        uint64_t narrow = align_up(hdr->nloops * sizeof(float), PID_CACHE_LINE);
+        return pid_state_columns{(uint64_t*)p,
+                                 (float*)(p + wide),
+                                 (float*)(p + wide + narrow),
+                                 (float*)(p + wide + 2 * narrow),
+                                 (uint8_t*)(p + wide + 3 * narrow)};
+    };
+
+        /// @brief Map a checkpoint. A file left by an earlier run of the same number of
+        ///        loops keeps its snapshot, any other file is replaced by an empty one
+        /// @param path   File of the checkpoint
+        /// @param nloops Number of loops
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_checkpoint::open(const char* path, size_t nloops) {
+        close();
+        int fd = ::open(path, O_RDWR | O_CREAT, 0600);
+        if (fd < 0) {
+            return -1;
+        }
+        uint64_t sbytes = slot_bytes(nloops);
+        size_t size = PID_CHECKPOINT_PAGE + 2 * sbytes;
+
+        struct stat st;
+        bool reuse = fstat(fd, &st) == 0 && (uint64_t)st.st_size == size;
+        if (!reuse && (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)size) != 0)) {
+            ::close(fd);
+            return -1;
+        }
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return -1;
+        }
+
+        pid_checkpoint_header* h = (pid_checkpoint_header*)p;
+        reuse = reuse && h->magic == PID_CHECKPOINT_MAGIC && h->version == PID_CHECKPOINT_VERSION &&
+                h->nloops == nloops && h->bytes == size &&
+                h->slot_off[0] == PID_CHECKPOINT_PAGE && h->slot_off[1] == PID_CHECKPOINT_PAGE + sbytes;
+        if (!reuse) {
+            h->magic = 0;
+            h->version = PID_CHECKPOINT_VERSION;
+            h->nloops = nloops;
+            h->bytes = size;
+            h->slot_off[0] = PID_CHECKPOINT_PAGE;
+            h->slot_off[1] = PID_CHECKPOINT_PAGE + sbytes;
+            h->tstamp[0] = 0;
+            h->tstamp[1] = 0;
+            h->seq.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            h->magic = PID_CHECKPOINT_MAGIC;
+        }
+        base = p;
+        bytes = size;
+        hdr = h;
+        return 0;
+    };
+
+    void pid_checkpoint::close() {
+        if (base != nullptr) {
+            munmap(base, bytes);
+        }
+        base = nullptr;
+        bytes = 0;
+        hdr = nullptr;
+    };
+
+        /// @param tstamp - Clock the snapshot was taken at
+    void pid_checkpoint::commit(uint64_t tstamp) {
+        uint64_t next = hdr->seq.load(std::memory_order_relaxed) + 1;
+        hdr->tstamp[next & 1] = tstamp;
+        hdr->seq.store(next, std::memory_order_release);
+    };
+
+        /// @param loops  - Controllers, loop i of the checkpoint is loops[i]
+        /// @param count  - Number of controllers, the size of the checkpoint
+        /// @param tstamp - Clock the snapshot is taken at
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_checkpoint::save(base_pid* const* loops, size_t count, uint64_t tstamp) {
+        if (hdr == nullptr || count != hdr->nloops) {
+            return -1;
+        }
+        pid_state_columns c = write_slot();
+        pid_state<float> st;
+        for (size_t i = 0; i < count; i++) {
+            loops[i]->get_state(st);
+            c.lts[i] = st.lts;
+            c.Iterm[i] = st.Iterm;
+            c.lerr[i] = st.lerr;
+            c.lco[i] = st.lco;
+            c.lman_on[i] = st.lman_on;
+        }
+        commit(tstamp);
+        return 0;
+    };
+
+        /// @param loops - Controllers, loop i of the checkpoint is loops[i]
+        /// @param count - Number of controllers, the size of the checkpoint
+        /// @param now   - Clock of the restarted process
+        /// @return 0  - O'k
+        ///         -1 - Error, no snapshot or another number of loops
+    int pid_checkpoint::restore(base_pid* const* loops, size_t count, uint64_t now) const {
+        if (!has_snapshot() || count != hdr->nloops) {
+            return -1;
+        }
+        pid_state_columns c = read_slot();
+        uint64_t snap = tstamp();
+        pid_state<float> st;
+        for (size_t i = 0; i < count; i++) {
+            st.lts = pid_rebase(c.lts[i], snap, now);
+            st.Iterm = c.Iterm[i];
+            st.lerr = c.lerr[i];
+            st.lco = c.lco[i];
+            st.lman_on = c.lman_on[i] != 0;
+            loops[i]->set_state(st);
+        }
+        return 0;
+    };
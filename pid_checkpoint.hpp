@@ -0,0 +1,108 @@
+/**
+ * @file pid_checkpoint.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the checkpoint of the controller dynamic state
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ * The checkpoint is a shared file mapping with a header page and two slots. A save
+ * copies the state columns into the slot that is not current and then bumps the
+ * sequence, so a process killed in the middle of a save leaves the previous snapshot
+ * intact. The pages are written back by the kernel, a save is only memory copies and
+ * can run every cycle; the snapshot survives a crash of the process, not of the host.
+ *
+ * On restore lts is rebased onto the new clock: a loop that was age usec past its
+ * last step at the snapshot is age usec past it at restore time, so the time the
+ * process was down is neither integrated nor skipped by the Time Slice.
+ */
+#ifndef _PID_CHECKPOINT_H
+#define _PID_CHECKPOINT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "pid.hpp"
+#include "pid_alloc.hpp"
+
+#define PID_CHECKPOINT_MAGIC 0x4b434950u // "PICK"
+#define PID_CHECKPOINT_VERSION 1
+#define PID_CHECKPOINT_PAGE 4096         // Alignment of the header and the slots
+
+/// @brief Header at the start of the checkpoint file
+struct pid_checkpoint_header {
+    uint32_t magic;             // PID_CHECKPOINT_MAGIC
+    uint32_t version;           // PID_CHECKPOINT_VERSION
+    uint64_t nloops;            // Number of loops
+    uint64_t bytes;             // Size of the file
+    uint64_t slot_off[2];       // Byte offsets of the slots
+    uint64_t tstamp[2];         // Clock of the snapshot in every slot
+    alignas(PID_CACHE_LINE) std::atomic<uint64_t> seq;   // Snapshots saved, the current one is in slot seq & 1
+};
+
+/// @brief State columns of one slot, loop i is element i of every column
+struct pid_state_columns {
+    uint64_t* lts;
+    float* Iterm;
+    float* lerr;
+    float* lco;
+    uint8_t* lman_on;
+};
+
+/// @brief lts of a snapshot taken at snap, moved onto the clock now
+static inline uint64_t pid_rebase(uint64_t lts, uint64_t snap, uint64_t now) {
+    uint64_t age = (snap > lts) ? snap - lts : 0;
+    return (now > age) ? now - age : 0;
+}
+
+/// @brief A checkpoint file mapped into this process
+class pid_checkpoint {
+
+    void* base;                 // Mapping
+    size_t bytes;               // Size of the mapping
+    pid_checkpoint_header* hdr;
+
+    pid_state_columns slot(uint64_t k) const;
+
+    public:
+        pid_checkpoint();
+        ~pid_checkpoint();
+
+        pid_checkpoint(const pid_checkpoint&) = delete;
+        pid_checkpoint& operator=(const pid_checkpoint&) = delete;
+
+        /// @brief Map the checkpoint of nloops loops, an existing file of another size is recreated
+        int open(const char* path, size_t nloops);
+
+        /// @brief Unmap the file
+        void close();
+
+        /// @brief Number of loops, 0 if nothing is mapped
+        size_t size() const { return (hdr == nullptr) ? 0 : hdr->nloops; }
+
+        /// @brief True if a snapshot was saved
+        bool has_snapshot() const { return hdr != nullptr && hdr->seq.load(std::memory_order_acquire) != 0; }
+
+        /// @brief Clock of the current snapshot
+        uint64_t tstamp() const { return hdr->tstamp[hdr->seq.load(std::memory_order_acquire) & 1]; }
+
+        /// @brief Columns to fill for the next snapshot
+        pid_state_columns write_slot() { return slot(hdr->seq.load(std::memory_order_relaxed) + 1); }
+
+        /// @brief Make the filled slot the current snapshot
+        void commit(uint64_t tstamp);
+
+        /// @brief Columns of the current snapshot
+        pid_state_columns read_slot() const { return slot(hdr->seq.load(std::memory_order_acquire)); }
+
+        /// @brief Save the state of count single controllers
+        int save(base_pid* const* loops, size_t count, uint64_t tstamp);
+
+        /// @brief Restore the state of count single controllers
+        int restore(base_pid* const* loops, size_t count, uint64_t now) const;
+};
+
+#endif /* _PID_CHECKPOINT_H */
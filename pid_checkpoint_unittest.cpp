@@ -0,0 +1,148 @@
+#include "pid_bank.hpp"
+#include "pid_checkpoint.hpp"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+std::string temp_path(const char* name) {
+
+  return std::string("/tmp/") + name + "_" + std::to_string(getpid());
+}
+
+void configure(pid_bank& bank) {
+
+  for (size_t i = 0; i < bank.size(); i++) {
+    bank.set_loop(i, 0.8f, 40.0f, (i % 3 == 0) ? 0.002f : 0.0f, 0.1f, -__FLT_MAX__, __FLT_MAX__,
+                  -__FLT_MAX__, __FLT_MAX__, -20.0f, 20.0f, i % 4 == 0, i % 9 == 0, 1 + i % 5);
+  }
+}
+
+// lts keeps its age relative to the snapshot
+TEST(pid_checkpoint, Rebase) {
+
+  EXPECT_EQ(pid_rebase(900, 1000, 5000000), 4999900u);
+  EXPECT_EQ(pid_rebase(1000, 1000, 7), 7u);
+  EXPECT_EQ(pid_rebase(0, 1000, 500), 0u);
+  EXPECT_EQ(pid_rebase(1200, 1000, 500), 500u);
+}
+
+// A bank restarted on another clock continues bit-identically to one that never stopped
+TEST(pid_checkpoint, BankWarmRestart) {
+
+  const size_t n = 300;
+  std::string path = temp_path("pid_checkpoint");
+  std::remove(path.c_str());
+  std::mt19937 gen(16);
+  std::uniform_real_distribution<float> val(-5, 5);
+  pid_bank run(n);
+  configure(run);
+
+  {
+    pid_checkpoint cp;
+    ASSERT_EQ(cp.open(path.c_str(), n), 0);
+    EXPECT_FALSE(cp.has_snapshot());
+    for (uint64_t t = 1; t <= 50; t++) {
+      for (size_t i = 0; i < n; i++) {
+        run.pv_data()[i] = val(gen);
+        run.sp_data()[i] = val(gen);
+      }
+      run.step_all(1000000 + t * 3);
+      ASSERT_EQ(run.save_state(cp, 1000000 + t * 3), 0);
+    }
+    // A save cut short is not committed
+    cp.write_slot().Iterm[0] = 1.0e+30f;
+  }
+
+  pid_checkpoint cp;
+  pid_bank warm(n), cold(n);
+  configure(warm);
+  configure(cold);
+  ASSERT_EQ(cp.open(path.c_str(), n), 0);
+  ASSERT_TRUE(cp.has_snapshot());
+  EXPECT_EQ(cp.tstamp(), 1000150u);
+  EXPECT_EQ(cold.restore_state(cp, 0), 0);
+  pid_bank other(n + 1);
+  EXPECT_EQ(other.restore_state(cp, 0), -1);
+  ASSERT_EQ(warm.restore_state(cp, 70), 0);
+
+  pid_state<float> a, b;
+  run.get_state(0, a);
+  warm.get_state(0, b);
+  EXPECT_EQ(a.Iterm, b.Iterm);
+
+  for (uint64_t t = 1; t <= 50; t++) {
+    for (size_t i = 0; i < n; i++) {
+      run.pv_data()[i] = warm.pv_data()[i] = val(gen);
+      run.sp_data()[i] = warm.sp_data()[i] = val(gen);
+    }
+    run.step_all(1000150 + t * 3);
+    warm.step_all(70 + t * 3);
+    ASSERT_EQ(std::memcmp(run.co_data(), warm.co_data(), n * sizeof(float)), 0) << "step " << t;
+  }
+  cp.close();
+
+  // Another number of loops starts from an empty checkpoint
+  ASSERT_EQ(cp.open(path.c_str(), n + 1), 0);
+  EXPECT_FALSE(cp.has_snapshot());
+  EXPECT_EQ(other.restore_state(cp, 0), -1);
+  cp.close();
+  std::remove(path.c_str());
+}
+
+// Single controllers through the same file
+TEST(pid_checkpoint, BasePid) {
+
+  const size_t n = 3;
+  std::string path = temp_path("pid_checkpoint_single");
+  std::remove(path.c_str());
+  float pv[n] = {}, sp[n] = {1, 2, 3}, co[n] = {}, kpv{1}, kiv{10}, kdv{0};
+  bool man_sw{false};
+  std::vector<base_pid> run, warm;
+  for (size_t i = 0; i < n; i++) {
+    run.emplace_back(&pv[i], &sp[i], &co[i]);
+    warm.emplace_back(&pv[i], &sp[i], &co[i]);
+  }
+  base_pid* prun[n];
+  base_pid* pwarm[n];
+  for (size_t i = 0; i < n; i++) {
+    for (base_pid* p : {&run[i], &warm[i]}) {
+      p->set_gain_param(kpv, kiv, kdv);
+      p->set_man_param(man_sw);
+    }
+    prun[i] = &run[i];
+    pwarm[i] = &warm[i];
+  }
+
+  pid_checkpoint cp;
+  ASSERT_EQ(cp.open(path.c_str(), n), 0);
+  EXPECT_EQ(cp.restore(pwarm, n, 0), -1);
+  for (uint64_t t = 1; t <= 10; t++) {
+    for (base_pid* p : prun) {
+      p->run_pid(t * 1000);
+    }
+  }
+  ASSERT_EQ(cp.save(prun, n, 10000), 0);
+  EXPECT_EQ(cp.save(prun, n - 1, 10000), -1);
+  ASSERT_EQ(cp.restore(pwarm, n, 500), 0);
+
+  for (uint64_t t = 1; t <= 10; t++) {
+    float a[n], b[n];
+    for (size_t i = 0; i < n; i++) {
+      run[i].run_pid(10000 + t * 1000);
+      a[i] = co[i];
+      warm[i].run_pid(500 + t * 1000);
+      b[i] = co[i];
+    }
+    ASSERT_EQ(std::memcmp(a, b, sizeof(a)), 0) << "step " << t;
+  }
+  cp.close();
+  std::remove(path.c_str());
+}
+}  // namespace
@@ -0,0 +1,183 @@
+/**
+ * @file pid_config.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Binary loop configuration file
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ */
+
+#include <cstdio>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pid.hpp"
+#include "pid_config.hpp"
+
+    /// @brief Size of one element of a column
+    static size_t column_width(int c) {
+        return (c == PID_CFG_DTMIN) ? sizeof(uint64_t) :
+               (c == PID_CFG_DB_ON || c == PID_CFG_MAN_ON) ? sizeof(uint8_t) : sizeof(float);
+    };
+
+    /// @brief Column offsets of a file of nloops loops
+    /// @return Size of the file
+    static uint64_t column_layout(uint64_t nloops, uint64_t* offset) {
+        uint64_t pos = (sizeof(pid_config_header) + PID_CONFIG_ALIGN - 1) / PID_CONFIG_ALIGN * PID_CONFIG_ALIGN;
+        for (int c = 0; c < PID_CFG_COLUMNS; c++) {
+            offset[c] = pos;
+            pos += (nloops * column_width(c) + PID_CONFIG_ALIGN - 1) / PID_CONFIG_ALIGN * PID_CONFIG_ALIGN;
+        }
+        return pos;
+    };
+
+    static pid_config_columns columns_at(const void* base, const uint64_t* offset) {
+        const char* p = (const char*)base;
+        return pid_config_columns{
+            (const float*)(p + offset[PID_CFG_KP]),
+            (const float*)(p + offset[PID_CFG_KI]),
+            (const float*)(p + offset[PID_CFG_KD]),
+            (const float*)(p + offset[PID_CFG_DB]),
+            (const float*)(p + offset[PID_CFG_PVLL]),
+            (const float*)(p + offset[PID_CFG_PVHL]),
+            (const float*)(p + offset[PID_CFG_SPLL]),
+            (const float*)(p + offset[PID_CFG_SPHL]),
+            (const float*)(p + offset[PID_CFG_COLL]),
+            (const float*)(p + offset[PID_CFG_COHL]),
+            (const uint64_t*)(p + offset[PID_CFG_DTMIN]),
+            (const uint8_t*)(p + offset[PID_CFG_DB_ON]),
+            (const uint8_t*)(p + offset[PID_CFG_MAN_ON])};
+    };
+
+    /// @brief The checks of pid_bank::set_params on the stored values, the gains are stored
+    ///        reduced to usec as the bank keeps them
+    /// @return 0  - O'k
+    ///         -1 - Error
+    static int check_loops(const pid_config_columns& c, size_t nloops) {
+        typedef pid_traits<float> traits;
+        // Branch free, one pass over the columns
+        uint32_t bad = 0;
+        for (size_t i = 0; i < nloops; i++) {
+            pid_params<float> p{c.kp[i], traits::ki_get(c.ki[i]), traits::kd_get(c.kd[i]), c.db[i],
+                                c.pvll[i], c.pvhl[i], c.spll[i], c.sphl[i], c.coll[i], c.cohl[i],
+                                c.dtmin[i], false};
+            bad |= !pid_params_valid(p) | (c.db_on[i] > 1) | (c.man_on[i] > 1);
+        }
+        return (bad == 0) ? 0 : -1;
+    };
+
+    pid_config::pid_config() :
+        base{nullptr},
+        bytes{0},
+        hdr{nullptr}
+        {};
+
+    pid_config::~pid_config() {
+        close();
+    };
+
+        /// @brief Map a file and validate the layout and every loop, a file mapped before is unmapped
+        /// @param path File written by pid_config_write() or pid_bank::save_config()
+        /// @return 0  - O'k
+        ///         -1 - Error, no such file, another version or byte order, or an invalid loop
+    int pid_config::open(const char* path) {
+        close();
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            return -1;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(pid_config_header)) {
+            ::close(fd);
+            return -1;
+        }
+        size_t size = (size_t)st.st_size;
+        void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return -1;
+        }
+
+        // The layout is derived from nloops, a file laid out differently is not accepted
+        const pid_config_header* h = (const pid_config_header*)p;
+        bool valid = h->magic == PID_CONFIG_MAGIC && h->version == PID_CONFIG_VERSION &&
+                     h->endian == PID_CONFIG_ENDIAN && h->ncolumns == PID_CFG_COLUMNS &&
+                     h->bytes == size && h->nloops < (UINT64_MAX >> 8);
+        uint64_t offset[PID_CFG_COLUMNS];
+        valid = valid && column_layout(h->nloops, offset) == size;
+        for (int c = 0; valid && c < PID_CFG_COLUMNS; c++) {
+            valid = h->offset[c] == offset[c];
+        }
+        if (!valid || check_loops(columns_at(p, h->offset), h->nloops) != 0) {
+            munmap(p, size);
+            return -1;
+        }
+        base = p;
+        bytes = size;
+        hdr = h;
+        return 0;
+    };
+
+    void pid_config::close() {
+        if (base != nullptr) {
+            munmap(base, bytes);
+        }
+        base = nullptr;
+        bytes = 0;
+        hdr = nullptr;
+    };
+
+    pid_config_columns pid_config::columns() const {
+        return columns_at(base, hdr->offset);
+    };
+
+        /// @brief Write the file next to path and rename it over path, so a reader never
+        ///        maps a partly written file
+        /// @param path   File to write
+        /// @param nloops Number of loops
+        /// @param c      Columns in pid_bank units
+        /// @return 0  - O'k
+        ///         -1 - Error, an invalid loop or an IO error
+    int pid_config_write(const char* path, size_t nloops, const pid_config_columns& c) {
+        if (check_loops(c, nloops) != 0) {
+            return -1;
+        }
+        pid_config_header h{};
+        h.magic = PID_CONFIG_MAGIC;
+        h.version = PID_CONFIG_VERSION;
+        h.endian = PID_CONFIG_ENDIAN;
+        h.ncolumns = PID_CFG_COLUMNS;
+        h.nloops = nloops;
+        h.bytes = column_layout(nloops, h.offset);
+
+        const void* data[PID_CFG_COLUMNS] = {c.kp, c.ki, c.kd, c.db, c.pvll, c.pvhl, c.spll, c.sphl,
+                                             c.coll, c.cohl, c.dtmin, c.db_on, c.man_on};
+        std::string tmp = std::string(path) + ".tmp";
+        std::FILE* f = std::fopen(tmp.c_str(), "wb");
+        if (f == nullptr) {
+            return -1;
+        }
+        static const char zero[PID_CONFIG_ALIGN] = {};
+        bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+        uint64_t pos = sizeof(h);
+        for (int k = 0; ok && k < PID_CFG_COLUMNS; k++) {
+            ok = std::fwrite(zero, 1, h.offset[k] - pos, f) == h.offset[k] - pos;
+            size_t len = nloops * column_width(k);
+            ok = ok && std::fwrite(data[k], 1, len, f) == len;
+            pos = h.offset[k] + len;
+        }
+        ok = ok && std::fwrite(zero, 1, h.bytes - pos, f) == h.bytes - pos;
+        ok = (std::fclose(f) == 0) && ok;
+        if (!ok || std::rename(tmp.c_str(), path) != 0) {
+            std::remove(tmp.c_str());
+            return -1;
+        }
+        return 0;
+    };
@@ -0,0 +1,104 @@
+/**
+ * @file pid_config.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the binary loop configuration file
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ * The file is a pid_config_header followed by one column per configuration value of
+ * pid_bank, in the order of pid_config_column, each starting on a PID_CONFIG_ALIGN
+ * boundary. The columns hold the values as the bank stores them, ki per usec and kd
+ * multiplied by 1.0e+6, in the byte order of the writer, so loading is a mapping, a
+ * validation pass and one copy per column.
+ */
+#ifndef _PID_CONFIG_H
+#define _PID_CONFIG_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define PID_CONFIG_MAGIC 0x43444950u    // "PIDC"
+#define PID_CONFIG_VERSION 1
+#define PID_CONFIG_ENDIAN 0x01020304u   // Reads back differently on a machine of the other byte order
+#define PID_CONFIG_ALIGN 64             // Alignment of the columns
+
+/// @brief Columns of the file
+enum pid_config_column {
+    PID_CFG_KP,
+    PID_CFG_KI,
+    PID_CFG_KD,
+    PID_CFG_DB,
+    PID_CFG_PVLL,
+    PID_CFG_PVHL,
+    PID_CFG_SPLL,
+    PID_CFG_SPHL,
+    PID_CFG_COLL,
+    PID_CFG_COHL,
+    PID_CFG_DTMIN,
+    PID_CFG_DB_ON,
+    PID_CFG_MAN_ON,
+    PID_CFG_COLUMNS
+};
+
+/// @brief Header at the start of the file
+struct pid_config_header {
+    uint32_t magic;                     // PID_CONFIG_MAGIC
+    uint32_t version;                   // PID_CONFIG_VERSION
+    uint32_t endian;                    // PID_CONFIG_ENDIAN
+    uint32_t ncolumns;                  // PID_CFG_COLUMNS
+    uint64_t nloops;                    // Number of loops
+    uint64_t bytes;                     // Size of the file
+    uint64_t offset[PID_CFG_COLUMNS];   // Byte offset of every column
+};
+
+/// @brief Column pointers of a configuration, loop i is element i of every column
+struct pid_config_columns {
+    const float* kp;
+    const float* ki;
+    const float* kd;
+    const float* db;
+    const float* pvll;
+    const float* pvhl;
+    const float* spll;
+    const float* sphl;
+    const float* coll;
+    const float* cohl;
+    const uint64_t* dtmin;
+    const uint8_t* db_on;
+    const uint8_t* man_on;
+};
+
+/// @brief A configuration file mapped read-only
+class pid_config {
+
+    void* base;                 // Mapping
+    size_t bytes;               // Size of the mapping
+    const pid_config_header* hdr;
+
+    public:
+        pid_config();
+        ~pid_config();
+
+        pid_config(const pid_config&) = delete;
+        pid_config& operator=(const pid_config&) = delete;
+
+        /// @brief Map and validate a file
+        int open(const char* path);
+
+        /// @brief Unmap the file
+        void close();
+
+        /// @brief Number of loops, 0 if nothing is mapped
+        size_t size() const { return (hdr == nullptr) ? 0 : hdr->nloops; }
+
+        /// @brief The columns of the mapped file
+        pid_config_columns columns() const;
+};
+
+/// @brief Write a configuration file
+int pid_config_write(const char* path, size_t nloops, const pid_config_columns& c);
+
+#endif /* _PID_CONFIG_H */
@@ -0,0 +1,121 @@
+#include "pid_bank.hpp"
+#include "pid_config.hpp"
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+std::string temp_path(const char* name) {
+
+  return std::string("/tmp/") + name + "_" + std::to_string(getpid());
+}
+
+// Patch one value of a file written by save_config
+template <typename T>
+void patch(const std::string& path, int column, size_t i, T v) {
+
+  std::FILE* f = std::fopen(path.c_str(), "r+b");
+  ASSERT_NE(f, nullptr);
+  pid_config_header h;
+  ASSERT_EQ(std::fread(&h, sizeof(h), 1, f), 1u);
+  std::fseek(f, (long)(h.offset[column] + i * sizeof(T)), SEEK_SET);
+  std::fwrite(&v, sizeof(T), 1, f);
+  std::fclose(f);
+}
+
+// A saved bank loads into a new one, which steps bit-identically
+TEST(pid_config, RoundTrip) {
+
+  const size_t n = 1000;
+  std::string path = temp_path("pid_config");
+  std::mt19937 gen(15);
+  std::uniform_real_distribution<float> val(-10, 10);
+  pid_bank src(n), dst(n);
+  for (size_t i = 0; i < n; i++) {
+    src.set_loop(i, val(gen), val(gen), (i % 3 == 0) ? 0.001f : 0.0f, 0.2f,
+                 -50.0f, 50.0f, -20.0f, 20.0f, -5.0f - (float)(i % 7), 5.0f,
+                 i % 5 == 0, i % 11 == 0, 1 + i % 4);
+  }
+  ASSERT_EQ(src.save_config(path.c_str()), 0);
+
+  pid_config cfg;
+  ASSERT_EQ(cfg.open(path.c_str()), 0);
+  EXPECT_EQ(cfg.size(), n);
+  ASSERT_EQ(dst.load_config(cfg), 0);
+  pid_bank small(n - 1);
+  EXPECT_EQ(small.load_config(cfg), -1);
+
+  for (size_t i = 0; i < n; i++) {
+    pid_params<float> a{}, b{};
+    src.get_params(i, a);
+    dst.get_params(i, b);
+    ASSERT_EQ(std::memcmp(&a, &b, sizeof(a)), 0) << "loop " << i;
+  }
+  for (uint64_t t = 1; t <= 20; t++) {
+    for (size_t i = 0; i < n; i++) {
+      src.pv_data()[i] = dst.pv_data()[i] = val(gen);
+      src.sp_data()[i] = dst.sp_data()[i] = val(gen);
+    }
+    src.step_all(t * 2);
+    dst.step_all(t * 2);
+    ASSERT_EQ(std::memcmp(src.co_data(), dst.co_data(), n * sizeof(float)), 0) << "step " << t;
+  }
+  cfg.close();
+  std::remove(path.c_str());
+}
+
+// Files of another version or with an invalid loop are rejected as a whole
+TEST(pid_config, Validation) {
+
+  std::string path = temp_path("pid_config_bad");
+  pid_bank bank(40);
+  pid_config cfg;
+
+  EXPECT_EQ(cfg.open(path.c_str()), -1);
+  ASSERT_EQ(bank.save_config(path.c_str()), 0);
+  ASSERT_EQ(cfg.open(path.c_str()), 0);
+  cfg.close();
+
+  patch<float>(path, PID_CFG_COLL, 17, 1.0f);
+  patch<float>(path, PID_CFG_COHL, 17, 0.0f);
+  EXPECT_EQ(cfg.open(path.c_str()), -1);
+  EXPECT_EQ(cfg.size(), 0u);
+
+  ASSERT_EQ(bank.save_config(path.c_str()), 0);
+  patch<uint64_t>(path, PID_CFG_DTMIN, 39, 0);
+  EXPECT_EQ(cfg.open(path.c_str()), -1);
+
+  ASSERT_EQ(bank.save_config(path.c_str()), 0);
+  patch<uint8_t>(path, PID_CFG_MAN_ON, 0, 2);
+  EXPECT_EQ(cfg.open(path.c_str()), -1);
+
+  ASSERT_EQ(bank.save_config(path.c_str()), 0);
+  patch<float>(path, PID_CFG_KP, 3, __builtin_nanf(""));
+  EXPECT_EQ(cfg.open(path.c_str()), -1);
+
+  ASSERT_EQ(bank.save_config(path.c_str()), 0);
+  std::FILE* f = std::fopen(path.c_str(), "r+b");
+  ASSERT_NE(f, nullptr);
+  uint32_t version = PID_CONFIG_VERSION + 1;
+  std::fseek(f, (long)offsetof(pid_config_header, version), SEEK_SET);
+  std::fwrite(&version, sizeof(version), 1, f);
+  std::fclose(f);
+  EXPECT_EQ(cfg.open(path.c_str()), -1);
+
+  ASSERT_EQ(bank.save_config(path.c_str()), 0);
+  ASSERT_EQ(truncate(path.c_str(), 100), 0);
+  EXPECT_EQ(cfg.open(path.c_str()), -1);
+
+  // An invalid bank is not written
+  bank.set_loop(5, 1, 1, 0, 0, 3.0f, 2.0f);
+  EXPECT_EQ(bank.save_config(path.c_str()), -1);
+  std::remove(path.c_str());
+}
+}  // namespace
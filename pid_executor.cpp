@@ -0,0 +1,224 @@
+/**
+ * @file pid_executor.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Multi-threaded PID bank executor
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#define PID_EXECUTOR_SPIN 20000 // Polls of the generation before a worker goes to sleep
+
+#include "pid_executor.hpp"
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+
+    static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#endif
+    };
+
+    /// @brief Pin a thread to one CPU
+    /// @return 0  - O'k
+    ///         -1 - Error
+    static int pin_thread(std::thread& t, int cpu) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return (pthread_setaffinity_np(t.native_handle(), sizeof(set), &set) == 0) ? 0 : -1;
+#else
+        (void)t;
+        (void)cpu;
+        return -1;
+#endif
+    };
+
+    void pid_cycle_gate::open() {
+        gen.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&gen), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#endif
+    };
+
+        /// @param seen - The generation the caller has handled
+        /// @return The new generation, the acquire load orders the caller after open()
+    uint32_t pid_cycle_gate::wait(uint32_t seen) {
+        uint32_t g;
+        while ((g = gen.load(std::memory_order_acquire)) == seen) {
+            for (int k = 0; k < PID_EXECUTOR_SPIN; k++) {
+                if (gen.load(std::memory_order_acquire) != seen) {
+                    break;
+                }
+                cpu_relax();
+            }
+            if (gen.load(std::memory_order_acquire) != seen) {
+                continue;
+            }
+#if defined(__linux__)
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&gen), FUTEX_WAIT_PRIVATE, seen, nullptr, nullptr, 0);
+#else
+            std::this_thread::yield();
+#endif
+        }
+        return g;
+    };
+
+    /// @brief The Constructor cuts the bank into shards and starts the worker threads
+    /// @param pbank       The bank to step, it must outlive the executor
+    /// @param nthreads    Number of workers, the calling thread included, 0 is taken as 1
+    /// @param shard_loops Loops per shard, rounded up to a multiple of PID_CACHE_LINE
+    /// @param cpus        CPU of every worker thread 1.., by default worker w runs on
+    ///                    CPU w modulo the number of CPUs
+    pid_executor::pid_executor(pid_bank& pbank, size_t nthreads, size_t shard_loops,
+                               const std::vector<int>& cpus) :
+        bank(pbank),
+        nworkers{std::max<size_t>(nthreads, 1)},
+        shard{(std::max<size_t>(shard_loops, 1) + PID_CACHE_LINE - 1) / PID_CACHE_LINE * PID_CACHE_LINE},
+        nshards{(pbank.size() + shard - 1) / shard},
+        pin_ok{true},
+        budget{0},
+        queues{new shard_queue[nworkers]},
+        gate(),
+        stop{false},
+        tstamp{0},
+        shards_left{0},
+        workers_left{0},
+        t_done{0},
+        st{}
+        {
+        // Contiguous runs of shards, the first nshards % nworkers workers own one more
+        size_t first = 0;
+        for (size_t w = 0; w < nworkers; w++) {
+            size_t count = nshards / nworkers + ((w < nshards % nworkers) ? 1 : 0);
+            queues[w].next.store(first, std::memory_order_relaxed);
+            queues[w].first = first;
+            queues[w].last = first + count;
+            queues[w].steals = 0;
+            first += count;
+        }
+
+        unsigned ncpu = std::max(std::thread::hardware_concurrency(), 1u);
+        threads.reserve(nworkers - 1);
+        for (size_t w = 1; w < nworkers; w++) {
+            threads.emplace_back(&pid_executor::worker, this, w);
+            int cpu = (w - 1 < cpus.size()) ? cpus[w - 1] : (int)(w % ncpu);
+            if (pin_thread(threads.back(), cpu) != 0) {
+                pin_ok = false;
+            }
+        }
+    };
+
+    pid_executor::~pid_executor() {
+        stop.store(true, std::memory_order_relaxed);
+        gate.open();
+        for (std::thread& t : threads) {
+            t.join();
+        }
+    };
+
+    /// @brief Thread body of workers 1.., runs one work() per cycle generation
+    void pid_executor::worker(size_t w) {
+        uint32_t seen = 0;
+        for (;;) {
+            seen = gate.wait(seen);
+            if (stop.load(std::memory_order_relaxed)) {
+                return;
+            }
+            work(w);
+        }
+    };
+
+    /// @brief Run the own shards of worker w, then steal from the others
+    void pid_executor::work(size_t w) {
+        size_t done = 0;
+        uint64_t stolen = 0;
+        for (size_t k = 0; k < nworkers; k++) {
+            shard_queue& q = queues[(w + k) % nworkers];
+            for (;;) {
+                size_t s = q.next.fetch_add(1, std::memory_order_relaxed);
+                if (s >= q.last) {
+                    break;
+                }
+                size_t first = s * shard;
+                bank.step_range(tstamp, first, std::min(first + shard, bank.size()));
+                done++;
+                stolen += (k != 0) ? 1 : 0;
+            }
+        }
+        queues[w].steals += stolen;
+        if (done != 0 && shards_left.fetch_sub(done, std::memory_order_acq_rel) == done) {
+            t_done.store(now_ns(), std::memory_order_relaxed);
+        }
+        workers_left.fetch_sub(1, std::memory_order_release);
+    };
+
+        /// @param tstampv - Time, when the calculation is performed
+        /// @return 0  - O'k
+        ///         -1 - Error, the bank has telemetry attached and there are several
+        ///              workers, the ring has a single producer; nothing is stepped
+    int pid_executor::run_cycle(uint64_t tstampv) {
+        if (nworkers > 1 && bank.telemetry() != nullptr) {
+            return -1;
+        }
+        int64_t t0 = now_ns();
+        for (size_t w = 0; w < nworkers; w++) {
+            queues[w].next.store(queues[w].first, std::memory_order_relaxed);
+        }
+        tstamp = tstampv;
+        shards_left.store(nshards, std::memory_order_relaxed);
+        workers_left.store(nworkers, std::memory_order_relaxed);
+        t_done.store(t0, std::memory_order_relaxed);
+        if (nworkers > 1) {
+            gate.open();
+        }
+
+        work(0);
+
+        // Every worker checks in, so none of them still claims shards of this cycle
+        while (workers_left.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+
+        uint64_t dt = (uint64_t)(t_done.load(std::memory_order_relaxed) - t0);
+        st.cycles++;
+        st.last_ns = dt;
+        st.max_ns = std::max(st.max_ns, dt);
+        if (budget != 0 && dt > budget) {
+            st.overruns++;
+        }
+        return 0;
+    };
+
+        /// @return The statistics, steals are summed over the workers
+    pid_executor_stats pid_executor::stats() const {
+        pid_executor_stats s = st;
+        s.steals = 0;
+        for (size_t w = 0; w < nworkers; w++) {
+            s.steals += queues[w].steals;
+        }
+        return s;
+    };
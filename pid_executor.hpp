@@ -0,0 +1,124 @@
+/**
+ * @file pid_executor.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the multi-threaded PID bank executor
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ */
+#ifndef _PID_EXECUTOR_H
+#define _PID_EXECUTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "pid_alloc.hpp"
+#include "pid_bank.hpp"
+
+#define PID_SHARD_LOOPS 256 // Default number of loops per shard
+
+/// @brief Cycle hand-off from one thread to a pool of workers. A worker spins on the
+///        generation briefly and then sleeps until open() bumps it.
+class pid_cycle_gate {
+
+    alignas(PID_CACHE_LINE) std::atomic<uint32_t> gen; // Cycle generation
+
+    public:
+        pid_cycle_gate() : gen{0} {}
+
+        /// @brief Start the next generation and wake the sleeping workers
+        void open();
+
+        /// @brief Return the generation once it differs from seen
+        uint32_t wait(uint32_t seen);
+};
+
+/// @brief Executor statistics, read between cycles
+struct pid_executor_stats {
+    uint64_t cycles;    // Cycles run
+    uint64_t last_ns;   // Completion time of the last cycle
+    uint64_t max_ns;    // The longest completion time
+    uint64_t overruns;  // Cycles that took longer than the budget
+    uint64_t steals;    // Shards run by a worker other than their owner
+};
+
+/// @brief Steps a pid_bank on several threads. The loops are cut into shards whose
+///        size is a multiple of PID_CACHE_LINE loops, so no two shards share a cache
+///        line in any bank column. Every worker owns a contiguous run of shards and
+///        takes them in order; a worker that finishes its own run steals the shards
+///        the other workers have not started yet, so a core that overruns its share
+///        of the cycle is helped by the idle ones.
+///        Worker 0 is the thread calling run_cycle(), workers 1.. are pinned threads.
+///        The telemetry ring of a bank has a single producer, so a bank with a ring
+///        attached is only stepped by an executor of one worker.
+class pid_executor {
+
+    // Shards owned by one worker, claimed by fetch_add from the owner and the thieves
+    struct alignas(PID_CACHE_LINE) shard_queue {
+        std::atomic<size_t> next;   // The next shard to claim
+        size_t first;               // The first shard of the worker
+        size_t last;                // One past the last shard of the worker
+        uint64_t steals;            // Shards this worker took from the others
+    };
+
+    pid_bank& bank;
+    size_t nworkers;    // Number of workers, the caller included
+    size_t shard;       // Loops per shard
+    size_t nshards;     // Number of shards
+    bool pin_ok;        // All workers were pinned
+    uint64_t budget;    // Cycle budget, ns, 0 - no budget
+
+    std::unique_ptr<shard_queue[]> queues;
+    std::vector<std::thread> threads;
+
+    pid_cycle_gate gate;                        // Cycle hand-off
+    std::atomic<bool> stop;                     // Shut down
+    uint64_t tstamp;                            // Timestamp of the current cycle
+    alignas(PID_CACHE_LINE) std::atomic<size_t> shards_left;   // Shards not finished yet
+    alignas(PID_CACHE_LINE) std::atomic<size_t> workers_left;  // Workers not checked in yet
+    std::atomic<int64_t> t_done;                // Time the last shard finished, ns
+
+    pid_executor_stats st;
+
+    void worker(size_t w);
+    void work(size_t w);
+
+    public:
+        /// @brief Constructor, starts nthreads - 1 threads
+        pid_executor(pid_bank& pbank, size_t nthreads, size_t shard_loops = PID_SHARD_LOOPS,
+                     const std::vector<int>& cpus = std::vector<int>());
+
+        /// @brief Destructor, joins the threads
+        ~pid_executor();
+
+        pid_executor(const pid_executor&) = delete;
+        pid_executor& operator=(const pid_executor&) = delete;
+
+        /// @brief Step every loop of the bank once, returns when all loops are done,
+        ///        -1 if the bank has telemetry attached and there are several workers
+        int run_cycle(uint64_t tstamp);
+
+        /// @brief Set the cycle budget used to count overruns, ns, 0 - no budget
+        void set_budget(uint64_t budget_ns) { budget = budget_ns; }
+
+        /// @brief Statistics of the cycles run so far
+        pid_executor_stats stats() const;
+
+        /// @brief Number of shards and loops per shard
+        size_t shards() const { return nshards; }
+        size_t shard_size() const { return shard; }
+
+        /// @brief Number of workers, the caller included
+        size_t workers() const { return nworkers; }
+
+        /// @brief True if every worker thread was pinned to its core
+        bool pinned() const { return pin_ok; }
+};
+
+#endif /* _PID_EXECUTOR_H */
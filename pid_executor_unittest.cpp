@@ -0,0 +1,83 @@
+#include "pid_executor.hpp"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <random>
+
+namespace {
+void setup(pid_bank& bank, unsigned seed) {
+
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> val(-10, 10);
+  for (size_t i = 0; i < bank.size(); i++) {
+    bank.set_loop(i, 0.7f, 35.0f, 0.002f, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                  -5, 5, false, false, 1 + i % 3);
+    bank.sp_data()[i] = val(gen);
+  }
+}
+
+// Shards are whole cache lines and cover the bank
+TEST(pid_executor, Sharding) {
+
+  pid_bank bank(1000);
+  pid_executor ex(bank, 3, 100);
+
+  EXPECT_EQ(ex.workers(), 3u);
+  EXPECT_EQ(ex.shard_size(), 128u);
+  EXPECT_EQ(ex.shards(), 8u);
+
+  pid_executor one(bank, 0);
+  EXPECT_EQ(one.workers(), 1u);
+  EXPECT_EQ(one.shard_size(), (size_t)PID_SHARD_LOOPS);
+}
+
+// Any number of workers steps the bank exactly as step_all does
+TEST(pid_executor, MatchesStepAll) {
+
+  const size_t n = 3000;
+  pid_bank ref(n), bank(n);
+  setup(ref, 3);
+  setup(bank, 3);
+  pid_executor ex(bank, 4, 64);
+  ex.set_budget(1);
+
+  std::mt19937 gen(5);
+  std::uniform_real_distribution<float> val(-10, 10);
+  for (uint64_t t = 1; t < 200; t++) {
+    for (size_t i = 0; i < n; i++) {
+      ref.pv_data()[i] = bank.pv_data()[i] = val(gen);
+    }
+    ref.step_all(t * 7);
+    EXPECT_EQ(ex.run_cycle(t * 7), 0);
+    ASSERT_EQ(std::memcmp(ref.co_data(), bank.co_data(), n * sizeof(float)), 0) << "cycle " << t;
+  }
+
+  pid_executor_stats st = ex.stats();
+  EXPECT_EQ(st.cycles, 199u);
+  EXPECT_GE(st.max_ns, st.last_ns);
+  EXPECT_EQ(st.overruns, 199u);
+}
+
+// The telemetry ring has a single producer, only a single worker steps a traced bank
+TEST(pid_executor, Telemetry) {
+
+  pid_bank bank(300);
+  setup(bank, 7);
+  pid_telemetry<float> tlm(64);
+  bank.set_telemetry(&tlm);
+  bank.trace_loop(5, true);
+
+  pid_executor ex(bank, 2, 64);
+  EXPECT_EQ(ex.run_cycle(100), -1);
+  EXPECT_EQ(bank.co_data()[5], 0);
+
+  pid_executor one(bank, 1);
+  EXPECT_EQ(one.run_cycle(100), 0);
+  pid_sample<float> smp;
+  EXPECT_TRUE(tlm.pop(smp));
+  EXPECT_EQ(smp.loop, 5u);
+
+  bank.set_telemetry(nullptr);
+  EXPECT_EQ(ex.run_cycle(200), 0);
+}
+}  // namespace
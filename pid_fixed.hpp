@@ -0,0 +1,87 @@
+/**
+ * @file pid_fixed.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Saturating Q-format fixed-point type for the PID controller
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ */
+#ifndef _PID_FIXED_H
+#define _PID_FIXED_H
+
+#include <cstdint>
+#include <limits>
+
+/// @brief Signed Q-format number, Frac fractional bits stored in Raw.
+///        Every operation saturates to the Raw range instead of wrapping,
+///        products are rounded to nearest. The layout is exactly one Raw,
+///        so arrays of int16_t/int32_t samples can be used as q15/q31 IO.
+template <typename Raw, int Frac>
+class q_fixed {
+
+    static_assert(std::numeric_limits<Raw>::is_signed && std::numeric_limits<Raw>::is_integer,
+                  "q_fixed needs a signed integer storage type");
+    static_assert(sizeof(Raw) <= 4 && Frac > 0 && Frac < (int)(8 * sizeof(Raw)),
+                  "q_fixed supports up to 32-bit storage");
+
+    public:
+        typedef Raw raw_type;
+        static const int frac_bits = Frac;
+
+        Raw v;  // Raw value, real value is v / 2^Frac
+
+        /// @brief Zero
+        constexpr q_fixed() : v{0} {}
+
+        /// @brief Saturating conversion from a real value, rounded to nearest
+        explicit q_fixed(double x) : v{sat(x * (double)((int64_t)1 << Frac) + (x < 0 ? -0.5 : 0.5))} {}
+
+        /// @brief Build from a raw value
+        static constexpr q_fixed from_raw(Raw r) { q_fixed q; q.v = r; return q; }
+
+        /// @brief Saturate a wide intermediate to the Raw range
+        static Raw sat(int64_t x) {
+            return (x > std::numeric_limits<Raw>::max()) ? std::numeric_limits<Raw>::max() :
+                   (x < std::numeric_limits<Raw>::min()) ? std::numeric_limits<Raw>::min() : (Raw)x;
+        }
+
+        /// @brief Saturate a real intermediate to the Raw range
+        static Raw sat(double x) {
+            return (x != x) ? 0 :
+                   (x >= (double)std::numeric_limits<Raw>::max()) ? std::numeric_limits<Raw>::max() :
+                   (x <= (double)std::numeric_limits<Raw>::min()) ? std::numeric_limits<Raw>::min() : (Raw)x;
+        }
+
+        /// @brief The largest and the smallest representable values
+        static constexpr q_fixed max() { return from_raw(std::numeric_limits<Raw>::max()); }
+        static constexpr q_fixed lowest() { return from_raw(std::numeric_limits<Raw>::min()); }
+
+        /// @brief Real value
+        double to_double() const { return (double)v / (double)((int64_t)1 << Frac); }
+        explicit operator float() const { return (float)to_double(); }
+        explicit operator double() const { return to_double(); }
+
+        q_fixed operator+(q_fixed b) const { return from_raw(sat((int64_t)v + b.v)); }
+        q_fixed operator-(q_fixed b) const { return from_raw(sat((int64_t)v - b.v)); }
+        q_fixed operator-() const { return from_raw(sat(-(int64_t)v)); }
+        q_fixed operator*(q_fixed b) const {
+            return from_raw(sat(((int64_t)v * b.v + ((int64_t)1 << (Frac - 1))) >> Frac));
+        }
+        q_fixed& operator+=(q_fixed b) { return *this = *this + b; }
+        q_fixed& operator-=(q_fixed b) { return *this = *this - b; }
+        q_fixed& operator*=(q_fixed b) { return *this = *this * b; }
+
+        bool operator==(q_fixed b) const { return v == b.v; }
+        bool operator!=(q_fixed b) const { return v != b.v; }
+        bool operator<(q_fixed b) const { return v < b.v; }
+        bool operator>(q_fixed b) const { return v > b.v; }
+        bool operator<=(q_fixed b) const { return v <= b.v; }
+        bool operator>=(q_fixed b) const { return v >= b.v; }
+};
+
+typedef q_fixed<int16_t, 15> q15;   // Q1.15, range [-1, 1)
+typedef q_fixed<int32_t, 31> q31;   // Q1.31, range [-1, 1)
+
+#endif /* _PID_FIXED_H */
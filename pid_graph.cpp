@@ -0,0 +1,335 @@
+/**
+ * @file pid_graph.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Control-strategy graph
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ */
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#define PID_GRAPH_SPIN 2000 // Polls of the finished blocks before a waiting worker yields
+
+#include "pid_graph.hpp"
+
+    static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#endif
+    };
+
+    /// @brief The Constructor creates nsignals signals and no blocks
+    /// @param nsignals Number of signals, fixed for the life of the graph
+    pid_graph::pid_graph(size_t nsignals) :
+        sig(nsignals, 0.0f),
+        writer(nsignals, PID_GRAPH_NONE),
+        compiled{false}
+        {};
+
+    /// @brief Check the signals of a new block and append it
+    /// @return Block number, PID_GRAPH_NONE if a signal is out of range or out is written already
+    uint32_t pid_graph::add_block(pid_block kind, const uint32_t* in, size_t count, uint32_t out, uint32_t obj) {
+        if (out >= sig.size() || writer[out] != PID_GRAPH_NONE) {
+            return PID_GRAPH_NONE;
+        }
+        for (size_t k = 0; k < count; k++) {
+            if (in[k] >= sig.size()) {
+                return PID_GRAPH_NONE;
+            }
+        }
+        uint32_t b = (uint32_t)blocks.size();
+        blocks.push_back(block{kind, (uint32_t)links.size(), (uint32_t)count, out, obj});
+        links.insert(links.end(), in, in + count);
+        writer[out] = b;
+        compiled = false;
+        return b;
+    };
+
+        /// @brief The PID is created in its default configuration, Manual mode included.
+        ///        Tieback is not an input of the block, the PID reads its latched copy
+        /// @param pv PV signal
+        /// @param sp SP signal
+        /// @param co CO signal, written by this block only
+        /// @param tb Tieback signal or PID_GRAPH_NONE
+        /// @return Block number, PID_GRAPH_NONE - Error
+    uint32_t pid_graph::add_pid(uint32_t pv, uint32_t sp, uint32_t co, uint32_t tb) {
+        if (tb != PID_GRAPH_NONE && tb >= sig.size()) {
+            return PID_GRAPH_NONE;
+        }
+        uint32_t in[2] = {pv, sp};
+        uint32_t b = add_block(pid_block::PID, in, 2, co, (uint32_t)pids.size());
+        if (b == PID_GRAPH_NONE) {
+            return b;
+        }
+        float* ptb = nullptr;
+        if (tb != PID_GRAPH_NONE) {
+            tbl.push_back(sig[tb]);
+            tb_src.push_back(tb);
+            ptb = &tbl.back();
+        }
+        pids.emplace_back(&sig[pv], &sig[sp], &sig[co], ptb);
+        return b;
+    };
+
+        /// @brief y += (x - y) * dt / (tau + dt), the first step sets y = x
+        /// @param in     Input signal
+        /// @param out    Output signal, written by this block only
+        /// @param tau_us Time constant, usec, not negative
+        /// @return Block number, PID_GRAPH_NONE - Error
+    uint32_t pid_graph::add_lag(uint32_t in, uint32_t out, float tau_us) {
+        if (!(tau_us >= 0)) {
+            return PID_GRAPH_NONE;
+        }
+        uint32_t b = add_block(pid_block::LAG, &in, 1, out, (uint32_t)lags.size());
+        if (b != PID_GRAPH_NONE) {
+            lags.push_back(lag_state{tau_us, 0, false});
+        }
+        return b;
+    };
+
+        /// @param kind  SEL_LOW, SEL_HIGH or AVERAGE
+        /// @param in    Input signals
+        /// @param count Number of inputs, at least 1
+        /// @param out   Output signal, written by this block only
+        /// @return Block number, PID_GRAPH_NONE - Error
+    uint32_t pid_graph::add_select(pid_block kind, const uint32_t* in, size_t count, uint32_t out) {
+        if (count == 0 || (kind != pid_block::SEL_LOW && kind != pid_block::SEL_HIGH && kind != pid_block::AVERAGE)) {
+            return PID_GRAPH_NONE;
+        }
+        return add_block(kind, in, count, out, 0);
+    };
+
+    base_pid* pid_graph::pid(uint32_t b) {
+        if (b >= blocks.size() || blocks[b].kind != pid_block::PID) {
+            return nullptr;
+        }
+        return &pids[blocks[b].obj];
+    };
+
+        /// @brief Kahn's sort by level, blocks of one level keep the order they were added in
+        /// @return 0  - O'k
+        ///         -1 - Error, the blocks form a loop
+    int pid_graph::compile() {
+        size_t nb = blocks.size();
+        std::vector<uint32_t> pending(nb, 0);   // Inputs written by blocks not placed yet
+        std::vector<std::vector<uint32_t>> readers(nb);
+        for (uint32_t b = 0; b < nb; b++) {
+            const block& bk = blocks[b];
+            for (uint32_t k = 0; k < bk.count; k++) {
+                uint32_t w = writer[links[bk.first + k]];
+                if (w != PID_GRAPH_NONE) {
+                    readers[w].push_back(b);
+                    pending[b]++;
+                }
+            }
+        }
+
+        order.clear();
+        level_first.clear();
+        std::vector<uint32_t> cur, nxt;
+        for (uint32_t b = 0; b < nb; b++) {
+            if (pending[b] == 0) {
+                cur.push_back(b);
+            }
+        }
+        while (!cur.empty()) {
+            level_first.push_back((uint32_t)order.size());
+            order.insert(order.end(), cur.begin(), cur.end());
+            nxt.clear();
+            for (uint32_t b : cur) {
+                for (uint32_t r : readers[b]) {
+                    if (--pending[r] == 0) {
+                        nxt.push_back(r);
+                    }
+                }
+            }
+            std::sort(nxt.begin(), nxt.end());
+            cur.swap(nxt);
+        }
+        level_first.push_back((uint32_t)order.size());
+
+        compiled = order.size() == nb;
+        if (!compiled) {
+            order.clear();
+            level_first.clear();
+            return -1;
+        }
+        return 0;
+    };
+
+        /// @brief Copy every Tieback signal to the value its PID reads in this cycle
+    void pid_graph::latch() {
+        for (size_t k = 0; k < tb_src.size(); k++) {
+            tbl[k] = sig[tb_src[k]];
+        }
+    };
+
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first schedule position
+        /// @param last   - The schedule position after the last one
+    void pid_graph::run_range(uint64_t tstamp, size_t first, size_t last) {
+        for (size_t k = first; k < last; k++) {
+            const block& bk = blocks[order[k]];
+            const uint32_t* in = &links[bk.first];
+            switch (bk.kind) {
+            case pid_block::PID:
+                pids[bk.obj].run_pid(tstamp);
+                break;
+            case pid_block::LAG: {
+                lag_state& s = lags[bk.obj];
+                float x = sig[in[0]];
+                if (!s.init) {
+                    sig[bk.out] = x;
+                    s.init = true;
+                }
+                else if (tstamp > s.lts) {
+                    float dt = (float)(tstamp - s.lts);
+                    sig[bk.out] += (x - sig[bk.out]) * dt / (s.tau + dt);
+                }
+                s.lts = tstamp;
+                break;
+            }
+            case pid_block::SEL_LOW: {
+                float y = sig[in[0]];
+                for (uint32_t j = 1; j < bk.count; j++) {
+                    y = std::min(y, sig[in[j]]);
+                }
+                sig[bk.out] = y;
+                break;
+            }
+            case pid_block::SEL_HIGH: {
+                float y = sig[in[0]];
+                for (uint32_t j = 1; j < bk.count; j++) {
+                    y = std::max(y, sig[in[j]]);
+                }
+                sig[bk.out] = y;
+                break;
+            }
+            case pid_block::AVERAGE: {
+                float y = 0;
+                for (uint32_t j = 0; j < bk.count; j++) {
+                    y += sig[in[j]];
+                }
+                sig[bk.out] = y / (float)bk.count;
+                break;
+            }
+            }
+        }
+    };
+
+        /// @param tstamp - Time, when the calculation is performed
+        /// @return 0  - O'k
+        ///         -1 - Error, the graph is not compiled
+    int pid_graph::run(uint64_t tstamp) {
+        if (!compiled) {
+            return -1;
+        }
+        latch();
+        run_range(tstamp, 0, order.size());
+        return 0;
+    };
+
+    /// @brief The Constructor starts the worker threads
+    /// @param pgraph   The compiled graph, it must outlive the executor and not change
+    /// @param nthreads Number of workers, the calling thread included, 0 is taken as 1
+    pid_graph_executor::pid_graph_executor(pid_graph& pgraph, size_t nthreads) :
+        graph(pgraph),
+        nworkers{std::max<size_t>(nthreads, 1)},
+        level_of(pgraph.schedule().size()),
+        gate(),
+        stop{false},
+        tstamp{0},
+        next{0},
+        done{0},
+        workers_left{0}
+        {
+        for (size_t l = 0; l < graph.levels(); l++) {
+            std::fill(level_of.begin() + graph.level_begin(l), level_of.begin() + graph.level_begin(l + 1), (uint32_t)l);
+        }
+        threads.reserve(nworkers - 1);
+        for (size_t w = 1; w < nworkers; w++) {
+            threads.emplace_back(&pid_graph_executor::worker, this, w);
+        }
+    };
+
+    pid_graph_executor::~pid_graph_executor() {
+        stop.store(true, std::memory_order_relaxed);
+        gate.open();
+        for (std::thread& t : threads) {
+            t.join();
+        }
+    };
+
+    void pid_graph_executor::worker(size_t) {
+        uint32_t seen = 0;
+        for (;;) {
+            seen = gate.wait(seen);
+            if (stop.load(std::memory_order_relaxed)) {
+                return;
+            }
+            work();
+        }
+    };
+
+    /// @brief Claim chunks of the schedule until it is exhausted. Positions are claimed
+    ///        in order, so a worker only waits for positions claimed before its own and
+    ///        the waits cannot form a loop
+    void pid_graph_executor::work() {
+        size_t total = level_of.size();
+        for (;;) {
+            size_t k = next.fetch_add(PID_GRAPH_CHUNK, std::memory_order_relaxed);
+            if (k >= total) {
+                break;
+            }
+            size_t end = std::min(k + PID_GRAPH_CHUNK, total);
+            while (k < end) {
+                // Run the part of the chunk that belongs to one level
+                uint32_t l = level_of[k];
+                size_t stop_at = std::min(end, graph.level_begin(l + 1));
+                for (int n = 0; done.load(std::memory_order_acquire) < graph.level_begin(l); n++) {
+                    if (n < PID_GRAPH_SPIN) {
+                        cpu_relax();
+                    }
+                    else {
+                        std::this_thread::yield();
+                    }
+                }
+                graph.run_range(tstamp, k, stop_at);
+                done.fetch_add(stop_at - k, std::memory_order_acq_rel);
+                k = stop_at;
+            }
+        }
+        workers_left.fetch_sub(1, std::memory_order_release);
+    };
+
+        /// @param tstampv - Time, when the calculation is performed
+        /// @return 0  - O'k
+        ///         -1 - Error, the graph is not compiled or changed since the executor was built
+    int pid_graph_executor::run_cycle(uint64_t tstampv) {
+        if (!graph.ready() || graph.schedule().size() != level_of.size()) {
+            return -1;
+        }
+        graph.latch();
+        tstamp = tstampv;
+        next.store(0, std::memory_order_relaxed);
+        done.store(0, std::memory_order_relaxed);
+        workers_left.store(nworkers, std::memory_order_relaxed);
+        if (nworkers > 1) {
+            gate.open();
+        }
+
+        work();
+
+        while (workers_left.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+        return 0;
+    };
@@ -0,0 +1,171 @@
+/**
+ * @file pid_graph.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the control-strategy graph
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ * A strategy is a set of signals and the blocks connecting them. Every block reads
+ * its input signals and writes one output signal in place, so a cascade is a primary
+ * PID whose CO signal is the SP signal of the secondary, and the value is handed over
+ * in the same cycle without a copy. Signals no block writes are the strategy inputs.
+ *
+ * compile() orders the blocks by level: a block's level is one more than the highest
+ * level of the blocks writing its inputs. Blocks of one level do not depend on each
+ * other, so pid_graph_executor runs them on several threads.
+ */
+#ifndef _PID_GRAPH_H
+#define _PID_GRAPH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "pid.hpp"
+#include "pid_alloc.hpp"
+#include "pid_executor.hpp"
+
+#define PID_GRAPH_NONE UINT32_MAX   // No signal or no block
+#define PID_GRAPH_CHUNK 16          // Blocks claimed at once by a pid_graph_executor worker
+
+/// @brief Kinds of blocks
+enum class pid_block : uint8_t {
+    PID,        // base_pid, inputs PV, SP and optionally Tieback
+    LAG,        // First-order lag filter
+    SEL_LOW,    // The lowest input
+    SEL_HIGH,   // The highest input
+    AVERAGE     // Mean of the inputs
+};
+
+/// @brief A control strategy over a fixed set of signals
+class pid_graph {
+
+    // One block of the strategy
+    struct block {
+        pid_block kind;
+        uint32_t first;     // The first input in links
+        uint32_t count;     // Number of inputs
+        uint32_t out;       // Output signal
+        uint32_t obj;       // Index into pids or lags
+    };
+
+    // State of a LAG block
+    struct lag_state {
+        float tau;          // Time constant, usec
+        uint64_t lts;       // The last calculation timestamp
+        bool init;          // The output follows the input from the first step on
+    };
+
+    pid_vector<float> sig;              // Signals
+    pid_vector<uint32_t> writer;        // Block writing each signal, PID_GRAPH_NONE for inputs
+    std::vector<block> blocks;
+    std::vector<uint32_t> links;        // Input signals of all blocks
+    std::deque<base_pid> pids;          // Stable addresses, a PID keeps pointers into sig
+    std::deque<float> tbl;              // Tieback values latched at the start of a cycle, read by the PIDs
+    std::vector<uint32_t> tb_src;       // Tieback signal of every tbl entry
+    std::vector<lag_state> lags;
+    std::vector<uint32_t> order;        // Compiled schedule, blocks by level
+    std::vector<uint32_t> level_first;  // Start of every level in order, and the end
+    bool compiled;
+
+    uint32_t add_block(pid_block kind, const uint32_t* in, size_t count, uint32_t out, uint32_t obj);
+
+    public:
+        /// @brief Constructor, nsignals signals, all 0
+        explicit pid_graph(size_t nsignals);
+
+        /// @brief Number of signals
+        size_t signals() const { return sig.size(); }
+
+        /// @brief Signal values, the strategy inputs are written here between cycles
+        float* data() { return sig.data(); }
+        const float* data() const { return sig.data(); }
+
+        /// @brief Add a PID block, configure it through pid(). Tieback is only read in
+        ///        Manual mode and is taken as latched at the start of the cycle, so it adds
+        ///        no dependency: a cascade primary may take its own CO, the secondary SP.
+        uint32_t add_pid(uint32_t pv, uint32_t sp, uint32_t co, uint32_t tb = PID_GRAPH_NONE);
+
+        /// @brief Add a first-order lag filter with time constant tau_us
+        uint32_t add_lag(uint32_t in, uint32_t out, float tau_us);
+
+        /// @brief Add a selector, kind is SEL_LOW, SEL_HIGH or AVERAGE
+        uint32_t add_select(pid_block kind, const uint32_t* in, size_t count, uint32_t out);
+
+        /// @brief The controller of a PID block, nullptr for other blocks
+        base_pid* pid(uint32_t b);
+
+        /// @brief Order the blocks into the schedule
+        int compile();
+
+        /// @brief Run every block once in schedule order
+        int run(uint64_t tstamp);
+
+        /// @brief Latch the Tieback signals for the cycle, run() and pid_graph_executor
+        ///        call it before the first block
+        void latch();
+
+        /// @brief Run blocks order[first, last) of the schedule
+        void run_range(uint64_t tstamp, size_t first, size_t last);
+
+        /// @brief Number of blocks
+        size_t size() const { return blocks.size(); }
+
+        /// @brief Compiled schedule, block numbers by level
+        const std::vector<uint32_t>& schedule() const { return order; }
+
+        /// @brief Number of levels and the first schedule position of level l, l == levels() gives the end
+        size_t levels() const { return level_first.empty() ? 0 : level_first.size() - 1; }
+        size_t level_begin(size_t l) const { return level_first[l]; }
+
+        /// @brief True after a successful compile() and no block added since
+        bool ready() const { return compiled; }
+};
+
+/// @brief Runs a compiled pid_graph on several threads. The schedule is claimed in
+///        chunks of PID_GRAPH_CHUNK blocks in order; a block starts once every block
+///        of the lower levels is done, so the levels act as barriers and the blocks of
+///        one level run in parallel.
+///        Worker 0 is the thread calling run_cycle().
+class pid_graph_executor {
+
+    pid_graph& graph;
+    size_t nworkers;                // Number of workers, the caller included
+    std::vector<uint32_t> level_of; // Level of every schedule position
+    std::vector<std::thread> threads;
+
+    pid_cycle_gate gate;
+    std::atomic<bool> stop;
+    uint64_t tstamp;
+    alignas(PID_CACHE_LINE) std::atomic<size_t> next;          // The next schedule position to claim
+    alignas(PID_CACHE_LINE) std::atomic<size_t> done;          // Schedule positions done
+    alignas(PID_CACHE_LINE) std::atomic<size_t> workers_left;  // Workers not checked in yet
+
+    void worker(size_t w);
+    void work();
+
+    public:
+        /// @brief Constructor, starts nthreads - 1 threads, the graph must be compiled
+        pid_graph_executor(pid_graph& pgraph, size_t nthreads);
+
+        /// @brief Destructor, joins the threads
+        ~pid_graph_executor();
+
+        pid_graph_executor(const pid_graph_executor&) = delete;
+        pid_graph_executor& operator=(const pid_graph_executor&) = delete;
+
+        /// @brief Run every block once, returns when all blocks are done
+        int run_cycle(uint64_t tstamp);
+
+        /// @brief Number of workers, the caller included
+        size_t workers() const { return nworkers; }
+};
+
+#endif /* _PID_GRAPH_H */
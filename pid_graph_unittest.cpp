@@ -0,0 +1,197 @@
+#include "pid_graph.hpp"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <vector>
+
+namespace {
+void configure(base_pid* p, float kpv, float kiv) {
+
+  float kdv{0}, ll{-100}, hl{100};
+  bool man_sw{false};
+  ASSERT_NE(p, nullptr);
+  p->set_gain_param(kpv, kiv, kdv);
+  p->set_cp_limits(ll, hl);
+  p->set_man_param(man_sw);
+}
+
+// Blocks added out of order run after the blocks writing their inputs
+TEST(pid_graph, Schedule) {
+
+  // 0 pv1, 1 sp1, 2 co1 = sp2, 3 pv2, 4 co2, 5 pv2 filtered
+  pid_graph g(6);
+  uint32_t sec = g.add_pid(5, 2, 4);
+  uint32_t lag = g.add_lag(3, 5, 0);
+  uint32_t pri = g.add_pid(0, 1, 2);
+  ASSERT_NE(sec, PID_GRAPH_NONE);
+  ASSERT_NE(lag, PID_GRAPH_NONE);
+  ASSERT_NE(pri, PID_GRAPH_NONE);
+
+  EXPECT_EQ(g.run(10), -1);
+  ASSERT_EQ(g.compile(), 0);
+  EXPECT_EQ(g.levels(), 2u);
+  ASSERT_EQ(g.schedule().size(), 3u);
+  EXPECT_EQ(g.schedule()[0], lag);
+  EXPECT_EQ(g.schedule()[1], pri);
+  EXPECT_EQ(g.schedule()[2], sec);
+  EXPECT_EQ(g.level_begin(1), 2u);
+
+  // A signal has one writer, signals exist
+  EXPECT_EQ(g.add_lag(0, 4, 1), PID_GRAPH_NONE);
+  EXPECT_EQ(g.add_lag(6, 0, 1), PID_GRAPH_NONE);
+  EXPECT_EQ(g.add_lag(0, 3, -1), PID_GRAPH_NONE);
+  EXPECT_EQ(g.add_select(pid_block::PID, &sec, 1, 3), PID_GRAPH_NONE);
+  EXPECT_EQ(g.pid(lag), nullptr);
+  EXPECT_TRUE(g.ready());
+
+  // Feeding PV2 back from CO2 closes a loop
+  EXPECT_NE(g.add_lag(4, 3, 0), PID_GRAPH_NONE);
+  EXPECT_FALSE(g.ready());
+  EXPECT_EQ(g.compile(), -1);
+  EXPECT_EQ(g.run(10), -1);
+}
+
+// A cascade hands CO of the primary to SP of the secondary in the same cycle
+TEST(pid_graph, Cascade) {
+
+  pid_graph g(5);
+  float* s = g.data();
+  uint32_t sec = g.add_pid(3, 2, 4);
+  uint32_t pri = g.add_pid(0, 1, 2);
+  configure(g.pid(pri), 2, 0);
+  configure(g.pid(sec), 3, 0);
+  ASSERT_EQ(g.compile(), 0);
+
+  // The same controllers wired by hand and called primary first
+  float pv1{0}, sp1{0}, co1{0}, pv2{0}, co2{0};
+  base_pid p1(&pv1, &sp1, &co1), p2(&pv2, &co1, &co2);
+  configure(&p1, 2, 0);
+  configure(&p2, 3, 0);
+
+  for (uint64_t t = 1; t <= 20; t++) {
+    s[0] = pv1 = (float)(t % 3);
+    s[1] = sp1 = 4;
+    s[3] = pv2 = (float)(t % 5) * 0.5f;
+    ASSERT_EQ(g.run(t * 100), 0);
+    p1.run_pid(t * 100);
+    p2.run_pid(t * 100);
+    ASSERT_EQ(s[2], co1);
+    ASSERT_EQ(s[4], co2);
+  }
+  EXPECT_NE(s[4], 0);
+}
+
+// The usual bumpless cascade wiring, the primary tracks its own CO, the secondary SP,
+// in Manual. Tieback is the value latched at the start of the cycle, not a dependency
+TEST(pid_graph, CascadeTieback) {
+
+  pid_graph g(5);
+  float* s = g.data();
+  uint32_t sec = g.add_pid(3, 2, 4);
+  uint32_t pri = g.add_pid(0, 1, 2, 2);
+  ASSERT_NE(pri, PID_GRAPH_NONE);
+  EXPECT_EQ(g.add_pid(0, 1, 2, 5), PID_GRAPH_NONE);
+  configure(g.pid(pri), 2, 10);
+  configure(g.pid(sec), 3, 0);
+  ASSERT_EQ(g.compile(), 0);
+  EXPECT_EQ(g.levels(), 2u);
+
+  // The same controllers wired by hand, Tieback copied from CO1 before every cycle
+  float pv1{0}, sp1{0}, co1{0}, tb1{0}, pv2{0}, co2{0};
+  base_pid p1(&pv1, &sp1, &co1, &tb1), p2(&pv2, &co1, &co2);
+  configure(&p1, 2, 10);
+  configure(&p2, 3, 0);
+
+  bool man_on{true}, man_off{false};
+  g.pid(pri)->set_man_param(man_on);
+  p1.set_man_param(man_on);
+  s[2] = co1 = 7;
+  for (uint64_t t = 1; t <= 20; t++) {
+    if (t == 10) {
+      g.pid(pri)->set_man_param(man_off);
+      p1.set_man_param(man_off);
+    }
+    s[0] = pv1 = 3;
+    s[1] = sp1 = 4;
+    s[3] = pv2 = (float)(t % 5) * 0.5f;
+    tb1 = co1;
+    ASSERT_EQ(g.run(t * 100), 0);
+    p1.run_pid(t * 100);
+    p2.run_pid(t * 100);
+    ASSERT_EQ(s[2], co1) << "step " << t;
+    ASSERT_EQ(s[4], co2) << "step " << t;
+    if (t < 10) {
+      ASSERT_EQ(s[2], 7);
+    }
+  }
+  // No bump when the primary goes to Auto, Iterm starts from the held CO
+  EXPECT_NEAR(s[2], 7 + 2 + 11 * 10 * 100 * 1.0e-6f, 1.0e-4f);
+
+  pid_graph_executor ex(g, 2);
+  EXPECT_EQ(ex.run_cycle(3000), 0);
+}
+
+// Lag and selectors
+TEST(pid_graph, Blocks) {
+
+  pid_graph g(7);
+  float* s = g.data();
+  uint32_t in[3] = {0, 1, 2};
+  g.add_select(pid_block::SEL_LOW, in, 3, 3);
+  g.add_select(pid_block::SEL_HIGH, in, 3, 4);
+  g.add_select(pid_block::AVERAGE, in, 3, 5);
+  g.add_lag(0, 6, 100);
+  ASSERT_EQ(g.compile(), 0);
+  EXPECT_EQ(g.levels(), 1u);
+
+  s[0] = 3;
+  s[1] = -1;
+  s[2] = 1;
+  g.run(1000);
+  EXPECT_EQ(s[3], -1);
+  EXPECT_EQ(s[4], 3);
+  EXPECT_EQ(s[5], 1);
+  EXPECT_EQ(s[6], 3);
+  s[0] = 5;
+  g.run(1100);
+  EXPECT_FLOAT_EQ(s[6], 4);
+  g.run(1100);
+  EXPECT_FLOAT_EQ(s[6], 4);
+}
+
+// Many independent cascades give the same outputs on one and on several threads
+TEST(pid_graph, Executor) {
+
+  const size_t ncas = 300;
+  pid_graph g1(ncas * 5), g4(ncas * 5);
+  for (pid_graph* g : {&g1, &g4}) {
+    for (uint32_t c = 0; c < ncas; c++) {
+      uint32_t b = c * 5;
+      uint32_t pri = g->add_pid(b, b + 1, b + 2);
+      uint32_t sec = g->add_pid(b + 3, b + 2, b + 4);
+      configure(g->pid(pri), 1.0f + 0.01f * (float)c, 5);
+      configure(g->pid(sec), 0.5f, 20);
+    }
+    ASSERT_EQ(g->compile(), 0);
+    EXPECT_EQ(g->levels(), 2u);
+  }
+
+  pid_graph_executor ex(g4, 4);
+  EXPECT_EQ(ex.workers(), 4u);
+  for (uint64_t t = 1; t <= 100; t++) {
+    for (uint32_t c = 0; c < ncas; c++) {
+      for (float* s : {g1.data(), g4.data()}) {
+        s[c * 5] = (float)((c + t) % 7);
+        s[c * 5 + 1] = 3;
+        s[c * 5 + 3] = (float)((c * t) % 5);
+      }
+    }
+    ASSERT_EQ(g1.run(t * 100), 0);
+    ASSERT_EQ(ex.run_cycle(t * 100), 0);
+    ASSERT_EQ(std::memcmp(g1.data(), g4.data(), ncas * 5 * sizeof(float)), 0) << "step " << t;
+  }
+
+  EXPECT_NE(g4.add_lag(0, 3, 1), PID_GRAPH_NONE);
+  EXPECT_EQ(ex.run_cycle(20000), -1);
+}
+}  // namespace
@@ -0,0 +1,589 @@
+/**
+ * @file pid_historian.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Compressed SP/PV/CO historian
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pid_bank.hpp"
+#include "pid_historian.hpp"
+
+static_assert(sizeof(pid_hist_file_header) <= PID_HIST_BLOCK, "the file header must fit in one block");
+static_assert(sizeof(pid_hist_block_header) % 8 == 0, "the stream must start 8 byte aligned");
+
+    static inline uint32_t float_bits(float v) {
+        uint32_t b;
+        std::memcpy(&b, &v, sizeof(b));
+        return b;
+    };
+
+    static inline float bits_float(uint32_t b) {
+        float v;
+        std::memcpy(&v, &b, sizeof(v));
+        return v;
+    };
+
+    /// @brief A value moved by more than dev from its last report, or it turned NaN,
+    ///        left NaN or became another NaN, which no deviation compares to
+    static inline bool hist_moved(float v, float last, float dev) {
+        return std::fabs(v - last) > dev ||
+               ((std::isnan(v) || std::isnan(last)) && float_bits(v) != float_bits(last));
+    };
+
+    /// @brief Append the low nbits of v to the stream, most significant bit first
+    void pid_hist_encoder::put(uint64_t v, int nbits) {
+        uint8_t* s = blk + sizeof(pid_hist_block_header);
+        uint32_t pos = header()->nbits;
+        while (nbits > 0) {
+            int room = 8 - (int)(pos & 7);
+            int take = (nbits < room) ? nbits : room;
+            uint8_t bits = (uint8_t)((v >> (nbits - take)) & ((1u << take) - 1));
+            s[pos >> 3] |= (uint8_t)(bits << (room - take));
+            pos += take;
+            nbits -= take;
+        }
+        header()->nbits = pos;
+    };
+
+    /// @brief '0' for an unchanged value, '10' and the meaningful bits if they fit the
+    ///        last window, else '11', 5 bits of leading zeros, 5 bits of length - 1 and
+    ///        the meaningful bits
+    void pid_hist_encoder::put_value(int k, uint32_t v) {
+        uint32_t x = v ^ lv[k];
+        lv[k] = v;
+        if (x == 0) {
+            put(0, 1);
+            return;
+        }
+        int lz = __builtin_clz(x);
+        int tz = __builtin_ctz(x);
+        if (lead[k] != 0xff && lz >= lead[k] && tz >= trail[k]) {
+            put(2, 2);
+            put(x >> trail[k], 32 - lead[k] - trail[k]);
+            return;
+        }
+        int len = 32 - lz - tz;
+        put(3, 2);
+        put((uint64_t)lz, 5);
+        put((uint64_t)(len - 1), 5);
+        put(x >> tz, len);
+        lead[k] = (uint8_t)lz;
+        trail[k] = (uint8_t)tz;
+    };
+
+        /// @param loop - Loop of the reports to come
+    void pid_hist_encoder::reset(uint32_t loop) {
+        std::memset(blk, 0, sizeof(blk));
+        header()->magic = PID_HIST_BLOCK_MAGIC;
+        header()->loop = loop;
+        lt = 0;
+        ldelta = 0;
+        for (int k = 0; k < 3; k++) {
+            lv[k] = 0;
+            lead[k] = 0xff;
+            trail[k] = 0;
+        }
+    };
+
+        /// @brief The first report is stored raw, the next ones as a delta-of-delta
+        ///        timestamp and three XOR-ed values
+        /// @param r - The report
+    void pid_hist_encoder::append(const pid_hist_record& r) {
+        pid_hist_block_header* h = header();
+        uint32_t v[3] = {float_bits(r.sp), float_bits(r.pv), float_bits(r.co)};
+        if (h->count == 0) {
+            put(r.tstamp, 64);
+            for (int k = 0; k < 3; k++) {
+                put(v[k], 32);
+                lv[k] = v[k];
+            }
+            h->t_first = r.tstamp;
+        }
+        else {
+            int64_t delta = (int64_t)(r.tstamp - lt);
+            int64_t dod = delta - ldelta;
+            ldelta = delta;
+            if (dod == 0) {
+                put(0, 1);
+            }
+            else if (dod >= -63 && dod <= 64) {
+                put(2, 2);
+                put((uint64_t)(dod + 63), 7);
+            }
+            else if (dod >= -255 && dod <= 256) {
+                put(6, 3);
+                put((uint64_t)(dod + 255), 9);
+            }
+            else if (dod >= -2047 && dod <= 2048) {
+                put(14, 4);
+                put((uint64_t)(dod + 2047), 12);
+            }
+            else {
+                put(15, 4);
+                put((uint64_t)dod, 64);
+            }
+            for (int k = 0; k < 3; k++) {
+                put_value(k, v[k]);
+            }
+        }
+        lt = r.tstamp;
+        h->t_last = r.tstamp;
+        h->count++;
+    };
+
+    /// @brief Bit stream reader of a block
+    struct hist_bits {
+        const uint8_t* s;
+        uint32_t pos;
+        uint32_t end;
+
+        bool ok(int nbits) const { return pos + (uint32_t)nbits <= end; }
+
+        uint64_t get(int nbits) {
+            uint64_t v = 0;
+            while (nbits > 0) {
+                int room = 8 - (int)(pos & 7);
+                int take = (nbits < room) ? nbits : room;
+                uint64_t bits = (s[pos >> 3] >> (room - take)) & ((1u << take) - 1);
+                v = (v << take) | bits;
+                pos += take;
+                nbits -= take;
+            }
+            return v;
+        }
+    };
+
+        /// @brief Decode a block written by pid_hist_encoder
+        /// @param block - PID_HIST_BLOCK bytes
+        /// @param out   - Room for PID_HIST_BLOCK_RECORDS reports
+        /// @return Number of reports decoded, 0 for a damaged block
+    size_t pid_hist_decode(const uint8_t* block, pid_hist_record* out) {
+        pid_hist_block_header h;
+        std::memcpy(&h, block, sizeof(h));
+        if (h.magic != PID_HIST_BLOCK_MAGIC || h.nbits > PID_HIST_PAYLOAD * 8 || h.count > PID_HIST_BLOCK_RECORDS) {
+            return 0;
+        }
+        hist_bits b{block + sizeof(pid_hist_block_header), 0, h.nbits};
+        uint64_t t = 0;
+        int64_t delta = 0;
+        uint32_t v[3] = {0, 0, 0};
+        uint8_t lead[3] = {0, 0, 0};
+        uint8_t trail[3] = {0, 0, 0};
+
+        for (uint32_t i = 0; i < h.count; i++) {
+            if (i == 0) {
+                if (!b.ok(160)) {
+                    return 0;
+                }
+                t = b.get(64);
+                for (int k = 0; k < 3; k++) {
+                    v[k] = (uint32_t)b.get(32);
+                }
+            }
+            else {
+                int64_t dod;
+                if (!b.ok(1)) {
+                    return 0;
+                }
+                if (b.get(1) == 0) {
+                    dod = 0;
+                }
+                else if (b.ok(8) && b.get(1) == 0) {
+                    dod = (int64_t)b.get(7) - 63;
+                }
+                else if (b.ok(10) && b.get(1) == 0) {
+                    dod = (int64_t)b.get(9) - 255;
+                }
+                else if (b.ok(13) && b.get(1) == 0) {
+                    dod = (int64_t)b.get(12) - 2047;
+                }
+                else if (b.ok(64)) {
+                    dod = (int64_t)b.get(64);
+                }
+                else {
+                    return 0;
+                }
+                delta += dod;
+                t += (uint64_t)delta;
+                for (int k = 0; k < 3; k++) {
+                    if (!b.ok(1)) {
+                        return 0;
+                    }
+                    if (b.get(1) == 0) {
+                        continue;
+                    }
+                    if (!b.ok(1)) {
+                        return 0;
+                    }
+                    if (b.get(1) == 0) {
+                        int len = 32 - lead[k] - trail[k];
+                        if (len <= 0 || !b.ok(len)) {
+                            return 0;
+                        }
+                        v[k] ^= (uint32_t)(b.get(len) << trail[k]);
+                    }
+                    else {
+                        if (!b.ok(10)) {
+                            return 0;
+                        }
+                        lead[k] = (uint8_t)b.get(5);
+                        int len = (int)b.get(5) + 1;
+                        if (lead[k] + len > 32 || !b.ok(len)) {
+                            return 0;
+                        }
+                        trail[k] = (uint8_t)(32 - lead[k] - len);
+                        v[k] ^= (uint32_t)(b.get(len) << trail[k]);
+                    }
+                }
+            }
+            out[i] = pid_hist_record{t, h.loop, bits_float(v[0]), bits_float(v[1]), bits_float(v[2])};
+        }
+        return h.count;
+    };
+
+    /// @brief The Constructor, every loop reports any change and has no heartbeat
+    /// @param nloops Number of loops
+    /// @param depth  Reports the capture ring holds, rounded up to a power of two
+    pid_historian::pid_historian(size_t nloops, size_t depth) :
+        n{nloops},
+        dev(nloops, 0.0f),
+        beat(nloops, UINT64_MAX),
+        lsp(nloops, 0.0f),
+        lpv(nloops, 0.0f),
+        lco(nloops, 0.0f),
+        lrep(nloops, 0),
+        never(nloops, 1),
+        ring(depth),
+        ndropped{0},
+        enc(nloops),
+        fd{-1},
+        nblocks{0},
+        io_error{false},
+        stop{false},
+        flush_req{0},
+        flush_done{0},
+        nwritten{0}
+        {
+        for (size_t i = 0; i < n; i++) {
+            enc[i].reset((uint32_t)i);
+        }
+        batch.resize(1024);
+        out.reserve(PID_HIST_FLUSH + PID_HIST_BLOCK);
+    };
+
+    pid_historian::~pid_historian() {
+        close();
+    };
+
+        /// @brief Create or truncate the file and start the writer thread
+        /// @param path File of the history
+        /// @return 0  - O'k
+        ///         -1 - Error, the historian is open already or the file cannot be created
+    int pid_historian::open(const char* path) {
+        if (fd >= 0) {
+            return -1;
+        }
+        fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return -1;
+        }
+        uint8_t head[PID_HIST_BLOCK] = {};
+        pid_hist_file_header h{PID_HIST_MAGIC, PID_HIST_VERSION, PID_HIST_BLOCK, 0, 0};
+        std::memcpy(head, &h, sizeof(h));
+        if (pwrite(fd, head, sizeof(head), 0) != (ssize_t)sizeof(head)) {
+            ::close(fd);
+            fd = -1;
+            return -1;
+        }
+        nblocks = 0;
+        io_error.store(false);
+        stop.store(false, std::memory_order_relaxed);
+        writer = std::thread(&pid_historian::run, this);
+        return 0;
+    };
+
+    void pid_historian::close() {
+        if (fd < 0) {
+            return;
+        }
+        stop.store(true, std::memory_order_release);
+        writer.join();
+        ::close(fd);
+        fd = -1;
+    };
+
+        /// @param i       - Loop number
+        /// @param devv    - A report is made when SP, PV or CO moved by more than devv, not negative
+        /// @param beat_us - A report is made at least this often, UINT64_MAX for none
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_historian::set_exception(size_t i, float devv, uint64_t beat_us) {
+        if (i >= n || !(devv >= 0)) {
+            return -1;
+        }
+        dev[i] = devv;
+        beat[i] = beat_us;
+        return 0;
+    };
+
+        /// @brief Compare every loop with its last report and push the ones that moved,
+        ///        a full ring drops the report and counts it
+        /// @param tstamp - Time of the values
+        /// @param sp     - SP of every loop
+        /// @param pv     - PV of every loop
+        /// @param co     - CO of every loop
+        /// @return Number of reports pushed
+    size_t pid_historian::capture(uint64_t tstamp, const float* sp, const float* pv, const float* co) {
+        size_t pushed = 0;
+        uint64_t dropped = 0;
+        for (size_t i = 0; i < n; i++) {
+            bool moved = hist_moved(sp[i], lsp[i], dev[i]) || hist_moved(pv[i], lpv[i], dev[i]) ||
+                         hist_moved(co[i], lco[i], dev[i]);
+            if (!moved && never[i] == 0 && tstamp - lrep[i] < beat[i]) {
+                continue;
+            }
+            if (!ring.try_push(pid_hist_record{tstamp, (uint32_t)i, sp[i], pv[i], co[i]})) {
+                dropped++;
+                continue;
+            }
+            lsp[i] = sp[i];
+            lpv[i] = pv[i];
+            lco[i] = co[i];
+            lrep[i] = tstamp;
+            never[i] = 0;
+            pushed++;
+        }
+        if (dropped != 0) {
+            ndropped.store(ndropped.load(std::memory_order_relaxed) + dropped, std::memory_order_relaxed);
+        }
+        return pushed;
+    };
+
+        /// @param bank   - The bank, it must have as many loops as the historian
+        /// @param tstamp - Time of the step
+        /// @return Number of reports pushed
+    size_t pid_historian::capture(pid_bank& bank, uint64_t tstamp) {
+        if (bank.size() != n) {
+            return 0;
+        }
+        return capture(tstamp, bank.sp_data(), bank.pv_data(), bank.co_data());
+    };
+
+        /// @brief Blocks of partly filled loops are closed early
+        /// @return 0  - O'k
+        ///         -1 - Error, the historian is not open or a write failed
+    int pid_historian::flush() {
+        if (fd < 0) {
+            return -1;
+        }
+        uint64_t req = flush_req.fetch_add(1, std::memory_order_acq_rel) + 1;
+        while (flush_done.load(std::memory_order_acquire) < req) {
+            std::this_thread::sleep_for(std::chrono::microseconds(PID_HIST_IDLE_US / 10));
+        }
+        return io_error.load() ? -1 : 0;
+    };
+
+    /// @brief Writer thread, drain the ring, encode, and write full blocks
+    void pid_historian::run() {
+        for (;;) {
+            bool stopping = stop.load(std::memory_order_acquire);
+            uint64_t req = flush_req.load(std::memory_order_acquire);
+            size_t k;
+            size_t total = 0;
+            while ((k = ring.pop_n(batch.data(), batch.size())) != 0) {
+                for (size_t j = 0; j < k; j++) {
+                    encode(batch[j]);
+                }
+                total += k;
+                nwritten.store(nwritten.load(std::memory_order_relaxed) + k, std::memory_order_relaxed);
+            }
+            if (stopping || req != flush_done.load(std::memory_order_relaxed)) {
+                flush_all();
+                flush_done.store(req, std::memory_order_release);
+                if (stopping) {
+                    return;
+                }
+            }
+            if (total == 0) {
+                // Readers see the full blocks once the ring runs dry
+                write_out();
+                std::this_thread::sleep_for(std::chrono::microseconds(PID_HIST_IDLE_US));
+            }
+        }
+    };
+
+    void pid_historian::encode(const pid_hist_record& r) {
+        if (r.loop >= n) {
+            return;
+        }
+        pid_hist_encoder& e = enc[r.loop];
+        if (e.full()) {
+            seal(r.loop);
+        }
+        e.append(r);
+    };
+
+    /// @brief Move the open block of loop to the output and start a new one
+    void pid_historian::seal(uint32_t loop) {
+        pid_hist_encoder& e = enc[loop];
+        out.insert(out.end(), e.data(), e.data() + PID_HIST_BLOCK);
+        e.reset(loop);
+        if (out.size() >= PID_HIST_FLUSH) {
+            write_out();
+        }
+    };
+
+    /// @brief Append the full blocks and then commit them in the file header
+    void pid_historian::write_out() {
+        if (out.empty()) {
+            return;
+        }
+        uint64_t count = out.size() / PID_HIST_BLOCK;
+        off_t off = (off_t)((nblocks + 1) * PID_HIST_BLOCK);
+        if (pwrite(fd, out.data(), out.size(), off) != (ssize_t)out.size()) {
+            io_error.store(true);
+        }
+        else {
+            nblocks += count;
+            if (pwrite(fd, &nblocks, sizeof(nblocks), offsetof(pid_hist_file_header, committed)) != (ssize_t)sizeof(nblocks)) {
+                io_error.store(true);
+            }
+        }
+        out.clear();
+    };
+
+    void pid_historian::flush_all() {
+        for (size_t i = 0; i < n; i++) {
+            if (enc[i].count() != 0) {
+                seal((uint32_t)i);
+            }
+        }
+        write_out();
+    };
+
+    pid_hist_reader::pid_hist_reader() :
+        fd{-1},
+        base{nullptr},
+        mapped{0},
+        nblocks{0}
+        {};
+
+    pid_hist_reader::~pid_hist_reader() {
+        close();
+    };
+
+        /// @param path - File written by a pid_historian
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_hist_reader::open(const char* path) {
+        close();
+        fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            return -1;
+        }
+        pid_hist_file_header h;
+        if (pread(fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h) ||
+            h.magic != PID_HIST_MAGIC || h.version != PID_HIST_VERSION || h.block_bytes != PID_HIST_BLOCK) {
+            close();
+            return -1;
+        }
+        return refresh();
+    };
+
+    void pid_hist_reader::close() {
+        if (base != nullptr) {
+            munmap(base, mapped);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        fd = -1;
+        base = nullptr;
+        mapped = 0;
+        nblocks = 0;
+        index.clear();
+    };
+
+        /// @brief Remap the file up to the committed count and index the new blocks
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_hist_reader::refresh() {
+        if (fd < 0) {
+            return -1;
+        }
+        uint64_t committed;
+        if (pread(fd, &committed, sizeof(committed), offsetof(pid_hist_file_header, committed)) != (ssize_t)sizeof(committed)) {
+            return -1;
+        }
+        if (committed <= nblocks) {
+            return 0;
+        }
+        struct stat st;
+        size_t size = (size_t)((committed + 1) * PID_HIST_BLOCK);
+        if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < size) {
+            return -1;
+        }
+        void* p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            return -1;
+        }
+        if (base != nullptr) {
+            munmap(base, mapped);
+        }
+        base = p;
+        mapped = size;
+        for (uint64_t b = nblocks; b < committed; b++) {
+            const pid_hist_block_header* h = (const pid_hist_block_header*)((const uint8_t*)base + (b + 1) * PID_HIST_BLOCK);
+            if (h->magic != PID_HIST_BLOCK_MAGIC) {
+                continue;
+            }
+            if (h->loop >= index.size()) {
+                index.resize((size_t)h->loop + 1);
+            }
+            index[h->loop].push_back((uint32_t)b);
+        }
+        nblocks = committed;
+        return 0;
+    };
+
+        /// @param loop - Loop number
+        /// @param t0   - The earliest time
+        /// @param t1   - The latest time
+        /// @param out  - The reports are appended here in time order
+        /// @return Number of reports appended
+    size_t pid_hist_reader::read(uint32_t loop, uint64_t t0, uint64_t t1, std::vector<pid_hist_record>& out) const {
+        if (loop >= index.size()) {
+            return 0;
+        }
+        size_t before = out.size();
+        pid_hist_record recs[PID_HIST_BLOCK_RECORDS];
+        for (uint32_t b : index[loop]) {
+            const uint8_t* blk = (const uint8_t*)base + ((uint64_t)b + 1) * PID_HIST_BLOCK;
+            const pid_hist_block_header* h = (const pid_hist_block_header*)blk;
+            if (h->t_last < t0 || h->t_first > t1) {
+                continue;
+            }
+            size_t k = pid_hist_decode(blk, recs);
+            for (size_t j = 0; j < k; j++) {
+                if (recs[j].tstamp >= t0 && recs[j].tstamp <= t1) {
+                    out.push_back(recs[j]);
+                }
+            }
+        }
+        return out.size() - before;
+    };
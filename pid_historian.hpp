@@ -0,0 +1,214 @@
+/**
+ * @file pid_historian.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the compressed SP/PV/CO historian
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ * The control thread calls capture() after a step. A loop is reported when SP, PV or
+ * CO moved by more than its deviation since the last report, or when its heartbeat
+ * interval elapsed, and the report is pushed to a ring; nothing else runs on the
+ * control thread. A writer thread drains the ring and appends every report to the open
+ * block of its loop, Gorilla style: delta-of-delta timestamps and XOR-ed floats packed
+ * into a bit stream. Full blocks are appended to the file, which is a file header
+ * followed by blocks of PID_HIST_BLOCK bytes, and the committed block count in the
+ * file header is bumped after them. Readers map the committed blocks.
+ */
+#ifndef _PID_HISTORIAN_H
+#define _PID_HISTORIAN_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "pid_alloc.hpp"
+#include "pid_spsc.hpp"
+
+class pid_bank;
+
+#define PID_HIST_MAGIC 0x54534948u      // "HIST", file header
+#define PID_HIST_BLOCK_MAGIC 0x4b4c4248u // "HBLK", block header
+#define PID_HIST_VERSION 1
+#define PID_HIST_BLOCK 256              // Bytes of a block, header included, also the size of the file header
+#define PID_HIST_DEPTH 65536            // Default number of reports in the capture ring
+#define PID_HIST_FLUSH 65536            // Bytes of full blocks collected before a write
+#define PID_HIST_IDLE_US 1000           // Sleep of the writer when the ring is empty, usec
+#define PID_HIST_RECORD_BITS 200        // Longest encoded report, 68 bits of time and 44 per value
+
+/// @brief One report of a loop
+struct pid_hist_record {
+    uint64_t tstamp;
+    uint32_t loop;
+    float sp;
+    float pv;
+    float co;
+};
+
+/// @brief Header at the start of the file, padded to one block
+struct pid_hist_file_header {
+    uint32_t magic;         // PID_HIST_MAGIC
+    uint32_t version;       // PID_HIST_VERSION
+    uint32_t block_bytes;   // PID_HIST_BLOCK
+    uint32_t reserved;
+    uint64_t committed;     // Blocks readers may map
+};
+
+/// @brief Header of a block
+struct pid_hist_block_header {
+    uint32_t magic;         // PID_HIST_BLOCK_MAGIC
+    uint32_t loop;          // Loop of every report in the block
+    uint32_t count;         // Number of reports
+    uint32_t nbits;         // Bits of the stream used
+    uint64_t t_first;       // Time of the first report
+    uint64_t t_last;        // Time of the last report
+};
+
+#define PID_HIST_PAYLOAD (PID_HIST_BLOCK - sizeof(pid_hist_block_header))     // Stream bytes of a block
+#define PID_HIST_BLOCK_RECORDS (PID_HIST_PAYLOAD * 8 / 4)                      // Most reports a block holds, 4 bits each
+
+/// @brief The open block of one loop
+class pid_hist_encoder {
+
+    uint8_t blk[PID_HIST_BLOCK];    // Header and stream
+    uint64_t lt;                    // Time of the last report
+    int64_t ldelta;                 // The last time delta
+    uint32_t lv[3];                 // The last SP, PV and CO bits
+    uint8_t lead[3];                // Leading zeros of the last XOR window, 0xff before the first
+    uint8_t trail[3];               // Trailing zeros of the last XOR window
+
+    pid_hist_block_header* header() { return (pid_hist_block_header*)blk; }
+    void put(uint64_t v, int nbits);
+    void put_value(int k, uint32_t v);
+
+    public:
+        /// @brief Constructor, an empty block of loop 0
+        pid_hist_encoder() { reset(0); }
+
+        /// @brief Start an empty block of loop
+        void reset(uint32_t loop);
+
+        /// @brief Number of reports in the block
+        uint32_t count() const { return ((const pid_hist_block_header*)blk)->count; }
+
+        /// @brief True if the longest report may not fit any more
+        bool full() const { return ((const pid_hist_block_header*)blk)->nbits + PID_HIST_RECORD_BITS > PID_HIST_PAYLOAD * 8; }
+
+        /// @brief Append a report, the block must not be full
+        void append(const pid_hist_record& r);
+
+        /// @brief The block, PID_HIST_BLOCK bytes
+        const uint8_t* data() const { return blk; }
+};
+
+/// @brief Decode a block into out, out must hold PID_HIST_BLOCK_RECORDS reports
+size_t pid_hist_decode(const uint8_t* block, pid_hist_record* out);
+
+/// @brief Captures reports on the control thread and writes them on its own thread
+class pid_historian {
+
+    size_t n;                       // Number of loops
+
+    // Control thread
+    pid_vector<float> dev;          // Deviation that makes a report
+    pid_vector<uint64_t> beat;      // Heartbeat interval, usec
+    pid_vector<float> lsp;          // The last reported values
+    pid_vector<float> lpv;
+    pid_vector<float> lco;
+    pid_vector<uint64_t> lrep;      // Time of the last report
+    pid_vector<uint8_t> never;      // Not reported yet
+    spsc_ring<pid_hist_record> ring;
+    alignas(PID_CACHE_LINE) std::atomic<uint64_t> ndropped;    // Written by the control thread only
+
+    // Writer thread
+    std::vector<pid_hist_encoder> enc;
+    std::vector<uint8_t> out;       // Full blocks not written yet
+    std::vector<pid_hist_record> batch;
+    int fd;
+    uint64_t nblocks;               // Blocks in the file
+    std::atomic<bool> io_error;     // A write failed
+    std::thread writer;
+
+    alignas(PID_CACHE_LINE) std::atomic<bool> stop;
+    std::atomic<uint64_t> flush_req;   // Flushes requested
+    std::atomic<uint64_t> flush_done;  // Flushes completed
+    std::atomic<uint64_t> nwritten;    // Reports encoded
+
+    void run();
+    void encode(const pid_hist_record& r);
+    void seal(uint32_t loop);
+    void write_out();
+    void flush_all();
+
+    public:
+        /// @brief Constructor, every loop reports on any change and has no heartbeat
+        explicit pid_historian(size_t nloops, size_t depth = PID_HIST_DEPTH);
+
+        /// @brief Destructor, closes the file
+        ~pid_historian();
+
+        pid_historian(const pid_historian&) = delete;
+        pid_historian& operator=(const pid_historian&) = delete;
+
+        /// @brief Create the file and start the writer thread
+        int open(const char* path);
+
+        /// @brief Write every captured report, stop the writer thread and close the file
+        void close();
+
+        /// @brief Set the deviation and the heartbeat interval of loop i
+        int set_exception(size_t i, float devv, uint64_t beat_us);
+
+        /// @brief Control thread, report the loops whose values moved
+        size_t capture(uint64_t tstamp, const float* sp, const float* pv, const float* co);
+
+        /// @brief Control thread, capture the IO columns of a bank
+        size_t capture(pid_bank& bank, uint64_t tstamp);
+
+        /// @brief Wait until every report captured so far is committed to the file
+        int flush();
+
+        /// @brief Reports dropped because the ring was full
+        uint64_t dropped() const { return ndropped.load(std::memory_order_relaxed); }
+
+        /// @brief Reports encoded by the writer
+        uint64_t written() const { return nwritten.load(std::memory_order_relaxed); }
+};
+
+/// @brief Reads the committed blocks of a historian file, may run in any process
+class pid_hist_reader {
+
+    int fd;
+    void* base;                     // Mapping of the header and the committed blocks
+    size_t mapped;                  // Size of the mapping
+    uint64_t nblocks;               // Blocks indexed
+    std::vector<std::vector<uint32_t>> index;   // Blocks of every loop, in file order
+
+    public:
+        pid_hist_reader();
+        ~pid_hist_reader();
+
+        pid_hist_reader(const pid_hist_reader&) = delete;
+        pid_hist_reader& operator=(const pid_hist_reader&) = delete;
+
+        /// @brief Open a file and map its committed blocks
+        int open(const char* path);
+
+        /// @brief Close the file
+        void close();
+
+        /// @brief Map the blocks committed since the last call
+        int refresh();
+
+        /// @brief Number of blocks mapped
+        uint64_t blocks() const { return nblocks; }
+
+        /// @brief Append the reports of loop with t0 <= tstamp <= t1 to out
+        size_t read(uint32_t loop, uint64_t t0, uint64_t t1, std::vector<pid_hist_record>& out) const;
+};
+
+#endif /* _PID_HISTORIAN_H */
@@ -0,0 +1,200 @@
+#include "pid_bank.hpp"
+#include "pid_historian.hpp"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+std::string temp_path(const char* name) {
+
+  return std::string("/tmp/") + name + "_" + std::to_string(getpid());
+}
+
+bool same(const pid_hist_record& a, const pid_hist_record& b) {
+
+  return a.tstamp == b.tstamp && a.loop == b.loop && std::memcmp(&a.sp, &b.sp, 3 * sizeof(float)) == 0;
+}
+
+// Blocks decode bit-exactly, irregular time, jumps back, NaN and infinities included
+TEST(pid_historian, Codec) {
+
+  std::mt19937 gen(17);
+  std::uniform_real_distribution<float> val(-100, 100);
+  std::uniform_int_distribution<int> pick(0, 9);
+  pid_hist_encoder enc;
+  enc.reset(7);
+  std::vector<pid_hist_record> in;
+  uint64_t t = 123456789;
+  float sp = 1, pv = 0, co = 0;
+  while (!enc.full()) {
+    int p = pick(gen);
+    t += (p == 0) ? 1000000000ull : (p == 1) ? 0 : 1000 + (uint64_t)pick(gen);
+    if (p == 2) {
+      t -= 5000;
+    }
+    sp = (p == 3) ? val(gen) : sp;
+    pv = (p == 4) ? NAN : (p == 5) ? INFINITY : pv + 0.01f * val(gen);
+    co = (p == 6) ? co : val(gen);
+    pid_hist_record r{t, 7, sp, pv, co};
+    enc.append(r);
+    in.push_back(r);
+  }
+  ASSERT_EQ(enc.count(), in.size());
+
+  std::vector<pid_hist_record> out(PID_HIST_BLOCK_RECORDS);
+  ASSERT_EQ(pid_hist_decode(enc.data(), out.data()), in.size());
+  for (size_t i = 0; i < in.size(); i++) {
+    ASSERT_TRUE(same(in[i], out[i])) << "report " << i;
+  }
+
+  // Steady time and held values take 4 bits a report
+  enc.reset(1);
+  for (uint64_t k = 0; !enc.full(); k++) {
+    enc.append(pid_hist_record{k * 1000, 1, 1.0f, 2.0f, 3.0f});
+  }
+  EXPECT_GT(enc.count(), 300u);
+  EXPECT_EQ(pid_hist_decode(enc.data(), out.data()), enc.count());
+
+  // A damaged block decodes to nothing
+  uint8_t bad[PID_HIST_BLOCK];
+  std::memcpy(bad, enc.data(), sizeof(bad));
+  bad[0] ^= 1;
+  EXPECT_EQ(pid_hist_decode(bad, out.data()), 0u);
+}
+
+// Exception reporting with deviation and heartbeat, a ring without a writer drops
+TEST(pid_historian, Exceptions) {
+
+  pid_historian h(3, 8);
+  float sp[3] = {0, 0, 0}, pv[3] = {0, 0, 0}, co[3] = {0, 0, 0};
+  EXPECT_EQ(h.set_exception(0, 0.5f, 100), 0);
+  EXPECT_EQ(h.set_exception(3, 0.5f, 100), -1);
+  EXPECT_EQ(h.set_exception(1, -1.0f, 100), -1);
+  EXPECT_EQ(h.flush(), -1);
+
+  // Every loop reports once, then nothing moved
+  EXPECT_EQ(h.capture(10, sp, pv, co), 3u);
+  EXPECT_EQ(h.capture(20, sp, pv, co), 0u);
+  // Loop 0 stays within its deviation, loop 1 reports any change
+  pv[0] = 0.4f;
+  pv[1] = 0.001f;
+  EXPECT_EQ(h.capture(30, sp, pv, co), 1u);
+  // Heartbeat of loop 0
+  EXPECT_EQ(h.capture(110, sp, pv, co), 1u);
+  EXPECT_EQ(h.dropped(), 0u);
+  co[2] = 1;
+  co[1] = 1;
+  EXPECT_EQ(h.capture(120, sp, pv, co), 2u);
+  // The ring of 8 fills up, nobody drains it
+  sp[0] = sp[1] = sp[2] = 1;
+  EXPECT_EQ(h.capture(130, sp, pv, co), 1u);
+  EXPECT_EQ(h.dropped(), 2u);
+  // Dropped loops are retried on the next capture
+  EXPECT_EQ(h.capture(140, sp, pv, co), 0u);
+  EXPECT_EQ(h.dropped(), 4u);
+}
+
+// A PV that fails to NaN and recovers is reported both times without a heartbeat
+TEST(pid_historian, NaN) {
+
+  pid_historian h(1, 8);
+  float sp[1] = {0}, pv[1] = {1}, co[1] = {0};
+  EXPECT_EQ(h.set_exception(0, 0.5f, UINT64_MAX), 0);
+  EXPECT_EQ(h.capture(10, sp, pv, co), 1u);
+  pv[0] = std::numeric_limits<float>::quiet_NaN();
+  EXPECT_EQ(h.capture(20, sp, pv, co), 1u);
+  EXPECT_EQ(h.capture(30, sp, pv, co), 0u);
+  pv[0] = 1;
+  EXPECT_EQ(h.capture(40, sp, pv, co), 1u);
+  EXPECT_EQ(h.capture(50, sp, pv, co), 0u);
+}
+
+// A bank is captured every cycle and read back by a reader in the meantime
+TEST(pid_historian, Bank) {
+
+  const size_t n = 64;
+  const uint64_t steps = 3000;
+  std::string path = temp_path("pid_historian");
+  pid_bank bank(n);
+  for (size_t i = 0; i < n; i++) {
+    bank.set_loop(i, 0.5f, 100.0f, 0, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                  -10, 10, false, false, 1000);
+    bank.sp_data()[i] = (float)(i % 5);
+  }
+  pid_historian h(n, 1 << 16);
+  ASSERT_EQ(h.open(path.c_str()), 0);
+  EXPECT_EQ(h.open(path.c_str()), -1);
+  pid_hist_reader rd;
+  ASSERT_EQ(rd.open(path.c_str()), 0);
+
+  // What every loop reported, the values after each step
+  std::vector<std::vector<pid_hist_record>> want(n);
+  std::vector<float> lsp(n), lpv(n), lco(n);
+  for (uint64_t t = 1; t <= steps; t++) {
+    uint64_t ts = t * 1000;
+    for (size_t i = 0; i < n; i++) {
+      bank.pv_data()[i] = std::floor(10.0f * std::sin((float)(t + i) * 0.01f)) * 0.1f;
+      if (t % 500 == 0) {
+        bank.sp_data()[i] += 1;
+      }
+    }
+    bank.step_all(ts);
+    h.capture(bank, ts);
+    for (size_t i = 0; i < n; i++) {
+      float sp = bank.sp_data()[i], pv = bank.pv_data()[i], co = bank.co_data()[i];
+      if (t == 1 || sp != lsp[i] || pv != lpv[i] || co != lco[i]) {
+        want[i].push_back(pid_hist_record{ts, (uint32_t)i, sp, pv, co});
+        lsp[i] = sp;
+        lpv[i] = pv;
+        lco[i] = co;
+      }
+    }
+    if (t == steps / 2) {
+      ASSERT_EQ(h.flush(), 0);
+      ASSERT_EQ(rd.refresh(), 0);
+      std::vector<pid_hist_record> got;
+      rd.read(3, 0, UINT64_MAX, got);
+      ASSERT_EQ(got.size(), want[3].size());
+    }
+  }
+  ASSERT_EQ(h.flush(), 0);
+  EXPECT_EQ(h.dropped(), 0u);
+  ASSERT_EQ(rd.refresh(), 0);
+
+  size_t total = 0;
+  for (size_t i = 0; i < n; i++) {
+    std::vector<pid_hist_record> got;
+    rd.read((uint32_t)i, 0, UINT64_MAX, got);
+    ASSERT_EQ(got.size(), want[i].size()) << "loop " << i;
+    for (size_t k = 0; k < got.size(); k++) {
+      ASSERT_TRUE(same(got[k], want[i][k])) << "loop " << i << " report " << k;
+    }
+    total += got.size();
+  }
+  EXPECT_EQ(h.written(), total);
+
+  // A time window
+  std::vector<pid_hist_record> win;
+  rd.read(0, 1000000, 1999999, win);
+  ASSERT_FALSE(win.empty());
+  EXPECT_GE(win.front().tstamp, 1000000u);
+  EXPECT_LE(win.back().tstamp, 1999999u);
+
+  // Well below 24 bytes a report
+  h.close();
+  struct stat st;
+  ASSERT_EQ(stat(path.c_str(), &st), 0);
+  EXPECT_LT((double)st.st_size / (double)total, 12.0);
+  rd.close();
+  std::remove(path.c_str());
+}
+}  // namespace
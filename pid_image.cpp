@@ -0,0 +1,297 @@
+/**
+ * @file pid_image.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Shared-memory process image of a PID bank
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ */
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pid_image.hpp"
+
+static_assert(sizeof(pid_image_header) <= PID_IMAGE_PAGE, "the header must fit in one page");
+
+    /// @brief Round a size up to whole pages
+    static inline uint64_t page_round(uint64_t bytes) {
+        return (bytes + PID_IMAGE_PAGE - 1) / PID_IMAGE_PAGE * PID_IMAGE_PAGE;
+    };
+
+    pid_image::pid_image() :
+        base{nullptr},
+        bytes{0},
+        hdr{nullptr}
+        {};
+
+    pid_image::~pid_image() {
+        close();
+    };
+
+        /// @brief Create an image and map it, an image mapped before is unmapped
+        /// @param nin  Number of input values
+        /// @param nout Number of output values
+        /// @param path File of the image, e.g. under /dev/shm, it is created or truncated.
+        ///             nullptr maps anonymous memory visible to this process only
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_image::create(size_t nin, size_t nout, const char* path) {
+        close();
+        if (nin == 0 || nout == 0 || nin >= PID_IMAGE_NONE || nout >= PID_IMAGE_NONE) {
+            return -1;
+        }
+        uint64_t in_bytes = page_round(nin * sizeof(float));
+        uint64_t out_bytes = page_round(nout * sizeof(float));
+        size_t size = PID_IMAGE_PAGE + 2 * in_bytes + 2 * out_bytes;
+
+        void* p;
+        if (path == nullptr) {
+            p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        }
+        else {
+            int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+            if (fd < 0) {
+                return -1;
+            }
+            if (ftruncate(fd, (off_t)size) != 0) {
+                ::close(fd);
+                return -1;
+            }
+            p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            // The mapping keeps the file referenced
+            ::close(fd);
+        }
+        if (p == MAP_FAILED) {
+            return -1;
+        }
+
+        // A new mapping is zero filled, both sequences start at 0
+        base = p;
+        bytes = size;
+        hdr = (pid_image_header*)p;
+        hdr->nin = nin;
+        hdr->nout = nout;
+        hdr->in_off[0] = PID_IMAGE_PAGE;
+        hdr->in_off[1] = PID_IMAGE_PAGE + in_bytes;
+        hdr->out_off[0] = PID_IMAGE_PAGE + 2 * in_bytes;
+        hdr->out_off[1] = PID_IMAGE_PAGE + 2 * in_bytes + out_bytes;
+        hdr->version = PID_IMAGE_VERSION;
+        std::atomic_thread_fence(std::memory_order_release);
+        hdr->magic = PID_IMAGE_MAGIC;
+        return 0;
+    };
+
+        /// @brief Map an image created by create(), an image mapped before is unmapped
+        /// @param path File of the image
+        /// @return 0  - O'k
+        ///         -1 - Error, no such file or it is not an image of this version
+    int pid_image::attach(const char* path) {
+        close();
+        int fd = open(path, O_RDWR);
+        if (fd < 0) {
+            return -1;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < PID_IMAGE_PAGE) {
+            ::close(fd);
+            return -1;
+        }
+        size_t size = (size_t)st.st_size;
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return -1;
+        }
+
+        pid_image_header* h = (pid_image_header*)p;
+        bool valid = h->magic == PID_IMAGE_MAGIC && h->version == PID_IMAGE_VERSION &&
+                     h->nin > 0 && h->nout > 0 && h->nin < PID_IMAGE_NONE && h->nout < PID_IMAGE_NONE;
+        for (int k = 0; valid && k < 2; k++) {
+            valid = h->in_off[k] % PID_IMAGE_PAGE == 0 && h->in_off[k] >= PID_IMAGE_PAGE &&
+                    h->in_off[k] + h->nin * sizeof(float) <= size &&
+                    h->out_off[k] % PID_IMAGE_PAGE == 0 && h->out_off[k] >= PID_IMAGE_PAGE &&
+                    h->out_off[k] + h->nout * sizeof(float) <= size;
+        }
+        if (!valid) {
+            munmap(p, size);
+            return -1;
+        }
+        base = p;
+        bytes = size;
+        hdr = h;
+        return 0;
+    };
+
+    void pid_image::close() {
+        if (base != nullptr) {
+            munmap(base, bytes);
+        }
+        base = nullptr;
+        bytes = 0;
+        hdr = nullptr;
+    };
+
+        /// @brief The Constructor, every signal of every loop is unconnected
+        /// @param nloops Number of loops, the bank must have at least as many
+    pid_image_map::pid_image_map(size_t nloops) :
+        n{nloops},
+        pv_idx(nloops, PID_IMAGE_NONE),
+        sp_idx(nloops, PID_IMAGE_NONE),
+        tb_idx(nloops, PID_IMAGE_NONE),
+        co_idx(nloops, PID_IMAGE_NONE),
+        runs{PID_IMAGE_NONE, PID_IMAGE_NONE, PID_IMAGE_NONE, PID_IMAGE_NONE},
+        in_end{0},
+        out_end{0},
+        dirty{true}
+        {};
+
+        /// @brief Bind the signals of loop i to image values
+        /// @param i  Loop number
+        /// @param pv Input index of PV
+        /// @param sp Input index of SP
+        /// @param tb Input index of Tieback
+        /// @param co Output index of CO
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_image_map::bind(size_t i, uint32_t pv, uint32_t sp, uint32_t tb, uint32_t co) {
+        if (i >= n) {
+            return -1;
+        }
+        pv_idx[i] = pv;
+        sp_idx[i] = sp;
+        tb_idx[i] = tb;
+        co_idx[i] = co;
+        dirty = true;
+        return 0;
+    };
+
+    /// @brief First index of a column bound to consecutive values, PID_IMAGE_NONE otherwise
+    static uint32_t column_run(const uint32_t* idx, size_t n) {
+        if (n == 0 || idx[0] == PID_IMAGE_NONE || (uint64_t)idx[0] + n > PID_IMAGE_NONE) {
+            return PID_IMAGE_NONE;
+        }
+        for (size_t i = 1; i < n; i++) {
+            if (idx[i] != idx[0] + (uint32_t)i) {
+                return PID_IMAGE_NONE;
+            }
+        }
+        return idx[0];
+    };
+
+    /// @brief Largest bound index of a column + 1
+    static uint64_t column_end(const uint32_t* idx, size_t n) {
+        uint64_t end = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (idx[i] != PID_IMAGE_NONE && idx[i] + (uint64_t)1 > end) {
+                end = idx[i] + (uint64_t)1;
+            }
+        }
+        return end;
+    };
+
+    void pid_image_map::analyse() {
+        runs[0] = column_run(pv_idx.data(), n);
+        runs[1] = column_run(sp_idx.data(), n);
+        runs[2] = column_run(tb_idx.data(), n);
+        runs[3] = column_run(co_idx.data(), n);
+        in_end = std::max(column_end(pv_idx.data(), n),
+                 std::max(column_end(sp_idx.data(), n), column_end(tb_idx.data(), n)));
+        out_end = column_end(co_idx.data(), n);
+        dirty = false;
+    };
+
+        /// @brief Check the bindings against an image and a bank
+        /// @return 0  - O'k
+        ///         -1 - Error, an index is out of the image or the bank has fewer loops
+    int pid_image_map::check(const pid_image& img, const pid_bank& bank) const {
+        uint64_t iend = std::max(column_end(pv_idx.data(), n),
+                        std::max(column_end(sp_idx.data(), n), column_end(tb_idx.data(), n)));
+        uint64_t oend = column_end(co_idx.data(), n);
+        return (bank.size() < n || iend > img.inputs() || oend > img.outputs()) ? -1 : 0;
+    };
+
+    /// @brief Copy one input column, sequential on the bank side
+    static inline void gather_column(float* dst, const pid_image_value* src, const uint32_t* idx, uint32_t run, size_t n) {
+        if (run != PID_IMAGE_NONE) {
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = src[run + i].load(std::memory_order_relaxed);
+            }
+            return;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (idx[i] != PID_IMAGE_NONE) {
+                dst[i] = src[idx[i]].load(std::memory_order_relaxed);
+            }
+        }
+    };
+
+        /// @brief Copy PV, SP and Tieback of the latest published inputs page into the bank.
+        ///        The IO process may flip a new page in meanwhile and start to refill the one
+        ///        being read, the copy is then repeated from the newer page. An IO process that
+        ///        publishes at most once per controller cycle never makes it repeat
+        /// @return 0  - O'k
+        ///         -1 - Error, a binding is out of range or every attempt was overwritten
+    int pid_image_map::gather(const pid_image& img, pid_bank& bank) {
+        if (dirty) {
+            analyse();
+        }
+        if (bank.size() < n || in_end > img.inputs()) {
+            return -1;
+        }
+        return img.read_inputs([&](const pid_image_value* in) {
+            gather_column(bank.pv_data(), in, pv_idx.data(), runs[0], n);
+            gather_column(bank.sp_data(), in, sp_idx.data(), runs[1], n);
+            gather_column(bank.tb_data(), in, tb_idx.data(), runs[2], n);
+        });
+    };
+
+        /// @brief Copy CO of the bank into the outputs page and flip it in
+        /// @return 0  - O'k
+        ///         -1 - Error, a binding is out of range
+    int pid_image_map::scatter(const pid_bank& bank, pid_image& img) {
+        if (dirty) {
+            analyse();
+        }
+        if (bank.size() < n || out_end > img.outputs()) {
+            return -1;
+        }
+        pid_image_value* out = img.output_write_page();
+        const float* co = bank.co_data();
+        if (runs[3] != PID_IMAGE_NONE) {
+            for (size_t i = 0; i < n; i++) {
+                out[runs[3] + i].store(co[i], std::memory_order_relaxed);
+            }
+        }
+        else {
+            for (size_t i = 0; i < n; i++) {
+                if (co_idx[i] != PID_IMAGE_NONE) {
+                    out[co_idx[i]].store(co[i], std::memory_order_relaxed);
+                }
+            }
+        }
+        img.publish_outputs();
+        return 0;
+    };
+
+        /// @brief One controller cycle over the image, the bank is not stepped if the
+        ///        inputs could not be read
+        /// @param tstamp - Time, when the calculation is performed
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_image_map::run_cycle(pid_image& img, pid_bank& bank, uint64_t tstamp) {
+        if (gather(img, bank) != 0) {
+            return -1;
+        }
+        if (bank.step_all(tstamp) != 0) {
+            return -1;
+        }
+        return scatter(bank, img);
+    };
@@ -0,0 +1,205 @@
+/**
+ * @file pid_image.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the shared-memory process image of a PID bank
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ * Layout of the image, every part starts on a PID_IMAGE_PAGE boundary:
+ *
+ *   header | inputs page 0 | inputs page 1 | outputs page 0 | outputs page 1
+ *
+ * Inputs are written by the IO process and read by the controller, outputs the other
+ * way round. Each side fills the page that is not published and flips it in by
+ * incrementing the sequence, page = seq & 1. The image is a plain file mapping, so it
+ * can live in /dev/shm and be mapped by any process.
+ *
+ * Every page also has a version word, a seqlock over the page. The writer of
+ * publication s marks the page 2 * s + 1 before it writes a value and 2 * s once it is
+ * complete, then increments the sequence to s. A reader takes the sequence, checks the
+ * page version is 2 * seq, copies the page and checks the version again; a writer that
+ * lapped the reader and started to refill the page makes it retry. The values are
+ * std::atomic<float> accessed with relaxed loads and stores, so the concurrent refill
+ * is not a data race; ordering comes from the fences around the version word.
+ */
+#ifndef _PID_IMAGE_H
+#define _PID_IMAGE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "pid_alloc.hpp"
+#include "pid_bank.hpp"
+
+#define PID_IMAGE_MAGIC 0x49444950u // "PIDI"
+#define PID_IMAGE_VERSION 2
+#define PID_IMAGE_PAGE 4096         // Alignment of the header and the pages
+#define PID_IMAGE_NONE UINT32_MAX   // Index of an unconnected input or output
+#define PID_IMAGE_RETRIES 4         // Attempts to read a page that is not rewritten meanwhile
+
+/// @brief A value of the image, accessed with relaxed loads and stores
+typedef std::atomic<float> pid_image_value;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the image sequences must be lock-free");
+static_assert(pid_image_value::is_always_lock_free && sizeof(pid_image_value) == sizeof(float),
+              "the image values must be lock-free floats");
+
+/// @brief Header at the start of the image
+struct pid_image_header {
+    uint32_t magic;         // PID_IMAGE_MAGIC
+    uint32_t version;       // PID_IMAGE_VERSION
+    uint64_t nin;           // Number of input values
+    uint64_t nout;          // Number of output values
+    uint64_t in_off[2];     // Byte offsets of the input pages
+    uint64_t out_off[2];    // Byte offsets of the output pages
+    alignas(PID_CACHE_LINE) std::atomic<uint64_t> in_seq;   // Inputs published so far
+    std::atomic<uint64_t> in_ver[2];                        // Versions of the input pages
+    alignas(PID_CACHE_LINE) std::atomic<uint64_t> out_seq;  // Outputs published so far
+    std::atomic<uint64_t> out_ver[2];                       // Versions of the output pages
+};
+
+/// @brief A process image mapped into this process
+class pid_image {
+
+    void* base;                 // Mapping
+    size_t bytes;               // Size of the mapping
+    pid_image_header* hdr;
+
+    pid_image_value* page(uint64_t off) const { return (pid_image_value*)((char*)base + off); }
+
+    /// @brief Mark the unpublished page as being written, the fence keeps the value
+    ///        stores after the mark
+    pid_image_value* write_page(const std::atomic<uint64_t>& seq, std::atomic<uint64_t>* ver,
+                                const uint64_t* off) {
+        uint64_t next = seq.load(std::memory_order_relaxed) + 1;
+        ver[next & 1].store(2 * next + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return page(off[next & 1]);
+    }
+
+    /// @brief Mark the written page complete and flip it in
+    void publish(std::atomic<uint64_t>& seq, std::atomic<uint64_t>* ver) {
+        uint64_t next = seq.load(std::memory_order_relaxed) + 1;
+        ver[next & 1].store(2 * next, std::memory_order_release);
+        seq.store(next, std::memory_order_release);
+    }
+
+    /// @brief Copy the last published page, again if the writer started to refill it
+    ///        meanwhile
+    template <typename F>
+    int read_page(const std::atomic<uint64_t>& seq, const std::atomic<uint64_t>* ver,
+                  const uint64_t* off, F copy) const {
+        for (int k = 0; k < PID_IMAGE_RETRIES; k++) {
+            uint64_t s = seq.load(std::memory_order_acquire);
+            uint64_t v = ver[s & 1].load(std::memory_order_acquire);
+            if (v != 2 * s) {
+                continue;
+            }
+            copy((const pid_image_value*)page(off[s & 1]));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (ver[s & 1].load(std::memory_order_relaxed) == v) {
+                return 0;
+            }
+        }
+        return -1;
+    }
+
+    public:
+        pid_image();
+        ~pid_image();
+
+        pid_image(const pid_image&) = delete;
+        pid_image& operator=(const pid_image&) = delete;
+
+        /// @brief Create an image, in anonymous memory if path is nullptr
+        int create(size_t nin, size_t nout, const char* path = nullptr);
+
+        /// @brief Map an image created by another process
+        int attach(const char* path);
+
+        /// @brief Unmap the image
+        void close();
+
+        /// @brief Number of input and output values, 0 if nothing is mapped
+        size_t inputs() const { return (hdr == nullptr) ? 0 : hdr->nin; }
+        size_t outputs() const { return (hdr == nullptr) ? 0 : hdr->nout; }
+
+        // IO process side
+
+        /// @brief Inputs page to fill with relaxed stores before publish_inputs(), the
+        ///        page is marked as being written
+        pid_image_value* input_page() { return write_page(hdr->in_seq, hdr->in_ver, hdr->in_off); }
+
+        /// @brief Flip the filled inputs page in
+        void publish_inputs() { publish(hdr->in_seq, hdr->in_ver); }
+
+        /// @brief Pass the last published outputs page to copy(const pid_image_value*)
+        /// @return 0  - O'k
+        ///         -1 - Error, every attempt was overwritten
+        template <typename F>
+        int read_outputs(F copy) const { return read_page(hdr->out_seq, hdr->out_ver, hdr->out_off, copy); }
+
+        // Controller side
+
+        /// @brief Number of inputs pages published so far
+        uint64_t input_seq() const { return hdr->in_seq.load(std::memory_order_acquire); }
+
+        /// @brief Pass the last published inputs page to copy(const pid_image_value*)
+        /// @return 0  - O'k
+        ///         -1 - Error, every attempt was overwritten
+        template <typename F>
+        int read_inputs(F copy) const { return read_page(hdr->in_seq, hdr->in_ver, hdr->in_off, copy); }
+
+        /// @brief Outputs page to fill with relaxed stores before publish_outputs()
+        pid_image_value* output_write_page() { return write_page(hdr->out_seq, hdr->out_ver, hdr->out_off); }
+
+        /// @brief Flip the filled outputs page in
+        void publish_outputs() { publish(hdr->out_seq, hdr->out_ver); }
+
+        /// @brief Number of outputs pages published so far
+        uint64_t output_seq() const { return hdr->out_seq.load(std::memory_order_acquire); }
+};
+
+/// @brief Binds the loops of a pid_bank to image values by index. A cycle gathers PV, SP
+///        and Tieback from the published inputs page into the bank, steps the bank and
+///        scatters CO into the outputs page. A column whose indices are consecutive is
+///        moved as one run.
+class pid_image_map {
+
+    size_t n;                           // Number of loops
+    pid_vector<uint32_t> pv_idx;        // Input index of PV
+    pid_vector<uint32_t> sp_idx;        // Input index of SP
+    pid_vector<uint32_t> tb_idx;        // Input index of Tieback
+    pid_vector<uint32_t> co_idx;        // Output index of CO
+    uint32_t runs[4];                   // First index of a consecutive column, PID_IMAGE_NONE if not
+    uint64_t in_end;                    // Largest bound input index + 1
+    uint64_t out_end;                   // Largest bound output index + 1
+    bool dirty;                         // The bindings changed since the last cycle
+
+    void analyse();
+
+    public:
+        /// @brief Constructor, nothing is bound
+        explicit pid_image_map(size_t nloops);
+
+        /// @brief Bind loop i, PID_IMAGE_NONE leaves the bank value of that signal as it is
+        int bind(size_t i, uint32_t pv, uint32_t sp, uint32_t tb, uint32_t co);
+
+        /// @brief Check every binding against the image and the bank size
+        int check(const pid_image& img, const pid_bank& bank) const;
+
+        /// @brief Copy the inputs of the published page into the bank
+        int gather(const pid_image& img, pid_bank& bank);
+
+        /// @brief Copy CO of the bank into the outputs page and publish it
+        int scatter(const pid_bank& bank, pid_image& img);
+
+        /// @brief gather, step_all and scatter
+        int run_cycle(pid_image& img, pid_bank& bank, uint64_t tstamp);
+};
+
+#endif /* _PID_IMAGE_H */
@@ -0,0 +1,225 @@
+#include "pid_image.hpp"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+// Copy the last published outputs page as the IO process does
+std::vector<float> outputs(const pid_image& img) {
+
+  std::vector<float> out(img.outputs());
+  EXPECT_EQ(img.read_outputs([&](const pid_image_value* page) {
+    for (size_t i = 0; i < out.size(); i++) {
+      out[i] = page[i].load(std::memory_order_relaxed);
+    }
+  }), 0);
+  return out;
+}
+
+void configure(pid_bank& bank) {
+
+  for (size_t i = 0; i < bank.size(); i++) {
+    bank.set_loop(i, 0.5f + 0.1f * (float)i, 20.0f, 0.0f, 0.0f, -__FLT_MAX__, __FLT_MAX__,
+                  -__FLT_MAX__, __FLT_MAX__, -50.0f, 50.0f, false, false, 1);
+  }
+}
+
+// Bad sizes, unbound maps and bindings out of the image
+TEST(pid_image, Bounds) {
+
+  pid_image img;
+  pid_bank bank(4);
+  pid_image_map map(4);
+
+  EXPECT_EQ(img.create(0, 4), -1);
+  EXPECT_EQ(img.inputs(), 0u);
+  ASSERT_EQ(img.create(8, 4), 0);
+  EXPECT_EQ(img.inputs(), 8u);
+  EXPECT_EQ(img.outputs(), 4u);
+  EXPECT_EQ(img.attach("/nonexistent/pid_image"), -1);
+  ASSERT_EQ(img.create(8, 4), 0);
+
+  EXPECT_EQ(map.bind(4, 0, 0, 0, 0), -1);
+  EXPECT_EQ(map.check(img, bank), 0);
+  EXPECT_EQ(map.bind(3, 8, 0, 0, 0), 0);
+  EXPECT_EQ(map.check(img, bank), -1);
+  EXPECT_EQ(map.gather(img, bank), -1);
+  EXPECT_EQ(map.bind(3, 7, 0, 0, 4), 0);
+  EXPECT_EQ(map.gather(img, bank), 0);
+  EXPECT_EQ(map.scatter(bank, img), -1);
+
+  pid_bank small(3);
+  EXPECT_EQ(map.bind(3, 7, 0, 0, 3), 0);
+  EXPECT_EQ(map.check(img, small), -1);
+  EXPECT_EQ(map.run_cycle(img, small, 10), -1);
+}
+
+// Consecutive and scattered bindings give the outputs of a bank fed directly
+TEST(pid_image, Cycle) {
+
+  const size_t n = 37;
+  pid_image img;
+  ASSERT_EQ(img.create(3 * n + 5, n + 3), 0);
+  pid_bank ref(n), bank(n), perm(n);
+  configure(ref);
+  configure(bank);
+  configure(perm);
+
+  // Columns of consecutive values and a reversed, interleaved layout
+  pid_image_map flat(n), rev(n);
+  for (size_t i = 0; i < n; i++) {
+    flat.bind(i, (uint32_t)i, (uint32_t)(n + i), (uint32_t)(2 * n + i), (uint32_t)i);
+  }
+
+  for (uint64_t t = 1; t <= 50; t++) {
+    pid_image_value* in = img.input_page();
+    for (size_t i = 0; i < n; i++) {
+      in[i] = ref.pv_data()[i] = (float)((i * 7 + t * 3) % 11) - 5.0f;
+      in[n + i] = ref.sp_data()[i] = (float)(i % 4);
+      in[2 * n + i] = ref.tb_data()[i] = 0.0f;
+    }
+    img.publish_inputs();
+    ref.step_all(t * 10);
+
+    ASSERT_EQ(flat.run_cycle(img, bank, t * 10), 0);
+    std::vector<float> out = outputs(img);
+    ASSERT_EQ(std::memcmp(out.data(), ref.co_data(), n * sizeof(float)), 0) << "step " << t;
+  }
+
+  // The same values placed in reverse, Tieback left unconnected
+  pid_image rimg;
+  ASSERT_EQ(rimg.create(2 * n, n), 0);
+  for (size_t i = 0; i < n; i++) {
+    rev.bind(i, (uint32_t)(2 * (n - 1 - i)), (uint32_t)(2 * (n - 1 - i) + 1), PID_IMAGE_NONE,
+             (uint32_t)(n - 1 - i));
+  }
+  pid_bank rref(n);
+  configure(rref);
+  for (uint64_t t = 1; t <= 50; t++) {
+    pid_image_value* in = rimg.input_page();
+    for (size_t i = 0; i < n; i++) {
+      in[2 * (n - 1 - i)] = rref.pv_data()[i] = (float)((i * 5 + t) % 9) - 4.0f;
+      in[2 * (n - 1 - i) + 1] = rref.sp_data()[i] = 1.0f;
+    }
+    rimg.publish_inputs();
+    rref.step_all(t * 10);
+
+    ASSERT_EQ(rev.run_cycle(rimg, perm, t * 10), 0);
+    std::vector<float> out = outputs(rimg);
+    for (size_t i = 0; i < n; i++) {
+      ASSERT_EQ(out[n - 1 - i], rref.co_data()[i]) << "loop " << i << " step " << t;
+    }
+  }
+  EXPECT_EQ(img.output_seq(), 50u);
+}
+
+// Pages flip, the controller reads the last published page only
+TEST(pid_image, PageFlip) {
+
+  pid_image img;
+  ASSERT_EQ(img.create(1, 1), 0);
+  pid_bank bank(1);
+  pid_image_map map(1);
+  map.bind(0, 0, PID_IMAGE_NONE, PID_IMAGE_NONE, 0);
+
+  img.input_page()[0] = 1;
+  img.publish_inputs();
+  // Filled but not published yet
+  img.input_page()[0] = 2;
+  EXPECT_EQ(img.input_seq(), 1u);
+  EXPECT_EQ(map.gather(img, bank), 0);
+  EXPECT_EQ(bank.pv_data()[0], 1);
+  img.publish_inputs();
+  EXPECT_EQ(map.gather(img, bank), 0);
+  EXPECT_EQ(bank.pv_data()[0], 2);
+}
+
+// A writer that publishes as fast as it can never lets gather() copy a torn page, every
+// value of a page is the sequence it was published with
+TEST(pid_image, RacingWriter) {
+
+  const size_t n = 1024;
+  pid_image img;
+  ASSERT_EQ(img.create(n, 1), 0);
+  pid_bank bank(n);
+  pid_image_map map(n);
+  for (size_t i = 0; i < n; i++) {
+    map.bind(i, (uint32_t)i, PID_IMAGE_NONE, PID_IMAGE_NONE, PID_IMAGE_NONE);
+  }
+
+  std::atomic<bool> stop{false};
+  std::thread io([&] {
+    for (float seq = 1; !stop.load(std::memory_order_relaxed); seq++) {
+      pid_image_value* in = img.input_page();
+      for (size_t i = 0; i < n; i++) {
+        in[i].store(seq, std::memory_order_relaxed);
+      }
+      img.publish_inputs();
+    }
+  });
+
+  size_t ok = 0;
+  float last = 0;
+  for (int k = 0; k < 20000 && ok < 2000; k++) {
+    if (map.gather(img, bank) != 0) {
+      continue;
+    }
+    ok++;
+    const float* pv = bank.pv_data();
+    for (size_t i = 1; i < n; i++) {
+      ASSERT_EQ(pv[i], pv[0]) << "torn page at " << i;
+    }
+    ASSERT_GE(pv[0], last);
+    last = pv[0];
+  }
+  stop.store(true, std::memory_order_relaxed);
+  io.join();
+  EXPECT_GT(ok, 0u);
+}
+
+// A second mapping of the same file sees the other side's pages
+TEST(pid_image, SharedFile) {
+
+  std::string path = "/tmp/pid_image_" + std::to_string(getpid());
+  pid_image ctl, io;
+  ASSERT_EQ(ctl.create(16, 8, path.c_str()), 0);
+  ASSERT_EQ(io.attach(path.c_str()), 0);
+  EXPECT_EQ(io.inputs(), 16u);
+  EXPECT_EQ(io.outputs(), 8u);
+
+  pid_bank bank(8);
+  configure(bank);
+  pid_image_map map(8);
+  for (uint32_t i = 0; i < 8; i++) {
+    map.bind(i, i, 8 + i, PID_IMAGE_NONE, i);
+  }
+
+  pid_image_value* in = io.input_page();
+  for (size_t i = 0; i < 8; i++) {
+    in[i] = 0;
+    in[8 + i] = 1;
+  }
+  io.publish_inputs();
+  ASSERT_EQ(map.run_cycle(ctl, bank, 1000), 0);
+  ASSERT_EQ(map.run_cycle(ctl, bank, 2000), 0);
+  EXPECT_EQ(io.output_seq(), 2u);
+  std::vector<float> out = outputs(io);
+  EXPECT_EQ(std::memcmp(out.data(), bank.co_data(), 8 * sizeof(float)), 0);
+  EXPECT_GT(out[0], 0);
+
+  io.close();
+  std::FILE* f = std::fopen(path.c_str(), "r+b");
+  ASSERT_NE(f, nullptr);
+  std::fputc(0, f);
+  std::fclose(f);
+  EXPECT_EQ(io.attach(path.c_str()), -1);
+  ctl.close();
+  std::remove(path.c_str());
+}
+}  // namespace
@@ -0,0 +1,1002 @@
+/**
+ * @file pid_kernels.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Scalar and SIMD kernels that step a PID bank
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ */
+
+#include "pid_kernels.hpp"
+#include "pid.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PID_KERNELS_X86 1
+#endif
+
+// AVX-512F carries FMA, keep mul and add separate so lanes round like the scalar path
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize ("fp-contract=off")
+// GCC 12 reports the self-initialized placeholders of the AVX-512 intrinsics
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#elif defined(__clang__)
+#pragma clang fp contract(off)
+#endif
+
+    /// @brief Step loop i, pid_step over its columns
+    static inline void pid_loop_step(const pid_bank_view& v, uint64_t tstamp, size_t i) {
+        pid_step_config<float> c{v.dtmin[i], v.kp[i], v.ki[i], v.kd[i], v.db[i], v.coll[i], v.cohl[i],
+                                 v.db_on[i] != 0, v.man_on[i] != 0};
+        pid_state<float> s{v.lts[i], v.Iterm[i], v.lerr[i], v.lco[i], v.lman_on[i] != 0};
+        pid_outputs<float> o = pid_step(c, s, pid_inputs<float>{tstamp, v.pv[i], v.sp[i], c.man_on ? v.tb[i] : 0.0f, false, false});
+        v.co[i] = o.co;
+        v.lts[i] = s.lts;
+        v.Iterm[i] = s.Iterm;
+        v.lerr[i] = s.lerr;
+        v.lco[i] = s.lco;
+        v.lman_on[i] = s.lman_on;
+    };
+
+        /// @brief Step loops [first, last) one by one, every loop runs pid_step
+        /// @param v      - Bank columns
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first loop number
+        /// @param last   - The loop number after the last one
+    void pid_kernel_scalar(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            pid_loop_step(v, tstamp, i);
+        }
+    };
+
+        /// @brief Step the listed loops one by one, every loop runs pid_step
+        /// @param v      - Bank columns
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param idx    - Loop numbers
+        /// @param count  - Number of loop numbers
+    void pid_kernel_list(const pid_bank_view& v, uint64_t tstamp, const uint32_t* idx, size_t count) {
+        for (size_t k = 0; k < count; k++) {
+            pid_loop_step(v, tstamp, idx[k]);
+        }
+    };
+
+    /// @brief Step velocity-form loop i, follows basic_vpid::run_pid
+    static inline void pid_vloop_step(const pid_vbank_view& v, uint64_t tstamp, size_t i) {
+        // No increment if no minimal time slice elapsed
+        uint64_t tmp_dt = tstamp - v.lts[i];
+        if (tmp_dt < v.dtmin[i]) {
+            v.dco[i] = 0;
+            return;
+        }
+
+        // Update lts
+        v.lts[i] = tstamp;
+
+        // Manual mode, the position tracks the Tieback
+        if (v.man_on[i]) {
+            float tmp_co = v.tb[i];
+            v.lco[i] = (tmp_co < v.coll[i]) ? v.coll[i] : (tmp_co > v.cohl[i]) ? v.cohl[i] : tmp_co;
+            v.dco[i] = 0;
+            v.lman_on[i] = 1;
+            return;
+        }
+
+        float tmp_err = v.sp[i] - v.pv[i];
+
+        // Bumpless, no P and D kick on the first step back from Manual mode
+        if (v.lman_on[i]) {
+            v.lman_on[i] = 0;
+            v.lerr[i] = tmp_err;
+            v.ld[i] = 0;
+        }
+
+        // Deadband, no increment
+        if (v.db_on[i] && tmp_err < v.db[i]) {
+            v.lerr[i] = tmp_err;
+            v.dco[i] = 0;
+            return;
+        }
+
+        // Increments of the P and D terms and the I term itself
+        float derr = tmp_err - v.lerr[i];
+        float d_term = v.kd[i] * derr / (float)tmp_dt;
+        float delta = v.kp[i] * derr;
+        delta += d_term - v.ld[i];
+        delta += v.ki[i] * tmp_err * (float)tmp_dt;
+        v.lerr[i] = tmp_err;
+        v.ld[i] = d_term;
+
+        // The clamped position is the anti-windup
+        float pos = v.lco[i] + delta;
+        pos = (pos < v.coll[i]) ? v.coll[i] : (pos > v.cohl[i]) ? v.cohl[i] : pos;
+        v.dco[i] = pos - v.lco[i];
+        v.lco[i] = pos;
+    };
+
+        /// @brief Step velocity-form loops [first, last) one by one, every loop follows basic_vpid::run_pid
+        /// @param v      - Bank columns
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first loop number
+        /// @param last   - The loop number after the last one
+    void pid_vkernel_scalar(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            pid_vloop_step(v, tstamp, i);
+        }
+    };
+
+#ifdef PID_KERNELS_X86
+
+    // Take the low 32 bits of two vectors of two 64-bit lanes, result is four 32-bit lanes
+    __attribute__((target("sse4.2")))
+    static inline __m128i pack_lo32_sse42(__m128i a, __m128i b) {
+        return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+
+    // Load four mode flags as four 32-bit lanes
+    __attribute__((target("sse4.2")))
+    static inline __m128i load_flags_sse42(const uint8_t* p) {
+        int32_t raw;
+        std::memcpy(&raw, p, sizeof(raw));
+        return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(raw));
+    }
+
+    // Clamp against the CO limits with the same NaN behaviour as the scalar ternary
+    __attribute__((target("sse4.2")))
+    static inline __m128 clamp_sse42(__m128 x, __m128 ll, __m128 hl) {
+        __m128 r = _mm_blendv_ps(x, hl, _mm_cmpgt_ps(x, hl));
+        return _mm_blendv_ps(r, ll, _mm_cmplt_ps(x, ll));
+    }
+
+        /// @brief Step loops [first, last) 4 lanes at a time, the tail is done by the scalar kernel
+        /// @param v      - Bank columns
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first loop number
+        /// @param last   - The loop number after the last one
+    __attribute__((target("sse4.2")))
+    void pid_kernel_sse42(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        const __m128i ts = _mm_set1_epi64x((long long)tstamp);
+        const __m128i bias = _mm_set1_epi64x((long long)0x8000000000000000ULL);
+        const __m128i hi33 = _mm_set1_epi64x((long long)0xFFFFFFFF80000000ULL);
+        const __m128i ones = _mm_set1_epi32(-1);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        size_t i = first;
+        for (; i + 4 <= last; i += 4) {
+            // dt and the dtmin early-out, unsigned 64-bit compare through the sign bias
+            __m128i lts0 = _mm_loadu_si128((const __m128i*)(v.lts + i));
+            __m128i lts1 = _mm_loadu_si128((const __m128i*)(v.lts + i + 2));
+            __m128i dt0 = _mm_sub_epi64(ts, lts0);
+            __m128i dt1 = _mm_sub_epi64(ts, lts1);
+            __m128i lt0 = _mm_cmpgt_epi64(
+                _mm_xor_si128(_mm_loadu_si128((const __m128i*)(v.dtmin + i)), bias),
+                _mm_xor_si128(dt0, bias));
+            __m128i lt1 = _mm_cmpgt_epi64(
+                _mm_xor_si128(_mm_loadu_si128((const __m128i*)(v.dtmin + i + 2)), bias),
+                _mm_xor_si128(dt1, bias));
+            _mm_storeu_si128((__m128i*)(v.lts + i), _mm_blendv_epi8(ts, lts0, lt0));
+            _mm_storeu_si128((__m128i*)(v.lts + i + 2), _mm_blendv_epi8(ts, lts1, lt1));
+            __m128 due = _mm_castsi128_ps(_mm_xor_si128(pack_lo32_sse42(lt0, lt1), ones));
+
+            __m128 lco = _mm_loadu_ps(v.lco + i);
+            if (_mm_movemask_ps(due) == 0) {
+                _mm_storeu_ps(v.co + i, lco);
+                continue;
+            }
+
+            // dt as float, exact for dt < 2^31, otherwise let the compiler convert lane by lane
+            __m128 fdt;
+            if (_mm_testz_si128(_mm_or_si128(dt0, dt1), hi33)) {
+                fdt = _mm_cvtepi32_ps(pack_lo32_sse42(dt0, dt1));
+            }
+            else {
+                alignas(16) uint64_t udt[4];
+                alignas(16) float sdt[4];
+                _mm_store_si128((__m128i*)udt, dt0);
+                _mm_store_si128((__m128i*)(udt + 2), dt1);
+                for (int k = 0; k < 4; k++) {
+                    sdt[k] = (float)udt[k];
+                }
+                fdt = _mm_load_ps(sdt);
+            }
+
+            // Mode flags
+            __m128i zi = _mm_setzero_si128();
+            __m128 man_on = _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(load_flags_sse42(v.man_on + i), zi), ones));
+            __m128 db_on = _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(load_flags_sse42(v.db_on + i), zi), ones));
+            __m128 lman_on = _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(load_flags_sse42(v.lman_on + i), zi), ones));
+
+            __m128 coll = _mm_loadu_ps(v.coll + i);
+            __m128 cohl = _mm_loadu_ps(v.cohl + i);
+            __m128 man = _mm_and_ps(due, man_on);
+            __m128 aut = _mm_andnot_ps(man_on, due);
+
+            // Manual mode, Tieback drives CO
+            lco = _mm_blendv_ps(lco, clamp_sse42(_mm_loadu_ps(v.tb + i), coll, cohl), man);
+
+            // lman_on becomes man_on on every due lane
+            __m128i nlm = _mm_and_si128(_mm_castps_si128(_mm_blendv_ps(lman_on, man_on, due)), _mm_set1_epi32(1));
+            nlm = _mm_packs_epi32(nlm, nlm);
+            int32_t raw = _mm_cvtsi128_si32(_mm_packus_epi16(nlm, nlm));
+            std::memcpy(v.lman_on + i, &raw, sizeof(raw));
+
+            // Bumpless transfer
+            __m128 iterm = _mm_loadu_ps(v.Iterm + i);
+            iterm = _mm_blendv_ps(iterm, lco, _mm_and_ps(aut, lman_on));
+
+            // Error and Deadband skip
+            __m128 err = _mm_sub_ps(_mm_loadu_ps(v.sp + i), _mm_loadu_ps(v.pv + i));
+            __m128 dbs = _mm_and_ps(_mm_and_ps(aut, db_on), _mm_cmplt_ps(err, _mm_loadu_ps(v.db + i)));
+            __m128 calc = _mm_andnot_ps(dbs, aut);
+            __m128 lerr = _mm_loadu_ps(v.lerr + i);
+            _mm_storeu_ps(v.lerr + i, _mm_blendv_ps(lerr, err, aut));
+
+            if (_mm_movemask_ps(calc) != 0) {
+                // Proportional kick and Dterm, dt of the skipped lanes is replaced by 1
+                __m128 sdt = _mm_blendv_ps(one, fdt, calc);
+                __m128 tco = _mm_mul_ps(_mm_loadu_ps(v.kp + i), err);
+                tco = _mm_add_ps(tco, _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(v.kd + i), _mm_sub_ps(err, lerr)), sdt));
+
+                // Iterm with anti-windup
+                __m128 ki = _mm_loadu_ps(v.ki + i);
+                __m128 kiz = _mm_cmpeq_ps(ki, zero);
+                iterm = _mm_blendv_ps(iterm, zero, _mm_and_ps(calc, kiz));
+                __m128 d_iterm = _mm_mul_ps(_mm_mul_ps(ki, err), sdt);
+                __m128 tci = _mm_add_ps(tco, iterm);
+                __m128 hold = _mm_or_ps(
+                    _mm_and_ps(_mm_cmpgt_ps(tci, cohl), _mm_cmpgt_ps(d_iterm, zero)),
+                    _mm_and_ps(_mm_cmplt_ps(tci, coll), _mm_cmplt_ps(d_iterm, zero)));
+                __m128 integ = _mm_andnot_ps(hold, _mm_andnot_ps(kiz, calc));
+                tci = _mm_blendv_ps(tci, _mm_add_ps(tci, d_iterm), integ);
+                iterm = _mm_blendv_ps(iterm, _mm_add_ps(iterm, d_iterm), integ);
+                tco = _mm_blendv_ps(tci, tco, kiz);
+
+                lco = _mm_blendv_ps(lco, clamp_sse42(tco, coll, cohl), calc);
+            }
+            _mm_storeu_ps(v.Iterm + i, iterm);
+            _mm_storeu_ps(v.lco + i, lco);
+            _mm_storeu_ps(v.co + i, lco);
+        }
+        pid_kernel_scalar(v, tstamp, i, last);
+    };
+
+    // Take the low 32 bits of two vectors of four 64-bit lanes, result is eight 32-bit lanes
+    __attribute__((target("avx2")))
+    static inline __m256i pack_lo32_avx2(__m256i a, __m256i b) {
+        const __m256i idx = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+        a = _mm256_permutevar8x32_epi32(a, idx);
+        b = _mm256_permutevar8x32_epi32(b, idx);
+        return _mm256_permute2x128_si256(a, b, 0x20);
+    }
+
+    // Clamp against the CO limits with the same NaN behaviour as the scalar ternary
+    __attribute__((target("avx2")))
+    static inline __m256 clamp_avx2(__m256 x, __m256 ll, __m256 hl) {
+        __m256 r = _mm256_blendv_ps(x, hl, _mm256_cmp_ps(x, hl, _CMP_GT_OQ));
+        return _mm256_blendv_ps(r, ll, _mm256_cmp_ps(x, ll, _CMP_LT_OQ));
+    }
+
+        /// @brief Step loops [first, last) 8 lanes at a time, the tail is done by the scalar kernel
+        /// @param v      - Bank columns
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first loop number
+        /// @param last   - The loop number after the last one
+    __attribute__((target("avx2")))
+    void pid_kernel_avx2(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        const __m256i ts = _mm256_set1_epi64x((long long)tstamp);
+        const __m256i bias = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+        const __m256i hi33 = _mm256_set1_epi64x((long long)0xFFFFFFFF80000000ULL);
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+
+        size_t i = first;
+        for (; i + 8 <= last; i += 8) {
+            // dt and the dtmin early-out, unsigned 64-bit compare through the sign bias
+            __m256i lts0 = _mm256_loadu_si256((const __m256i*)(v.lts + i));
+            __m256i lts1 = _mm256_loadu_si256((const __m256i*)(v.lts + i + 4));
+            __m256i dt0 = _mm256_sub_epi64(ts, lts0);
+            __m256i dt1 = _mm256_sub_epi64(ts, lts1);
+            __m256i lt0 = _mm256_cmpgt_epi64(
+                _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(v.dtmin + i)), bias),
+                _mm256_xor_si256(dt0, bias));
+            __m256i lt1 = _mm256_cmpgt_epi64(
+                _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(v.dtmin + i + 4)), bias),
+                _mm256_xor_si256(dt1, bias));
+            _mm256_storeu_si256((__m256i*)(v.lts + i), _mm256_blendv_epi8(ts, lts0, lt0));
+            _mm256_storeu_si256((__m256i*)(v.lts + i + 4), _mm256_blendv_epi8(ts, lts1, lt1));
+            __m256 due = _mm256_castsi256_ps(_mm256_xor_si256(pack_lo32_avx2(lt0, lt1),
+                                                              _mm256_set1_epi32(-1)));
+
+            __m256 lco = _mm256_loadu_ps(v.lco + i);
+            if (_mm256_testz_ps(due, due)) {
+                _mm256_storeu_ps(v.co + i, lco);
+                continue;
+            }
+
+            // dt as float, exact for dt < 2^31, otherwise let the compiler convert lane by lane
+            __m256 fdt;
+            if (_mm256_testz_si256(_mm256_or_si256(dt0, dt1), hi33)) {
+                fdt = _mm256_cvtepi32_ps(pack_lo32_avx2(dt0, dt1));
+            }
+            else {
+                alignas(32) uint64_t udt[8];
+                alignas(32) float sdt[8];
+                _mm256_store_si256((__m256i*)udt, dt0);
+                _mm256_store_si256((__m256i*)(udt + 4), dt1);
+                for (int k = 0; k < 8; k++) {
+                    sdt[k] = (float)udt[k];
+                }
+                fdt = _mm256_load_ps(sdt);
+            }
+
+            // Mode flags
+            __m256i zi = _mm256_setzero_si256();
+            __m256 man_on = _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(
+                _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(v.man_on + i))), zi),
+                _mm256_set1_epi32(-1)));
+            __m256 db_on = _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(
+                _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(v.db_on + i))), zi),
+                _mm256_set1_epi32(-1)));
+            __m256i lman_raw = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(v.lman_on + i)));
+            __m256 lman_on = _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(lman_raw, zi),
+                _mm256_set1_epi32(-1)));
+
+            __m256 coll = _mm256_loadu_ps(v.coll + i);
+            __m256 cohl = _mm256_loadu_ps(v.cohl + i);
+            __m256 man = _mm256_and_ps(due, man_on);
+            __m256 aut = _mm256_andnot_ps(man_on, due);
+
+            // Manual mode, Tieback drives CO
+            lco = _mm256_blendv_ps(lco, clamp_avx2(_mm256_loadu_ps(v.tb + i), coll, cohl), man);
+
+            // lman_on becomes man_on on every due lane
+            __m256 nlman = _mm256_blendv_ps(lman_on, man_on, due);
+            __m256i nlm = _mm256_and_si256(_mm256_castps_si256(nlman), _mm256_set1_epi32(1));
+            __m128i nlm16 = _mm_packs_epi32(_mm256_castsi256_si128(nlm), _mm256_extracti128_si256(nlm, 1));
+            _mm_storel_epi64((__m128i*)(v.lman_on + i), _mm_packus_epi16(nlm16, nlm16));
+
+            // Bumpless transfer
+            __m256 iterm = _mm256_loadu_ps(v.Iterm + i);
+            iterm = _mm256_blendv_ps(iterm, lco, _mm256_and_ps(aut, lman_on));
+
+            // Error and Deadband skip
+            __m256 err = _mm256_sub_ps(_mm256_loadu_ps(v.sp + i), _mm256_loadu_ps(v.pv + i));
+            __m256 dbs = _mm256_and_ps(_mm256_and_ps(aut, db_on),
+                                       _mm256_cmp_ps(err, _mm256_loadu_ps(v.db + i), _CMP_LT_OQ));
+            __m256 calc = _mm256_andnot_ps(dbs, aut);
+            __m256 lerr = _mm256_loadu_ps(v.lerr + i);
+            _mm256_storeu_ps(v.lerr + i, _mm256_blendv_ps(lerr, err, aut));
+
+            if (!_mm256_testz_ps(calc, calc)) {
+                // Proportional kick and Dterm, dt of the skipped lanes is replaced by 1
+                __m256 sdt = _mm256_blendv_ps(one, fdt, calc);
+                __m256 tco = _mm256_mul_ps(_mm256_loadu_ps(v.kp + i), err);
+                tco = _mm256_add_ps(tco, _mm256_div_ps(
+                    _mm256_mul_ps(_mm256_loadu_ps(v.kd + i), _mm256_sub_ps(err, lerr)), sdt));
+
+                // Iterm with anti-windup
+                __m256 ki = _mm256_loadu_ps(v.ki + i);
+                __m256 kiz = _mm256_cmp_ps(ki, zero, _CMP_EQ_OQ);
+                iterm = _mm256_blendv_ps(iterm, zero, _mm256_and_ps(calc, kiz));
+                __m256 d_iterm = _mm256_mul_ps(_mm256_mul_ps(ki, err), sdt);
+                __m256 tci = _mm256_add_ps(tco, iterm);
+                __m256 hold = _mm256_or_ps(
+                    _mm256_and_ps(_mm256_cmp_ps(tci, cohl, _CMP_GT_OQ), _mm256_cmp_ps(d_iterm, zero, _CMP_GT_OQ)),
+                    _mm256_and_ps(_mm256_cmp_ps(tci, coll, _CMP_LT_OQ), _mm256_cmp_ps(d_iterm, zero, _CMP_LT_OQ)));
+                __m256 integ = _mm256_andnot_ps(hold, _mm256_andnot_ps(kiz, calc));
+                tci = _mm256_blendv_ps(tci, _mm256_add_ps(tci, d_iterm), integ);
+                iterm = _mm256_blendv_ps(iterm, _mm256_add_ps(iterm, d_iterm), integ);
+                tco = _mm256_blendv_ps(tci, tco, kiz);
+
+                lco = _mm256_blendv_ps(lco, clamp_avx2(tco, coll, cohl), calc);
+            }
+            _mm256_storeu_ps(v.Iterm + i, iterm);
+            _mm256_storeu_ps(v.lco + i, lco);
+            _mm256_storeu_ps(v.co + i, lco);
+        }
+        // Leave the upper halves clean, the scalar tail is SSE code
+        _mm256_zeroupper();
+        pid_kernel_scalar(v, tstamp, i, last);
+    };
+
+    // Clamp against the CO limits with the same NaN behaviour as the scalar ternary
+    __attribute__((target("avx512f")))
+    static inline __m512 clamp_avx512(__m512 x, __m512 ll, __m512 hl) {
+        __m512 r = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, hl, _CMP_GT_OQ), x, hl);
+        return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, ll, _CMP_LT_OQ), r, ll);
+    }
+
+        /// @brief Step loops [first, last) 16 lanes at a time, the tail is done by the scalar kernel
+        /// @param v      - Bank columns
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first loop number
+        /// @param last   - The loop number after the last one
+    __attribute__((target("avx512f,avx512dq")))
+    void pid_kernel_avx512(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        const __m512i ts = _mm512_set1_epi64((long long)tstamp);
+        const __m512 zero = _mm512_setzero_ps();
+        const __m512 one = _mm512_set1_ps(1.0f);
+
+        size_t i = first;
+        for (; i + 16 <= last; i += 16) {
+            // dt and the dtmin early-out
+            __m512i lts0 = _mm512_loadu_si512(v.lts + i);
+            __m512i lts1 = _mm512_loadu_si512(v.lts + i + 8);
+            __m512i dt0 = _mm512_sub_epi64(ts, lts0);
+            __m512i dt1 = _mm512_sub_epi64(ts, lts1);
+            __mmask8 due0 = _mm512_cmp_epu64_mask(dt0, _mm512_loadu_si512(v.dtmin + i), _MM_CMPINT_NLT);
+            __mmask8 due1 = _mm512_cmp_epu64_mask(dt1, _mm512_loadu_si512(v.dtmin + i + 8), _MM_CMPINT_NLT);
+            _mm512_mask_storeu_epi64(v.lts + i, due0, ts);
+            _mm512_mask_storeu_epi64(v.lts + i + 8, due1, ts);
+            __mmask16 due = (__mmask16)(due0 | (due1 << 8));
+
+            __m512 lco = _mm512_loadu_ps(v.lco + i);
+            if (due == 0) {
+                _mm512_storeu_ps(v.co + i, lco);
+                continue;
+            }
+
+            // dt as float, AVX-512DQ converts unsigned 64-bit with the same rounding as the scalar path
+            __m512 fdt = _mm512_insertf32x8(_mm512_castps256_ps512(_mm512_cvtepu64_ps(dt0)),
+                                            _mm512_cvtepu64_ps(dt1), 1);
+
+            // Mode flags
+            __m512i man_raw = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)(v.man_on + i)));
+            __m512i db_raw = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)(v.db_on + i)));
+            __m512i lman_raw = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)(v.lman_on + i)));
+            __mmask16 man_on = _mm512_test_epi32_mask(man_raw, man_raw);
+            __mmask16 db_on = _mm512_test_epi32_mask(db_raw, db_raw);
+            __mmask16 lman_on = _mm512_test_epi32_mask(lman_raw, lman_raw);
+
+            __m512 coll = _mm512_loadu_ps(v.coll + i);
+            __m512 cohl = _mm512_loadu_ps(v.cohl + i);
+            __mmask16 man = due & man_on;
+            __mmask16 aut = due & (__mmask16)~man_on;
+
+            // Manual mode, Tieback drives CO
+            lco = _mm512_mask_mov_ps(lco, man, clamp_avx512(_mm512_loadu_ps(v.tb + i), coll, cohl));
+
+            // lman_on becomes man_on on every due lane
+            __mmask16 nlman = (__mmask16)((lman_on & ~due) | man);
+            _mm_storeu_si128((__m128i*)(v.lman_on + i),
+                             _mm512_cvtepi32_epi8(_mm512_maskz_mov_epi32(nlman, _mm512_set1_epi32(1))));
+
+            // Bumpless transfer
+            __m512 iterm = _mm512_loadu_ps(v.Iterm + i);
+            iterm = _mm512_mask_mov_ps(iterm, aut & lman_on, lco);
+
+            // Error and Deadband skip
+            __m512 err = _mm512_sub_ps(_mm512_loadu_ps(v.sp + i), _mm512_loadu_ps(v.pv + i));
+            __mmask16 dbs = aut & db_on & _mm512_cmp_ps_mask(err, _mm512_loadu_ps(v.db + i), _CMP_LT_OQ);
+            __mmask16 calc = aut & (__mmask16)~dbs;
+            __m512 lerr = _mm512_loadu_ps(v.lerr + i);
+            _mm512_storeu_ps(v.lerr + i, _mm512_mask_mov_ps(lerr, aut, err));
+
+            if (calc != 0) {
+                // Proportional kick and Dterm, dt of the skipped lanes is replaced by 1
+                __m512 sdt = _mm512_mask_mov_ps(one, calc, fdt);
+                __m512 tco = _mm512_mul_ps(_mm512_loadu_ps(v.kp + i), err);
+                tco = _mm512_add_ps(tco, _mm512_div_ps(
+                    _mm512_mul_ps(_mm512_loadu_ps(v.kd + i), _mm512_sub_ps(err, lerr)), sdt));
+
+                // Iterm with anti-windup
+                __m512 ki = _mm512_loadu_ps(v.ki + i);
+                __mmask16 kiz = _mm512_cmp_ps_mask(ki, zero, _CMP_EQ_OQ);
+                iterm = _mm512_mask_mov_ps(iterm, calc & kiz, zero);
+                __m512 d_iterm = _mm512_mul_ps(_mm512_mul_ps(ki, err), sdt);
+                __m512 tci = _mm512_add_ps(tco, iterm);
+                __mmask16 hold =
+                    (_mm512_cmp_ps_mask(tci, cohl, _CMP_GT_OQ) & _mm512_cmp_ps_mask(d_iterm, zero, _CMP_GT_OQ)) |
+                    (_mm512_cmp_ps_mask(tci, coll, _CMP_LT_OQ) & _mm512_cmp_ps_mask(d_iterm, zero, _CMP_LT_OQ));
+                __mmask16 integ = calc & (__mmask16)~kiz & (__mmask16)~hold;
+                tci = _mm512_mask_add_ps(tci, integ, tci, d_iterm);
+                iterm = _mm512_mask_add_ps(iterm, integ, iterm, d_iterm);
+                tco = _mm512_mask_mov_ps(tci, kiz, tco);
+
+                lco = _mm512_mask_mov_ps(lco, calc, clamp_avx512(tco, coll, cohl));
+            }
+            _mm512_storeu_ps(v.Iterm + i, iterm);
+            _mm512_storeu_ps(v.lco + i, lco);
+            _mm512_storeu_ps(v.co + i, lco);
+        }
+        // Leave the upper halves clean, the scalar tail is SSE code
+        _mm256_zeroupper();
+        pid_kernel_scalar(v, tstamp, i, last);
+    };
+
+        /// @brief Step velocity-form loops [first, last) 4 lanes at a time, the tail is done by the scalar kernel
+        /// @param v      - Bank columns
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first loop number
+        /// @param last   - The loop number after the last one
+    __attribute__((target("sse4.2")))
+    void pid_vkernel_sse42(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        const __m128i ts = _mm_set1_epi64x((long long)tstamp);
+        const __m128i bias = _mm_set1_epi64x((long long)0x8000000000000000ULL);
+        const __m128i hi33 = _mm_set1_epi64x((long long)0xFFFFFFFF80000000ULL);
+        const __m128i ones = _mm_set1_epi32(-1);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        size_t i = first;
+        for (; i + 4 <= last; i += 4) {
+            // dt and the dtmin early-out, unsigned 64-bit compare through the sign bias
+            __m128i lts0 = _mm_loadu_si128((const __m128i*)(v.lts + i));
+            __m128i lts1 = _mm_loadu_si128((const __m128i*)(v.lts + i + 2));
+            __m128i dt0 = _mm_sub_epi64(ts, lts0);
+            __m128i dt1 = _mm_sub_epi64(ts, lts1);
+            __m128i lt0 = _mm_cmpgt_epi64(
+                _mm_xor_si128(_mm_loadu_si128((const __m128i*)(v.dtmin + i)), bias),
+                _mm_xor_si128(dt0, bias));
+            __m128i lt1 = _mm_cmpgt_epi64(
+                _mm_xor_si128(_mm_loadu_si128((const __m128i*)(v.dtmin + i + 2)), bias),
+                _mm_xor_si128(dt1, bias));
+            _mm_storeu_si128((__m128i*)(v.lts + i), _mm_blendv_epi8(ts, lts0, lt0));
+            _mm_storeu_si128((__m128i*)(v.lts + i + 2), _mm_blendv_epi8(ts, lts1, lt1));
+            __m128 due = _mm_castsi128_ps(_mm_xor_si128(pack_lo32_sse42(lt0, lt1), ones));
+
+            if (_mm_movemask_ps(due) == 0) {
+                _mm_storeu_ps(v.dco + i, zero);
+                continue;
+            }
+
+            // dt as float, exact for dt < 2^31, otherwise let the compiler convert lane by lane
+            __m128 fdt;
+            if (_mm_testz_si128(_mm_or_si128(dt0, dt1), hi33)) {
+                fdt = _mm_cvtepi32_ps(pack_lo32_sse42(dt0, dt1));
+            }
+            else {
+                alignas(16) uint64_t udt[4];
+                alignas(16) float sdt[4];
+                _mm_store_si128((__m128i*)udt, dt0);
+                _mm_store_si128((__m128i*)(udt + 2), dt1);
+                for (int k = 0; k < 4; k++) {
+                    sdt[k] = (float)udt[k];
+                }
+                fdt = _mm_load_ps(sdt);
+            }
+
+            // Mode flags
+            __m128i zi = _mm_setzero_si128();
+            __m128 man_on = _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(load_flags_sse42(v.man_on + i), zi), ones));
+            __m128 db_on = _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(load_flags_sse42(v.db_on + i), zi), ones));
+            __m128 lman_on = _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(load_flags_sse42(v.lman_on + i), zi), ones));
+
+            __m128 coll = _mm_loadu_ps(v.coll + i);
+            __m128 cohl = _mm_loadu_ps(v.cohl + i);
+            __m128 man = _mm_and_ps(due, man_on);
+            __m128 aut = _mm_andnot_ps(man_on, due);
+
+            // Manual mode, the position tracks the Tieback
+            __m128 lco = _mm_loadu_ps(v.lco + i);
+            lco = _mm_blendv_ps(lco, clamp_sse42(_mm_loadu_ps(v.tb + i), coll, cohl), man);
+
+            // lman_on becomes man_on on every due lane
+            __m128i nlm = _mm_and_si128(_mm_castps_si128(_mm_blendv_ps(lman_on, man_on, due)), _mm_set1_epi32(1));
+            nlm = _mm_packs_epi32(nlm, nlm);
+            int32_t raw = _mm_cvtsi128_si32(_mm_packus_epi16(nlm, nlm));
+            std::memcpy(v.lman_on + i, &raw, sizeof(raw));
+
+            // Bumpless transfer and Deadband skip
+            __m128 err = _mm_sub_ps(_mm_loadu_ps(v.sp + i), _mm_loadu_ps(v.pv + i));
+            __m128 bump = _mm_and_ps(aut, lman_on);
+            __m128 lerr = _mm_blendv_ps(_mm_loadu_ps(v.lerr + i), err, bump);
+            __m128 ld = _mm_blendv_ps(_mm_loadu_ps(v.ld + i), zero, bump);
+            __m128 dbs = _mm_and_ps(_mm_and_ps(aut, db_on), _mm_cmplt_ps(err, _mm_loadu_ps(v.db + i)));
+            __m128 calc = _mm_andnot_ps(dbs, aut);
+            __m128 dco = zero;
+
+            if (_mm_movemask_ps(calc) != 0) {
+                // Increments of the P and D terms and the I term, dt of the skipped lanes is replaced by 1
+                __m128 sdt = _mm_blendv_ps(one, fdt, calc);
+                __m128 derr = _mm_sub_ps(err, lerr);
+                __m128 d_term = _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(v.kd + i), derr), sdt);
+                __m128 delta = _mm_mul_ps(_mm_loadu_ps(v.kp + i), derr);
+                delta = _mm_add_ps(delta, _mm_sub_ps(d_term, ld));
+                delta = _mm_add_ps(delta, _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(v.ki + i), err), sdt));
+
+                // The clamped position is the anti-windup
+                __m128 pos = clamp_sse42(_mm_add_ps(lco, delta), coll, cohl);
+                dco = _mm_and_ps(_mm_sub_ps(pos, lco), calc);
+                ld = _mm_blendv_ps(ld, d_term, calc);
+                lco = _mm_blendv_ps(lco, pos, calc);
+            }
+            _mm_storeu_ps(v.lerr + i, _mm_blendv_ps(lerr, err, aut));
+            _mm_storeu_ps(v.ld + i, ld);
+            _mm_storeu_ps(v.lco + i, lco);
+            _mm_storeu_ps(v.dco + i, dco);
+        }
+        pid_vkernel_scalar(v, tstamp, i, last);
+    };
+
+        /// @brief Step velocity-form loops [first, last) 8 lanes at a time, the tail is done by the scalar kernel
+        /// @param v      - Bank columns
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first loop number
+        /// @param last   - The loop number after the last one
+    __attribute__((target("avx2")))
+    void pid_vkernel_avx2(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        const __m256i ts = _mm256_set1_epi64x((long long)tstamp);
+        const __m256i bias = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+        const __m256i hi33 = _mm256_set1_epi64x((long long)0xFFFFFFFF80000000ULL);
+        const __m256i ones = _mm256_set1_epi32(-1);
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+
+        size_t i = first;
+        for (; i + 8 <= last; i += 8) {
+            // dt and the dtmin early-out, unsigned 64-bit compare through the sign bias
+            __m256i lts0 = _mm256_loadu_si256((const __m256i*)(v.lts + i));
+            __m256i lts1 = _mm256_loadu_si256((const __m256i*)(v.lts + i + 4));
+            __m256i dt0 = _mm256_sub_epi64(ts, lts0);
+            __m256i dt1 = _mm256_sub_epi64(ts, lts1);
+            __m256i lt0 = _mm256_cmpgt_epi64(
+                _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(v.dtmin + i)), bias),
+                _mm256_xor_si256(dt0, bias));
+            __m256i lt1 = _mm256_cmpgt_epi64(
+                _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(v.dtmin + i + 4)), bias),
+                _mm256_xor_si256(dt1, bias));
+            _mm256_storeu_si256((__m256i*)(v.lts + i), _mm256_blendv_epi8(ts, lts0, lt0));
+            _mm256_storeu_si256((__m256i*)(v.lts + i + 4), _mm256_blendv_epi8(ts, lts1, lt1));
+            __m256 due = _mm256_castsi256_ps(_mm256_xor_si256(pack_lo32_avx2(lt0, lt1), ones));
+
+            if (_mm256_testz_ps(due, due)) {
+                _mm256_storeu_ps(v.dco + i, zero);
+                continue;
+            }
+
+            // dt as float, exact for dt < 2^31, otherwise let the compiler convert lane by lane
+            __m256 fdt;
+            if (_mm256_testz_si256(_mm256_or_si256(dt0, dt1), hi33)) {
+                fdt = _mm256_cvtepi32_ps(pack_lo32_avx2(dt0, dt1));
+            }
+            else {
+                alignas(32) uint64_t udt[8];
+                alignas(32) float sdt[8];
+                _mm256_store_si256((__m256i*)udt, dt0);
+                _mm256_store_si256((__m256i*)(udt + 4), dt1);
+                for (int k = 0; k < 8; k++) {
+                    sdt[k] = (float)udt[k];
+                }
+                fdt = _mm256_load_ps(sdt);
+            }
+
+            // Mode flags
+            __m256i zi = _mm256_setzero_si256();
+            __m256 man_on = _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(
+                _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(v.man_on + i))), zi), ones));
+            __m256 db_on = _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(
+                _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(v.db_on + i))), zi), ones));
+            __m256 lman_on = _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(
+                _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(v.lman_on + i))), zi), ones));
+
+            __m256 coll = _mm256_loadu_ps(v.coll + i);
+            __m256 cohl = _mm256_loadu_ps(v.cohl + i);
+            __m256 man = _mm256_and_ps(due, man_on);
+            __m256 aut = _mm256_andnot_ps(man_on, due);
+
+            // Manual mode, the position tracks the Tieback
+            __m256 lco = _mm256_loadu_ps(v.lco + i);
+            lco = _mm256_blendv_ps(lco, clamp_avx2(_mm256_loadu_ps(v.tb + i), coll, cohl), man);
+
+            // lman_on becomes man_on on every due lane
+            __m256i nlm = _mm256_and_si256(_mm256_castps_si256(_mm256_blendv_ps(lman_on, man_on, due)),
+                                           _mm256_set1_epi32(1));
+            __m128i nlm16 = _mm_packs_epi32(_mm256_castsi256_si128(nlm), _mm256_extracti128_si256(nlm, 1));
+            _mm_storel_epi64((__m128i*)(v.lman_on + i), _mm_packus_epi16(nlm16, nlm16));
+
+            // Bumpless transfer and Deadband skip
+            __m256 err = _mm256_sub_ps(_mm256_loadu_ps(v.sp + i), _mm256_loadu_ps(v.pv + i));
+            __m256 bump = _mm256_and_ps(aut, lman_on);
+            __m256 lerr = _mm256_blendv_ps(_mm256_loadu_ps(v.lerr + i), err, bump);
+            __m256 ld = _mm256_blendv_ps(_mm256_loadu_ps(v.ld + i), zero, bump);
+            __m256 dbs = _mm256_and_ps(_mm256_and_ps(aut, db_on),
+                                       _mm256_cmp_ps(err, _mm256_loadu_ps(v.db + i), _CMP_LT_OQ));
+            __m256 calc = _mm256_andnot_ps(dbs, aut);
+            __m256 dco = zero;
+
+            if (!_mm256_testz_ps(calc, calc)) {
+                // Increments of the P and D terms and the I term, dt of the skipped lanes is replaced by 1
+                __m256 sdt = _mm256_blendv_ps(one, fdt, calc);
+                __m256 derr = _mm256_sub_ps(err, lerr);
+                __m256 d_term = _mm256_div_ps(_mm256_mul_ps(_mm256_loadu_ps(v.kd + i), derr), sdt);
+                __m256 delta = _mm256_mul_ps(_mm256_loadu_ps(v.kp + i), derr);
+                delta = _mm256_add_ps(delta, _mm256_sub_ps(d_term, ld));
+                delta = _mm256_add_ps(delta, _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(v.ki + i), err), sdt));
+
+                // The clamped position is the anti-windup
+                __m256 pos = clamp_avx2(_mm256_add_ps(lco, delta), coll, cohl);
+                dco = _mm256_and_ps(_mm256_sub_ps(pos, lco), calc);
+                ld = _mm256_blendv_ps(ld, d_term, calc);
+                lco = _mm256_blendv_ps(lco, pos, calc);
+            }
+            _mm256_storeu_ps(v.lerr + i, _mm256_blendv_ps(lerr, err, aut));
+            _mm256_storeu_ps(v.ld + i, ld);
+            _mm256_storeu_ps(v.lco + i, lco);
+            _mm256_storeu_ps(v.dco + i, dco);
+        }
+        // Leave the upper halves clean, the scalar tail is SSE code
+        _mm256_zeroupper();
+        pid_vkernel_scalar(v, tstamp, i, last);
+    };
+
+        /// @brief Step velocity-form loops [first, last) 16 lanes at a time, the tail is done by the scalar kernel
+        /// @param v      - Bank columns
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first loop number
+        /// @param last   - The loop number after the last one
+    __attribute__((target("avx512f,avx512dq")))
+    void pid_vkernel_avx512(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        const __m512i ts = _mm512_set1_epi64((long long)tstamp);
+        const __m512 zero = _mm512_setzero_ps();
+        const __m512 one = _mm512_set1_ps(1.0f);
+
+        size_t i = first;
+        for (; i + 16 <= last; i += 16) {
+            // dt and the dtmin early-out
+            __m512i lts0 = _mm512_loadu_si512(v.lts + i);
+            __m512i lts1 = _mm512_loadu_si512(v.lts + i + 8);
+            __m512i dt0 = _mm512_sub_epi64(ts, lts0);
+            __m512i dt1 = _mm512_sub_epi64(ts, lts1);
+            __mmask8 due0 = _mm512_cmp_epu64_mask(dt0, _mm512_loadu_si512(v.dtmin + i), _MM_CMPINT_NLT);
+            __mmask8 due1 = _mm512_cmp_epu64_mask(dt1, _mm512_loadu_si512(v.dtmin + i + 8), _MM_CMPINT_NLT);
+            _mm512_mask_storeu_epi64(v.lts + i, due0, ts);
+            _mm512_mask_storeu_epi64(v.lts + i + 8, due1, ts);
+            __mmask16 due = (__mmask16)(due0 | (due1 << 8));
+
+            if (due == 0) {
+                _mm512_storeu_ps(v.dco + i, zero);
+                continue;
+            }
+
+            // dt as float, AVX-512DQ converts unsigned 64-bit with the same rounding as the scalar path
+            __m512 fdt = _mm512_insertf32x8(_mm512_castps256_ps512(_mm512_cvtepu64_ps(dt0)),
+                                            _mm512_cvtepu64_ps(dt1), 1);
+
+            // Mode flags
+            __m512i man_raw = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)(v.man_on + i)));
+            __m512i db_raw = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)(v.db_on + i)));
+            __m512i lman_raw = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)(v.lman_on + i)));
+            __mmask16 man_on = _mm512_test_epi32_mask(man_raw, man_raw);
+            __mmask16 db_on = _mm512_test_epi32_mask(db_raw, db_raw);
+            __mmask16 lman_on = _mm512_test_epi32_mask(lman_raw, lman_raw);
+
+            __m512 coll = _mm512_loadu_ps(v.coll + i);
+            __m512 cohl = _mm512_loadu_ps(v.cohl + i);
+            __mmask16 man = due & man_on;
+            __mmask16 aut = due & (__mmask16)~man_on;
+
+            // Manual mode, the position tracks the Tieback
+            __m512 lco = _mm512_loadu_ps(v.lco + i);
+            lco = _mm512_mask_mov_ps(lco, man, clamp_avx512(_mm512_loadu_ps(v.tb + i), coll, cohl));
+
+            // lman_on becomes man_on on every due lane
+            __mmask16 nlman = (__mmask16)((lman_on & ~due) | man);
+            _mm_storeu_si128((__m128i*)(v.lman_on + i),
+                             _mm512_cvtepi32_epi8(_mm512_maskz_mov_epi32(nlman, _mm512_set1_epi32(1))));
+
+            // Bumpless transfer and Deadband skip
+            __m512 err = _mm512_sub_ps(_mm512_loadu_ps(v.sp + i), _mm512_loadu_ps(v.pv + i));
+            __mmask16 bump = aut & lman_on;
+            __m512 lerr = _mm512_mask_mov_ps(_mm512_loadu_ps(v.lerr + i), bump, err);
+            __m512 ld = _mm512_mask_mov_ps(_mm512_loadu_ps(v.ld + i), bump, zero);
+            __mmask16 dbs = aut & db_on & _mm512_cmp_ps_mask(err, _mm512_loadu_ps(v.db + i), _CMP_LT_OQ);
+            __mmask16 calc = aut & (__mmask16)~dbs;
+            __m512 dco = zero;
+
+            if (calc != 0) {
+                // Increments of the P and D terms and the I term, dt of the skipped lanes is replaced by 1
+                __m512 sdt = _mm512_mask_mov_ps(one, calc, fdt);
+                __m512 derr = _mm512_sub_ps(err, lerr);
+                __m512 d_term = _mm512_div_ps(_mm512_mul_ps(_mm512_loadu_ps(v.kd + i), derr), sdt);
+                __m512 delta = _mm512_mul_ps(_mm512_loadu_ps(v.kp + i), derr);
+                delta = _mm512_add_ps(delta, _mm512_sub_ps(d_term, ld));
+                delta = _mm512_add_ps(delta, _mm512_mul_ps(_mm512_mul_ps(_mm512_loadu_ps(v.ki + i), err), sdt));
+
+                // The clamped position is the anti-windup
+                __m512 pos = clamp_avx512(_mm512_add_ps(lco, delta), coll, cohl);
+                dco = _mm512_maskz_sub_ps(calc, pos, lco);
+                ld = _mm512_mask_mov_ps(ld, calc, d_term);
+                lco = _mm512_mask_mov_ps(lco, calc, pos);
+            }
+            _mm512_storeu_ps(v.lerr + i, _mm512_mask_mov_ps(lerr, aut, err));
+            _mm512_storeu_ps(v.ld + i, ld);
+            _mm512_storeu_ps(v.lco + i, lco);
+            _mm512_storeu_ps(v.dco + i, dco);
+        }
+        // Leave the upper halves clean, the scalar tail is SSE code
+        _mm256_zeroupper();
+        pid_vkernel_scalar(v, tstamp, i, last);
+    };
+
+#else
+
+    // No vector units known on this target, the SIMD entry points run the scalar kernel
+    void pid_kernel_sse42(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        pid_kernel_scalar(v, tstamp, first, last);
+    };
+
+    void pid_kernel_avx2(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        pid_kernel_scalar(v, tstamp, first, last);
+    };
+
+    void pid_kernel_avx512(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        pid_kernel_scalar(v, tstamp, first, last);
+    };
+
+    void pid_vkernel_sse42(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        pid_vkernel_scalar(v, tstamp, first, last);
+    };
+
+    void pid_vkernel_avx2(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        pid_vkernel_scalar(v, tstamp, first, last);
+    };
+
+    void pid_vkernel_avx512(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        pid_vkernel_scalar(v, tstamp, first, last);
+    };
+
+#endif /* PID_KERNELS_X86 */
+
+        /// @brief Check whether this CPU can run a kernel tier
+        /// @param isa - Kernel tier
+        /// @return true if supported
+    bool pid_isa_supported(pid_isa isa) {
+        switch (isa) {
+            case pid_isa::scalar:
+                return true;
+#ifdef PID_KERNELS_X86
+            case pid_isa::sse42:
+                return __builtin_cpu_supports("sse4.2");
+            case pid_isa::avx2:
+                return __builtin_cpu_supports("avx2");
+            case pid_isa::avx512:
+                return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq");
+#endif
+            default:
+                return false;
+        }
+    };
+
+        /// @brief Find the widest kernel tier this CPU supports
+        /// @return Kernel tier
+    pid_isa pid_isa_detect() {
+        const pid_isa order[] = {pid_isa::avx512, pid_isa::avx2, pid_isa::sse42};
+        for (pid_isa isa : order) {
+            if (pid_isa_supported(isa)) {
+                return isa;
+            }
+        }
+        return pid_isa::scalar;
+    };
+
+        /// @brief Kernel tier name, as accepted by the PID_ISA environment variable
+        /// @param isa - Kernel tier
+        /// @return Name
+    const char* pid_isa_name(pid_isa isa) {
+        switch (isa) {
+            case pid_isa::sse42:  return "sse4.2";
+            case pid_isa::avx2:   return "avx2";
+            case pid_isa::avx512: return "avx512";
+            default:              return "scalar";
+        }
+    };
+
+        /// @brief Kernel entry point of a tier
+        /// @param isa - Kernel tier
+        /// @return Kernel function
+    pid_kernel_fn pid_isa_kernel(pid_isa isa) {
+        switch (isa) {
+            case pid_isa::sse42:  return pid_kernel_sse42;
+            case pid_isa::avx2:   return pid_kernel_avx2;
+            case pid_isa::avx512: return pid_kernel_avx512;
+            default:              return pid_kernel_scalar;
+        }
+    };
+
+        /// @brief Velocity-form kernel entry point of a tier
+        /// @param isa - Kernel tier
+        /// @return Kernel function
+    pid_vkernel_fn pid_isa_vkernel(pid_isa isa) {
+        switch (isa) {
+            case pid_isa::sse42:  return pid_vkernel_sse42;
+            case pid_isa::avx2:   return pid_vkernel_avx2;
+            case pid_isa::avx512: return pid_vkernel_avx512;
+            default:              return pid_vkernel_scalar;
+        }
+    };
+
+    // A kernel tier with its entry points, published as a whole
+    struct pid_tier {
+        pid_isa isa;
+        pid_kernel_fn kernel;
+        pid_vkernel_fn vkernel;
+    };
+
+    static const pid_tier pid_tiers[] = {
+        {pid_isa::scalar, pid_kernel_scalar, pid_vkernel_scalar},
+        {pid_isa::sse42,  pid_kernel_sse42,  pid_vkernel_sse42},
+        {pid_isa::avx2,   pid_kernel_avx2,   pid_vkernel_avx2},
+        {pid_isa::avx512, pid_kernel_avx512, pid_vkernel_avx512},
+    };
+
+    // The active tier, nullptr until the first use or pid_isa_force
+    static std::atomic<const pid_tier*> active_tier{nullptr};
+
+        /// @brief Force a kernel tier for every bank, e.g. to benchmark tiers against each other
+        /// @param isa - Kernel tier
+        /// @return 0  - O'k
+        ///         -1 - Error, the CPU does not support the tier, the selection is unchanged
+    int pid_isa_force(pid_isa isa) {
+        if (!pid_isa_supported(isa)) {
+            return -1;
+        }
+        active_tier.store(&pid_tiers[(int)isa], std::memory_order_release);
+        return 0;
+    };
+
+        /// @brief Select the kernel tier at startup: the PID_ISA environment variable
+        ///        ("scalar", "sse4.2", "avx2", "avx512") if set and supported,
+        ///        the widest supported tier otherwise
+        /// @return Tier
+    static const pid_tier* pid_isa_select() {
+        pid_isa isa = pid_isa_detect();
+        const char* env = std::getenv("PID_ISA");
+        if (env != nullptr) {
+            for (const pid_tier& t : pid_tiers) {
+                if (std::strcmp(env, pid_isa_name(t.isa)) == 0 && pid_isa_supported(t.isa)) {
+                    isa = t.isa;
+                }
+            }
+        }
+        return &pid_tiers[(int)isa];
+    };
+
+        /// @brief Install the startup tier on the first use, unless pid_isa_force came first
+        /// @return Active tier
+    static const pid_tier* pid_isa_init() {
+        static const pid_tier* const selected = pid_isa_select();
+        const pid_tier* t = nullptr;
+        if (active_tier.compare_exchange_strong(t, selected, std::memory_order_acq_rel)) {
+            return selected;
+        }
+        return t;
+    };
+
+        /// @brief Active tier, selected on the first use
+        /// @return Tier
+    static inline const pid_tier* pid_isa_tier() {
+        const pid_tier* t = active_tier.load(std::memory_order_acquire);
+        return (t == nullptr) ? pid_isa_init() : t;
+    };
+
+        /// @brief Kernel tier used by pid_kernel_run
+        /// @return Kernel tier
+    pid_isa pid_isa_active() {
+        return pid_isa_tier()->isa;
+    };
+
+        /// @brief Step loops [first, last) with the selected kernel tier
+        /// @param v      - Bank columns
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first loop number
+        /// @param last   - The loop number after the last one
+    void pid_kernel_run(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        pid_isa_tier()->kernel(v, tstamp, first, last);
+    };
+
+        /// @brief Step velocity-form loops [first, last) with the selected kernel tier
+        /// @param v      - Bank columns
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first loop number
+        /// @param last   - The loop number after the last one
+    void pid_vkernel_run(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last) {
+        pid_isa_tier()->vkernel(v, tstamp, first, last);
+    };
@@ -0,0 +1,144 @@
+/**
+ * @file pid_kernels.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the scalar and SIMD kernels that step a PID bank
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ * The scalar kernel runs pid_step, the step of base_pid::run_pid, loop by loop.
+ * Every SIMD kernel follows it lane by lane. The branches become masks:
+ * dtmin early-out, Manual mode with Tieback, bumpless transfer, Deadband skip,
+ * ki == 0 reset and the anti-windup condition are all blended per lane.
+ *
+ * ULP bound: 0. The kernels use the same IEEE operations in the same order as
+ * the scalar path (mul, add, sub, div, no reciprocal estimates and no fused
+ * multiply-add), and the uint64_t to float conversion of dt is exact rounding
+ * in all kernels, so outputs and state are bit-identical to base_pid::run_pid.
+ * This holds as long as the library is built without -ffast-math and with
+ * -ffp-contract=off, otherwise the compiler may fuse the scalar path.
+ *
+ * The pid_vkernel_* kernels step a velocity-form bank the same way, lane by lane
+ * after basic_vpid::run_pid and bit-identical to it.
+ */
+#ifndef _PID_KERNELS_H
+#define _PID_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Raw column pointers of a PID bank, see pid_bank for the meaning of each column
+struct pid_bank_view {
+    // IO
+    const float* pv;
+    const float* sp;
+    const float* tb;
+    float* co;
+
+    // Configuration
+    const float* kp;
+    const float* ki;
+    const float* kd;
+    const float* db;
+    const float* coll;
+    const float* cohl;
+    const uint64_t* dtmin;
+    const uint8_t* db_on;
+    const uint8_t* man_on;
+
+    // Dynamic state
+    uint64_t* lts;
+    uint8_t* lman_on;
+    float* Iterm;
+    float* lerr;
+    float* lco;
+};
+
+/// @brief Raw column pointers of a velocity-form bank, see pid_vbank
+struct pid_vbank_view {
+    // IO
+    const float* pv;
+    const float* sp;
+    const float* tb;
+    float* dco;
+
+    // Configuration
+    const float* kp;
+    const float* ki;
+    const float* kd;
+    const float* db;
+    const float* coll;
+    const float* cohl;
+    const uint64_t* dtmin;
+    const uint8_t* db_on;
+    const uint8_t* man_on;
+
+    // Dynamic state
+    uint64_t* lts;
+    uint8_t* lman_on;
+    float* lerr;
+    float* ld;
+    float* lco;
+};
+
+/// @brief Step loops [first, last) one by one
+void pid_kernel_scalar(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last);
+
+/// @brief Step the loops listed in idx[0..count) one by one
+void pid_kernel_list(const pid_bank_view& v, uint64_t tstamp, const uint32_t* idx, size_t count);
+
+/// @brief Step loops [first, last) 4 lanes at a time, requires SSE4.2
+void pid_kernel_sse42(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last);
+
+/// @brief Step loops [first, last) 8 lanes at a time, requires AVX2
+void pid_kernel_avx2(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last);
+
+/// @brief Step loops [first, last) 16 lanes at a time, requires AVX-512F and AVX-512DQ
+void pid_kernel_avx512(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last);
+
+/// @brief Kernel entry point type
+typedef void (*pid_kernel_fn)(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last);
+
+/// @brief Velocity-form kernels, the same tiers as the positional ones
+void pid_vkernel_scalar(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last);
+void pid_vkernel_sse42(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last);
+void pid_vkernel_avx2(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last);
+void pid_vkernel_avx512(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last);
+
+/// @brief Velocity-form kernel entry point type
+typedef void (*pid_vkernel_fn)(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last);
+
+/// @brief Kernel tiers, from the narrowest to the widest
+enum class pid_isa { scalar, sse42, avx2, avx512 };
+
+/// @brief Check whether this CPU can run a kernel tier
+bool pid_isa_supported(pid_isa isa);
+
+/// @brief Find the widest kernel tier this CPU supports
+pid_isa pid_isa_detect();
+
+/// @brief Kernel tier name
+const char* pid_isa_name(pid_isa isa);
+
+/// @brief Kernel entry point of a tier
+pid_kernel_fn pid_isa_kernel(pid_isa isa);
+
+/// @brief Velocity-form kernel entry point of a tier
+pid_vkernel_fn pid_isa_vkernel(pid_isa isa);
+
+/// @brief Force a kernel tier for pid_kernel_run, -1 if the CPU does not support it
+int pid_isa_force(pid_isa isa);
+
+/// @brief Kernel tier used by pid_kernel_run
+pid_isa pid_isa_active();
+
+/// @brief Step loops [first, last) with the kernel tier selected at startup
+///        (PID_ISA environment variable or the widest supported) or by pid_isa_force
+void pid_kernel_run(const pid_bank_view& v, uint64_t tstamp, size_t first, size_t last);
+
+/// @brief Step velocity-form loops [first, last) with the selected kernel tier
+void pid_vkernel_run(const pid_vbank_view& v, uint64_t tstamp, size_t first, size_t last);
+
+#endif /* _PID_KERNELS_H */
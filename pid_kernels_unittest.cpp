@@ -0,0 +1,143 @@
+#include "pid_bank.hpp"
+#include "pid_kernels.hpp"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Configure two banks the same way, with a mix of every run_pid path
+void configure(pid_bank& a, pid_bank& b, std::mt19937& gen) {
+  std::uniform_real_distribution<float> gain(0, 2);
+  std::uniform_int_distribution<int> coin(0, 3);
+  std::uniform_int_distribution<uint64_t> step(1, 400);
+
+  for (size_t i = 0; i < a.size(); i++) {
+    float kpv = gain(gen), kiv = (coin(gen) == 0) ? 0 : gain(gen) * 100, kdv = gain(gen) * 1.0e-3f;
+    float dbv = gain(gen), collv = -5 - gain(gen), cohlv = 5 + gain(gen);
+    bool db_onv = coin(gen) == 0;
+    uint64_t dtminv = step(gen);
+    a.set_loop(i, kpv, kiv, kdv, dbv, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+               collv, cohlv, db_onv, true, dtminv);
+    b.set_loop(i, kpv, kiv, kdv, dbv, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+               collv, cohlv, db_onv, true, dtminv);
+  }
+}
+
+// Run the scalar kernel and the tested kernel side by side and compare bit patterns
+void compare(pid_kernel_fn kernel, size_t nloops) {
+  std::mt19937 gen(2024);
+  std::uniform_real_distribution<float> val(-10, 10);
+  std::uniform_int_distribution<int> coin(0, 3);
+  std::uniform_int_distribution<uint64_t> step(1, 400);
+
+  pid_bank ref(nloops), tst(nloops);
+  configure(ref, tst, gen);
+
+  // The first step sees a dt of about 2^40, beyond the fast int32 conversion
+  uint64_t tstamp = 1ULL << 40;
+  for (int cycle = 0; cycle < 1000; cycle++) {
+    tstamp += step(gen);
+    for (size_t i = 0; i < nloops; i++) {
+      float pv = val(gen), sp = val(gen), tb = val(gen);
+      // Saturate some loops to exercise anti-windup, and feed some NaNs
+      if (coin(gen) == 0) {
+        sp *= 1000;
+      }
+      if (cycle == 500 && i % 7 == 0) {
+        pv = NAN;
+      }
+      ref.pv_data()[i] = tst.pv_data()[i] = pv;
+      ref.sp_data()[i] = tst.sp_data()[i] = sp;
+      ref.tb_data()[i] = tst.tb_data()[i] = tb;
+      if (cycle % 50 == 0 && coin(gen) == 0) {
+        bool man_sw = coin(gen) == 0;
+        ref.set_man_param(i, man_sw);
+        tst.set_man_param(i, man_sw);
+      }
+    }
+    pid_kernel_scalar(ref.view(), tstamp, 0, nloops);
+    kernel(tst.view(), tstamp, 0, nloops);
+    ASSERT_EQ(std::memcmp(ref.co_data(), tst.co_data(), nloops * sizeof(float)), 0) << "cycle " << cycle;
+  }
+}
+
+// Scalar kernel matches base_pid, see pid_bank.MatchesBasePid, vector kernels match it bit by bit
+TEST(pid_kernels, Sse42MatchesScalar) {
+  if (!pid_isa_supported(pid_isa::sse42)) {
+    GTEST_SKIP() << "SSE4.2 is not supported";
+  }
+  compare(pid_kernel_sse42, 1000);
+  compare(pid_kernel_sse42, 7);
+}
+
+TEST(pid_kernels, Avx2MatchesScalar) {
+  if (!pid_isa_supported(pid_isa::avx2)) {
+    GTEST_SKIP() << "AVX2 is not supported";
+  }
+  compare(pid_kernel_avx2, 1000);
+  compare(pid_kernel_avx2, 13);
+}
+
+TEST(pid_kernels, Avx512MatchesScalar) {
+  if (!pid_isa_supported(pid_isa::avx512)) {
+    GTEST_SKIP() << "AVX-512 is not supported";
+  }
+  compare(pid_kernel_avx512, 1000);
+  compare(pid_kernel_avx512, 21);
+}
+
+// Runtime dispatch
+TEST(pid_kernels, Dispatch) {
+
+  pid_isa best = pid_isa_detect();
+  EXPECT_TRUE(pid_isa_supported(best));
+  EXPECT_TRUE(pid_isa_supported(pid_isa::scalar));
+
+  // Every supported tier can be forced, the bank then runs it
+  const pid_isa all[] = {pid_isa::scalar, pid_isa::sse42, pid_isa::avx2, pid_isa::avx512};
+  for (pid_isa isa : all) {
+    if (pid_isa_supported(isa)) {
+      EXPECT_EQ(pid_isa_force(isa), 0);
+      EXPECT_EQ(pid_isa_active(), isa);
+      EXPECT_EQ(pid_isa_kernel(isa) == pid_kernel_scalar, isa == pid_isa::scalar) << pid_isa_name(isa);
+
+      pid_bank bank(40);
+      bank.tb_data()[33] = 5;
+      EXPECT_EQ(bank.step_all(100), 0);
+      EXPECT_FLOAT_EQ(bank.co_data()[33], 5);
+    }
+    else {
+      EXPECT_EQ(pid_isa_force(isa), -1);
+    }
+  }
+  pid_isa_force(best);
+}
+
+// A tier forced while other threads make their first kernel call is not overwritten
+// by the startup selection
+TEST(pid_kernels, ForceRacesFirstUse) {
+
+  pid_isa best = pid_isa_detect();
+  std::vector<std::thread> th;
+  for (int k = 0; k < 4; k++) {
+    th.emplace_back([] {
+      pid_bank bank(16);
+      for (uint64_t t = 1; t < 200; t++) {
+        bank.step_all(t * 100);
+        (void)pid_isa_active();
+      }
+    });
+  }
+  EXPECT_EQ(pid_isa_force(pid_isa::scalar), 0);
+  for (std::thread& t : th) {
+    t.join();
+  }
+  EXPECT_EQ(pid_isa_active(), pid_isa::scalar);
+  pid_isa_force(best);
+}
+}  // namespace
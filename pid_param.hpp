@@ -0,0 +1,126 @@
+/**
+ * @file pid_param.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Lock-free parameter publishing from a tuning thread to the control thread
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ * The setters of basic_pid and pid_bank write one field at a time and must run on the
+ * control thread. A tuning thread instead publishes a whole pid_params block, and the
+ * control thread applies it between two steps with set_params, so run_pid never sees
+ * a gain set that is half old and half new. Neither side ever waits for the other.
+ */
+#ifndef _PID_PARAM_H
+#define _PID_PARAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "pid.hpp"
+#include "pid_alloc.hpp"
+#include "pid_bank.hpp"
+#include "pid_spsc.hpp"
+
+#define PID_TUNER_DEPTH 1024 // Default number of pending bank updates
+
+/// @brief Triple buffer of a parameter block for one writer and one reader thread.
+///        The writer fills its own buffer and swaps it with the middle one in a single
+///        atomic exchange; the reader swaps the middle one with its own buffer when
+///        the fresh bit is set. Only the latest block is kept.
+template <typename T>
+class pid_param_buffer {
+
+    static constexpr uint8_t fresh = 4;     // Set in mid when the middle buffer is newer than front
+
+    struct alignas(PID_CACHE_LINE) slot {
+        pid_params<T> p;
+    };
+
+    slot buf[3];
+    alignas(PID_CACHE_LINE) std::atomic<uint8_t> mid;  // Index of the middle buffer | fresh
+    alignas(PID_CACHE_LINE) uint8_t back;              // Writer buffer
+    alignas(PID_CACHE_LINE) uint8_t front;             // Reader buffer
+
+    public:
+        pid_param_buffer() : buf{}, mid{1}, back{0}, front{2} {}
+
+        pid_param_buffer(const pid_param_buffer&) = delete;
+        pid_param_buffer& operator=(const pid_param_buffer&) = delete;
+
+        /// @brief Writer, publish a parameter block, a block not yet fetched is replaced
+        void publish(const pid_params<T>& p) {
+            buf[back].p = p;
+            back = mid.exchange(back | fresh, std::memory_order_acq_rel) & 3;
+        }
+
+        /// @brief Reader, take the latest block if one was published since the last fetch
+        /// @return true  - p holds a new block
+        ///         false - Nothing new, p is untouched
+        bool fetch(pid_params<T>& p) {
+            if ((mid.load(std::memory_order_relaxed) & fresh) == 0) {
+                return false;
+            }
+            front = mid.exchange(front, std::memory_order_acq_rel) & 3;
+            p = buf[front].p;
+            return true;
+        }
+
+        /// @brief Reader, apply the latest block to the controller, call it between two run_pid
+        /// @return 0  - O'k, applied or nothing new
+        ///         -1 - Error, the block was rejected by set_params
+        int apply(basic_pid<T>& pid) {
+            pid_params<T> p;
+            if (!fetch(p)) {
+                return 0;
+            }
+            return pid.set_params(p);
+        }
+};
+
+/// @brief One pending parameter block of a bank loop
+struct pid_bank_update {
+    uint32_t loop;              // Loop number
+    pid_params<float> p;        // Parameters
+};
+
+/// @brief Queue of parameter blocks for the loops of a pid_bank, one tuning thread
+///        posts and the control thread applies the queued blocks between two steps.
+///        Unlike pid_param_buffer every block is applied, in order.
+class pid_bank_tuner {
+
+    spsc_ring<pid_bank_update> q;
+    uint64_t nrejected;         // Blocks rejected by set_params, control thread only
+
+    public:
+        explicit pid_bank_tuner(size_t depth = PID_TUNER_DEPTH) : q(depth), nrejected{0} {}
+
+        /// @brief Tuning thread, queue a parameter block for loop i
+        /// @return 0  - O'k
+        ///         -1 - Error, the queue is full
+        int post(size_t i, const pid_params<float>& p) {
+            return q.try_push(pid_bank_update{(uint32_t)i, p}) ? 0 : -1;
+        }
+
+        /// @brief Control thread, apply up to max_updates queued blocks, call it between two steps
+        /// @return Number of blocks taken from the queue
+        size_t apply(pid_bank& bank, size_t max_updates = SIZE_MAX) {
+            size_t k = 0;
+            pid_bank_update u;
+            while (k < max_updates && q.try_pop(u)) {
+                if (bank.set_params(u.loop, u.p) != 0) {
+                    nrejected++;
+                }
+                k++;
+            }
+            return k;
+        }
+
+        /// @brief Blocks rejected by set_params so far, control thread only
+        uint64_t rejected() const { return nrejected; }
+};
+
+#endif /* _PID_PARAM_H */
@@ -0,0 +1,171 @@
+#include "pid_param.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace {
+pid_params<float> block(float k) {
+
+  pid_params<float> p{};
+  p.kp = k;
+  p.ki = k;
+  p.kd = k;
+  p.db = k;
+  p.pvll = -__FLT_MAX__;
+  p.pvhl = __FLT_MAX__;
+  p.spll = -__FLT_MAX__;
+  p.sphl = __FLT_MAX__;
+  p.coll = -k;
+  p.cohl = k;
+  p.dtmin = 10;
+  p.db_on = false;
+  return p;
+}
+
+// A block is applied in full or not at all
+TEST(pid_param, SetParams) {
+
+  float pv{0}, sp{0}, co{0};
+  base_pid pid(&pv, &sp, &co);
+  pid_params<float> p;
+
+  EXPECT_EQ(pid.set_params(block(2)), 0);
+  pid.get_params(p);
+  EXPECT_FLOAT_EQ(p.kp, 2);
+  EXPECT_FLOAT_EQ(p.ki, 2);
+  EXPECT_FLOAT_EQ(p.kd, 2);
+  EXPECT_FLOAT_EQ(p.coll, -2);
+  EXPECT_FLOAT_EQ(p.cohl, 2);
+
+  pid_params<float> bad = block(3);
+  bad.dtmin = 0;
+  EXPECT_EQ(pid.set_params(bad), -1);
+  bad = block(3);
+  bad.coll = 4;
+  EXPECT_EQ(pid.set_params(bad), -1);
+  pid.get_params(p);
+  EXPECT_FLOAT_EQ(p.kp, 2);
+  EXPECT_FLOAT_EQ(p.cohl, 2);
+
+  pid_bank bank(2);
+  EXPECT_EQ(bank.set_params(1, block(5)), 0);
+  EXPECT_EQ(bank.set_params(2, block(5)), -1);
+  EXPECT_EQ(bank.set_params(0, bad), -1);
+  bank.get_params(1, p);
+  EXPECT_FLOAT_EQ(p.kp, 5);
+  EXPECT_FLOAT_EQ(p.ki, 5);
+  EXPECT_FLOAT_EQ(p.kd, 5);
+  EXPECT_EQ(bank.get_params(0, p), 0);
+  EXPECT_FLOAT_EQ(p.kp, 0);
+
+  // The bank, basic_pid and the configuration file share one validator
+  bad = block(3);
+  bad.db = __builtin_nanf("");
+  EXPECT_EQ(pid.set_params(bad), -1);
+  EXPECT_EQ(bank.set_params(0, bad), -1);
+  bad = block(3);
+  bad.ki = __builtin_nanf("");
+  EXPECT_EQ(pid.set_params(bad), -1);
+  EXPECT_EQ(bank.set_params(0, bad), -1);
+  EXPECT_EQ(bank.set_gain_param(0, bad.kp, bad.ki, bad.kd), -1);
+
+  // Out of range loops are rejected by the getters as by the setters
+  float ll, hl;
+  bool on;
+  uint64_t dt;
+  pid_state<float> st;
+  EXPECT_EQ(bank.get_params(2, p), -1);
+  EXPECT_EQ(bank.get_pv_limits(2, ll, hl), -1);
+  EXPECT_EQ(bank.get_sp_limits(2, ll, hl), -1);
+  EXPECT_EQ(bank.get_co_limits(2, ll, hl), -1);
+  EXPECT_EQ(bank.get_gain_param(2, ll, hl, ll), -1);
+  EXPECT_EQ(bank.get_db_param(2, ll, on), -1);
+  EXPECT_EQ(bank.get_man_param(2, on), -1);
+  EXPECT_EQ(bank.set_man_param(2, on), -1);
+  EXPECT_EQ(bank.get_dtmin_param(2, dt), -1);
+  EXPECT_EQ(bank.get_state(2, st), -1);
+}
+
+// The reader gets the latest block once
+TEST(pid_param, Buffer) {
+
+  pid_param_buffer<float> buf;
+  pid_params<float> p;
+
+  EXPECT_FALSE(buf.fetch(p));
+  buf.publish(block(1));
+  buf.publish(block(2));
+  EXPECT_TRUE(buf.fetch(p));
+  EXPECT_FLOAT_EQ(p.kp, 2);
+  EXPECT_FALSE(buf.fetch(p));
+  buf.publish(block(3));
+  EXPECT_TRUE(buf.fetch(p));
+  EXPECT_FLOAT_EQ(p.kp, 3);
+}
+
+// A tuning thread publishes blocks with kp == ki == kd, the control thread never sees a mix
+TEST(pid_param, NoTornGains) {
+
+  float pv{0}, sp{1}, co{0};
+  bool man_sw{false};
+  base_pid pid(&pv, &sp, &co);
+  pid.set_man_param(man_sw);
+  pid.set_params(block(0));
+  pid_param_buffer<float> buf;
+  std::atomic<bool> done{false};
+
+  std::thread tuner([&] {
+    for (int k = 1; k <= 100000; k++) {
+      buf.publish(block((float)k));
+    }
+    done = true;
+  });
+
+  float kpv, kiv, kdv, ll, hl, dbv;
+  bool db_on;
+  uint64_t t = 0;
+  float last = 0;
+  bool torn = false;
+  while (!done.load() && !torn) {
+    EXPECT_EQ(buf.apply(pid), 0);
+    pid.run_pid(t += 10);
+    pid.get_gain_param(kpv, kiv, kdv);
+    pid.get_co_limits(ll, hl);
+    pid.get_db_param(dbv, db_on);
+    // ki and kd go through the usec scaling and back, a torn set differs by 1 / kp or more
+    torn = std::fabs(kiv - kpv) > kpv * 1e-6f || std::fabs(kdv - kpv) > kpv * 1e-6f ||
+           hl != kpv || ll != -kpv || dbv != kpv || kpv < last;
+    last = kpv;
+  }
+  tuner.join();
+  EXPECT_FALSE(torn) << "kp " << kpv << " ki " << kiv << " kd " << kdv << " co hl " << hl;
+  buf.apply(pid);
+  pid.get_gain_param(kpv, kiv, kdv);
+  EXPECT_FLOAT_EQ(kpv, 100000);
+}
+
+// Bank updates are applied in order between steps
+TEST(pid_param, BankTuner) {
+
+  pid_bank bank(4);
+  pid_bank_tuner tuner(4);
+  pid_params<float> p;
+
+  EXPECT_EQ(tuner.post(0, block(1)), 0);
+  EXPECT_EQ(tuner.post(0, block(2)), 0);
+  EXPECT_EQ(tuner.post(3, block(3)), 0);
+  EXPECT_EQ(tuner.post(9, block(4)), 0);
+  EXPECT_EQ(tuner.post(1, block(5)), -1);
+
+  EXPECT_EQ(tuner.apply(bank, 2), 2u);
+  bank.get_params(0, p);
+  EXPECT_FLOAT_EQ(p.kp, 2);
+  EXPECT_EQ(tuner.apply(bank), 2u);
+  bank.get_params(3, p);
+  EXPECT_FLOAT_EQ(p.kp, 3);
+  EXPECT_EQ(tuner.rejected(), 1u);
+  EXPECT_EQ(tuner.apply(bank), 0u);
+}
+}  // namespace
@@ -0,0 +1,256 @@
+/**
+ * @file pid_policy.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Policy-based PID controller with compile-time structure
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ */
+#ifndef _PID_POLICY_H
+#define _PID_POLICY_H
+
+#include <cstdint>
+
+#include "pid.hpp"
+
+/// @brief Terms of the controller, a bit per term
+enum class Terms { P = 1, I = 2, PI = 3, D = 4, PD = 5, ID = 6, PID = 7 };
+
+/// @brief Deadband, when On the deadband is always active
+enum class Deadband { Off, On };
+
+/// @brief Manual mode with Tieback and bumpless transfer back to Auto
+enum class Manual { Off, On };
+
+// Storage of the optional features, the disabled ones are empty bases
+template <typename T, bool On> struct pid_p_part {};
+template <typename T> struct pid_p_part<T, true> {
+    T kp{};         // Proportional Gain
+};
+
+template <typename T, bool On> struct pid_i_part {};
+template <typename T> struct pid_i_part<T, true> {
+    T ki{};         // Integral Gain, see pid_traits for the scaling
+    T Iterm{};      // Integral term
+};
+
+template <typename T, bool On> struct pid_d_part {};
+template <typename T> struct pid_d_part<T, true> {
+    T kd{};         // Differential Gain, see pid_traits for the scaling
+    T lerr{};       // The last calculated Error (sp - pv)
+};
+
+template <typename T, bool On> struct pid_db_part {};
+template <typename T> struct pid_db_part<T, true> {
+    T db{};         // Deadband
+};
+
+template <typename T, bool On> struct pid_man_part {};
+template <typename T> struct pid_man_part<T, true> {
+    T* tb{nullptr};         // Tieback Input, it directly drives the Control Output in Manual mode
+    bool man_on{true};      // Manual Mode On/Off
+    bool lman_on{true};     // The last run Manual Mode On/Off
+};
+
+/// @brief PID controller whose structure is fixed at compile time. It computes the same
+///        outputs as basic_pid<T> configured the same way, but the disabled terms, the
+///        Deadband and the Manual mode, their state and their branches are compiled out.
+///        A fixed PI loop is pid<Terms::PI>.
+///        Inputs are bound by reference, so run_pid has no null pointer checks either.
+///        Iterm stays 0 while ki is 0: set_gain_param resets it when ki becomes 0 and the
+///        bumpless transfer leaves none, so the step has no ki == 0 check.
+template <Terms terms, Deadband deadband = Deadband::Off, Manual manual = Manual::Off, typename T = float>
+class pid :
+    pid_p_part<T, ((int)terms & (int)Terms::P) != 0>,
+    pid_i_part<T, ((int)terms & (int)Terms::I) != 0>,
+    pid_d_part<T, ((int)terms & (int)Terms::D) != 0>,
+    pid_db_part<T, deadband == Deadband::On>,
+    pid_man_part<T, manual == Manual::On> {
+
+    typedef pid_traits<T> traits;
+
+    public:
+        static constexpr bool has_p = ((int)terms & (int)Terms::P) != 0;
+        static constexpr bool has_i = ((int)terms & (int)Terms::I) != 0;
+        static constexpr bool has_d = ((int)terms & (int)Terms::D) != 0;
+        static constexpr bool has_db = deadband == Deadband::On;
+        static constexpr bool has_man = manual == Manual::On;
+
+    protected :
+        T* pv;          // Process variable Input
+        T* sp;          // Setpoint Input
+        T* co;          // Control Output
+
+        T coll;         // Control output low limit
+        T cohl;         // Control output high limit
+        uint64_t dtmin; // Minimum time interval between adjacent PID calculations expressed in us
+
+        uint64_t lts;   // The last calculation timestamp
+        T lco;          // The last calculated Control Output
+
+    public:
+        /// @brief Constructor, gains are 0, CO is not limited, Manual mode is enabled if present
+        /// @param ppv Process variable Input
+        /// @param psp Setpoint Input
+        /// @param pco Control Output
+        pid(T& ppv, T& psp, T& pco) :
+            pv{&ppv}, sp{&psp}, co{&pco},
+            coll{traits::lowest()}, cohl{traits::max()}, dtmin{DT_MIN_PID},
+            lts{0}, lco{} {}
+
+        /// @brief Set Gain parameters, the gains of absent terms must be 0
+        /// @param kpv - Proportional Gain
+        /// @param kiv - Integral Gain
+        /// @param kdv - Differential Gain
+        /// @return 0  - O'k
+        ///         -1 - Error
+        int set_gain_param(T kpv, T kiv, T kdv) {
+            if (!traits::gains_valid(kpv, kiv, kdv) ||
+                (!has_p && kpv != T()) || (!has_i && kiv != T()) || (!has_d && kdv != T())) {
+                return -1;
+            }
+            if constexpr (has_p) {
+                this->kp = kpv;
+            }
+            if constexpr (has_i) {
+                this->ki = traits::ki_set(kiv);
+                if (this->ki == T()) {
+                    this->Iterm = T();
+                }
+            }
+            if constexpr (has_d) {
+                this->kd = traits::kd_set(kdv);
+            }
+            return 0;
+        }
+
+        /// @brief Get Gain parameters, absent terms read as 0
+        void get_gain_param(T& kpv, T& kiv, T& kdv) const {
+            kpv = kiv = kdv = T();
+            if constexpr (has_p) {
+                kpv = this->kp;
+            }
+            if constexpr (has_i) {
+                kiv = traits::ki_get(this->ki);
+            }
+            if constexpr (has_d) {
+                kdv = traits::kd_get(this->kd);
+            }
+        }
+
+        /// @brief Set Control Outputs limits
+        /// @return 0  - O'k
+        ///         -1 - Error, the limits were swapped
+        int set_cp_limits(T ll, T hl) {
+            if (hl < ll) {
+                coll = hl;
+                cohl = ll;
+                return -1;
+            }
+            coll = ll;
+            cohl = hl;
+            return 0;
+        }
+
+        /// @brief Get Control Outputs limits
+        void get_co_limits(T& ll, T& hl) const {
+            ll = coll;
+            hl = cohl;
+        }
+
+        /// @brief Set Time Slice parameter, 1 usec or more
+        /// @return 0  - O'k
+        ///         -1 - Error
+        int set_dtmin_param(uint64_t dtminv) {
+            dtmin = (dtminv == 0) ? 1 : dtminv;
+            return (dtminv == 0) ? -1 : 0;
+        }
+
+        /// @brief Set Deadband, Deadband::On only
+        void set_db_param(T dbv) {
+            static_assert(has_db, "the controller has no Deadband");
+            this->db = dbv;
+        }
+
+        /// @brief Set Manual mode, Manual::On only
+        void set_man_param(bool man_onv) {
+            static_assert(has_man, "the controller has no Manual mode");
+            this->man_on = man_onv;
+        }
+
+        /// @brief Connect the Tieback Input, Manual::On only
+        void set_tieback(T* ptie) {
+            static_assert(has_man, "the controller has no Manual mode");
+            this->tb = ptie;
+        }
+
+        /// @brief Process the PID calculation, same steps as basic_pid<T>::run_pid
+        /// @param tstamp - Time, when the calculation is performed
+        /// @return 0  - O'k
+        int run_pid(uint64_t tstamp) {
+            // Only update CO if no minimal time slice elapsed
+            uint64_t tmp_dt = tstamp - lts;
+            if (tmp_dt < dtmin) {
+                *co = lco;
+                return 0;
+            }
+            lts = tstamp;
+
+            if constexpr (has_man) {
+                // Tieback drives CO if Manual mode is enabled, but CO limits still apply.
+                if (this->man_on) {
+                    T tmp_co = (this->tb == nullptr) ? T() : *this->tb;
+                    lco = (tmp_co < coll) ? coll : (tmp_co > cohl) ? cohl : tmp_co;
+                    *co = lco;
+                    this->lman_on = true;
+                    return 0;
+                }
+                // Run bumpless if we come from Manual mode
+                if (this->lman_on) {
+                    this->lman_on = false;
+                    if constexpr (has_i) {
+                        this->Iterm = (this->ki == T()) ? T() : lco;
+                    }
+                }
+            }
+
+            T tmp_err = *sp - *pv;
+
+            if constexpr (has_db) {
+                // Skip further calculations in the Deadband region
+                if (tmp_err < this->db) {
+                    if constexpr (has_d) {
+                        this->lerr = tmp_err;
+                    }
+                    *co = lco;
+                    return 0;
+                }
+            }
+
+            T tmp_co{};
+            if constexpr (has_p) {
+                tmp_co = this->kp * tmp_err;
+            }
+            if constexpr (has_d) {
+                tmp_co += traits::dterm(this->kd, tmp_err - this->lerr, tmp_dt);
+                this->lerr = tmp_err;
+            }
+            if constexpr (has_i) {
+                // Anti-windup, the Iterm delta is dropped if it drives CO further beyond the limits
+                T d_iterm = traits::iterm(this->ki, tmp_err, tmp_dt);
+                tmp_co += this->Iterm;
+                if (!((tmp_co > cohl && d_iterm > T()) ||
+                    (tmp_co < coll && d_iterm < T()))) {
+                    tmp_co += d_iterm;
+                    this->Iterm += d_iterm;
+                }
+            }
+            lco = (tmp_co < coll) ? coll : (tmp_co > cohl) ? cohl : tmp_co;
+            *co = lco;
+            return 0;
+        }
+    };
+
+#endif /* _PID_POLICY_H */
@@ -0,0 +1,137 @@
+#include "pid_policy.hpp"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <random>
+
+namespace {
+// Disabled features take no storage
+TEST(pid_policy, Layout) {
+
+  // base_pid keeps all but its hot line in its cold block
+  EXPECT_LT(sizeof(pid<Terms::PI>), sizeof(base_pid) + sizeof(pid_cold<float>));
+  EXPECT_LT(sizeof(pid<Terms::PI>), sizeof(pid<Terms::PID, Deadband::On, Manual::On>));
+  EXPECT_LT(sizeof(pid<Terms::P>), sizeof(pid<Terms::PI>));
+}
+
+// Gains of absent terms are rejected
+TEST(pid_policy, Configuration) {
+
+  float tpv{0}, tsp{1}, tco{0};
+  float kpv, kiv, kdv;
+  pid<Terms::PI> pi(tpv, tsp, tco);
+
+  EXPECT_EQ(pi.set_gain_param(1, 2, 3), -1);
+  EXPECT_EQ(pi.set_gain_param(1, 2, 0), 0);
+  pi.get_gain_param(kpv, kiv, kdv);
+  EXPECT_FLOAT_EQ(kpv, 1);
+  EXPECT_FLOAT_EQ(kiv, 2);
+  EXPECT_FLOAT_EQ(kdv, 0);
+
+  EXPECT_EQ(pi.set_cp_limits(1, 0), -1);
+  EXPECT_EQ(pi.set_dtmin_param(0), -1);
+}
+
+// A fixed PI loop follows base_pid bit by bit
+TEST(pid_policy, PiMatchesBasePid) {
+
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<float> val(-10, 10);
+  float kpv{0.7f}, kiv{35.0f}, kdv{0}, ll{-5}, hl{5};
+  bool man_sw{false};
+  float pv{0}, sp{0}, co0{0}, co1{0};
+
+  base_pid ref(&pv, &sp, &co0);
+  ref.set_gain_param(kpv, kiv, kdv);
+  ref.set_cp_limits(ll, hl);
+  ref.set_man_param(man_sw);
+
+  pid<Terms::PI> pi(pv, sp, co1);
+  pi.set_gain_param(kpv, kiv, kdv);
+  pi.set_cp_limits(ll, hl);
+
+  for (uint64_t t = 1; t < 5000; t++) {
+    pv = val(gen);
+    sp = val(gen);
+    ref.run_pid(t * 7);
+    pi.run_pid(t * 7);
+    ASSERT_EQ(std::memcmp(&co0, &co1, sizeof(float)), 0) << "step " << t;
+  }
+}
+
+// The full structure with Deadband and Manual mode follows base_pid bit by bit
+TEST(pid_policy, FullMatchesBasePid) {
+
+  std::mt19937 gen(11);
+  std::uniform_real_distribution<float> val(-10, 10);
+  std::uniform_int_distribution<int> coin(0, 99);
+  float kpv{0.7f}, kiv{35.0f}, kdv{0.002f}, ll{-5}, hl{5}, dbv{0.5f};
+  bool db_on{true};
+  float pv{0}, sp{0}, tb{0}, co0{0}, co1{0};
+
+  base_pid ref(&pv, &sp, &co0, &tb);
+  ref.set_gain_param(kpv, kiv, kdv);
+  ref.set_cp_limits(ll, hl);
+  ref.set_db_param(dbv, db_on);
+
+  pid<Terms::PID, Deadband::On, Manual::On> full(pv, sp, co1);
+  full.set_tieback(&tb);
+  full.set_gain_param(kpv, kiv, kdv);
+  full.set_cp_limits(ll, hl);
+  full.set_db_param(dbv);
+
+  for (uint64_t t = 1; t < 5000; t++) {
+    pv = val(gen);
+    sp = val(gen);
+    tb = val(gen);
+    if (coin(gen) < 3) {
+      bool man_sw = coin(gen) < 50;
+      ref.set_man_param(man_sw);
+      full.set_man_param(man_sw);
+    }
+    ref.run_pid(t * 7);
+    full.run_pid(t * 7);
+    ASSERT_EQ(std::memcmp(&co0, &co1, sizeof(float)), 0) << "step " << t;
+  }
+}
+// With ki == 0 the Manual to Auto transfer leaves no Iterm behind, as in base_pid
+TEST(pid_policy, ZeroKiMatchesBasePid) {
+
+  float kpv{2}, kiv{0}, kdv{0};
+  bool man_on{true}, man_off{false};
+  float pv{0}, sp{1}, tb{5}, co0{0}, co1{0};
+
+  base_pid ref(&pv, &sp, &co0, &tb);
+  ref.set_gain_param(kpv, kiv, kdv);
+
+  pid<Terms::PID, Deadband::Off, Manual::On> full(pv, sp, co1);
+  full.set_tieback(&tb);
+  full.set_gain_param(kpv, kiv, kdv);
+
+  for (uint64_t t = 1; t < 200; t++) {
+    bool man_sw = (t % 50) < 10;
+    ref.set_man_param(man_sw ? man_on : man_off);
+    full.set_man_param(man_sw);
+    ref.run_pid(t * 100);
+    full.run_pid(t * 100);
+    ASSERT_EQ(std::memcmp(&co0, &co1, sizeof(float)), 0) << "step " << t;
+  }
+  EXPECT_FLOAT_EQ(co1, 2);
+}
+
+// Setting ki to 0 drops the accumulated Iterm at once
+TEST(pid_policy, ZeroKiResetsIterm) {
+
+  float pv{0}, sp{1}, co{0};
+  pid<Terms::PI> pi(pv, sp, co);
+  pi.set_gain_param(2, 1000, 0);
+
+  for (uint64_t t = 1; t < 10; t++) {
+    pi.run_pid(t * 100);
+  }
+  EXPECT_GT(co, 2);
+  pi.set_gain_param(2, 0, 0);
+  pi.run_pid(1000);
+  EXPECT_FLOAT_EQ(co, 2);
+}
+}  // namespace
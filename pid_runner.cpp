@@ -0,0 +1,249 @@
+/**
+ * @file pid_runner.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Real-time periodic runner of a controller or a bank
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ */
+
+#include <utility>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+#include "pid_runner.hpp"
+
+#if defined(__linux__)
+    static timespec to_timespec(uint64_t ns) {
+        timespec ts;
+        ts.tv_sec = (time_t)(ns / 1000000000ull);
+        ts.tv_nsec = (long)(ns % 1000000000ull);
+        return ts;
+    };
+
+    /// @brief Touch the stack, so its pages are resident before the first cycle
+    static void prefault_stack() {
+        volatile unsigned char buf[PID_RT_STACK];
+        for (size_t i = 0; i < sizeof(buf); i += 4096) {
+            buf[i] = 0;
+        }
+    };
+#endif
+
+    /// @param stepv - Step function, called with the wake-up time in usec
+    /// @param p     - Period and real-time settings
+    pid_runner::pid_runner(std::function<int(uint64_t)> stepv, const pid_rt_params& p) :
+        step(std::move(stepv)),
+        prm(p),
+        fifo_ok{false},
+        lock_ok{false},
+        pin_ok{false},
+        stop_req{false},
+        thr(),
+        ncycles{0},
+        nmissed{0},
+        nerrors{0}
+        {};
+
+    pid_runner::~pid_runner() {
+        stop();
+    };
+
+        /// @return Time of CLOCK_MONOTONIC, ns
+    uint64_t pid_runner::now_ns() {
+#if defined(__linux__)
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#else
+        return 0;
+#endif
+    };
+
+        /// @brief Apply the real-time settings to the thread running the cycles. A setting
+        ///        the system refuses, e.g. without CAP_SYS_NICE, is left out and run() goes on.
+    void pid_runner::setup() {
+#if defined(__linux__)
+        lock_ok = true;
+        if (prm.lock) {
+            // The lock is process wide and kept, every runner of the process shares one call
+            static const bool locked = mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+            lock_ok = locked;
+            prefault_stack();
+        }
+        pin_ok = true;
+        if (prm.cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(prm.cpu, &set);
+            pin_ok = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+        }
+        fifo_ok = true;
+        if (prm.priority > 0) {
+            sched_param sp{};
+            sp.sched_priority = prm.priority;
+            fifo_ok = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) == 0;
+        }
+#endif
+    };
+
+        /// @brief Run the cycles on the calling thread, the first deadline is one period
+        ///        from now. A stop() made while nothing ran does not stop this run.
+        ///        The scheduling policy and the CPU affinity of the caller are restored
+        ///        when the run returns.
+        /// @param n - Number of cycles, 0 - until stop()
+        /// @return 0  - O'k
+        ///         -1 - Error, no period, no timer or not supported on this system
+    int pid_runner::run(uint64_t n) {
+        stop_req.store(false, std::memory_order_relaxed);
+#if defined(__linux__)
+        int policy;
+        sched_param sp;
+        cpu_set_t set;
+        bool sched_saved = pthread_getschedparam(pthread_self(), &policy, &sp) == 0;
+        bool cpu_saved = pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+        int rc = cycles(n);
+        if (sched_saved && prm.priority > 0) {
+            pthread_setschedparam(pthread_self(), policy, &sp);
+        }
+        if (cpu_saved && prm.cpu >= 0) {
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+        return rc;
+#else
+        return cycles(n);
+#endif
+    };
+
+        /// @brief The cycles of run() and of the runner thread, until n cycles ran or
+        ///        stop() was asked for
+        /// @param n - Number of cycles, 0 - until stop()
+        /// @return 0  - O'k
+        ///         -1 - Error, no period, no timer or not supported on this system
+    int pid_runner::cycles(uint64_t n) {
+#if defined(__linux__)
+        if (prm.period == 0 || !step) {
+            return -1;
+        }
+        setup();
+        const uint64_t period = prm.period * 1000;
+        uint64_t next = now_ns() + period;  // The deadline of the current cycle
+
+        int tfd = -1;
+        if (prm.timerfd) {
+            tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+            itimerspec its;
+            its.it_value = to_timespec(next);
+            its.it_interval = to_timespec(period);
+            if (tfd < 0 || timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, nullptr) != 0) {
+                if (tfd >= 0) {
+                    ::close(tfd);
+                }
+                return -1;
+            }
+        }
+
+        int rc = 0;
+        bool first = true;
+        uint64_t llat = 0;  // Wake-up latency of the previous cycle
+        for (uint64_t k = 0; (n == 0 || k < n) && !stop_req.load(std::memory_order_relaxed); k++) {
+            uint64_t missed = 0;
+            if (tfd >= 0) {
+                uint64_t exp = 0;
+                ssize_t r;
+                while ((r = ::read(tfd, &exp, sizeof(exp))) < 0 && errno == EINTR) {
+                }
+                if (r != (ssize_t)sizeof(exp)) {
+                    rc = -1;
+                    break;
+                }
+                // Expirations beyond the first were deadlines passed during the last step
+                missed = (exp > 1) ? exp - 1 : 0;
+                next += missed * period;
+            }
+            else {
+                timespec ts = to_timespec(next);
+                while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+                }
+            }
+            uint64_t t_wake = now_ns();
+
+            if (step(t_wake / 1000) != 0) {
+                nerrors.store(nerrors.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+            uint64_t t_done = now_ns();
+
+            uint64_t lat = (t_wake > next) ? t_wake - next : 0;
+            wake.record(lat);
+            if (!first) {
+                jit.record((lat > llat) ? lat - llat : llat - lat);
+            }
+            exec.record(t_done - t_wake);
+            first = false;
+            llat = lat;
+
+            // The next deadline on the grid. Once it has passed, the next cycle runs at
+            // once for the latest deadline passed and the ones before it are missed; a
+            // clock_nanosleep runner skips them here, a timerfd one finds them in the
+            // expiration count.
+            next += period;
+            if (tfd < 0 && t_done >= next + period) {
+                uint64_t late = (t_done - next) / period;
+                missed += late;
+                next += late * period;
+            }
+            if (missed != 0) {
+                nmissed.store(nmissed.load(std::memory_order_relaxed) + missed, std::memory_order_relaxed);
+            }
+            ncycles.store(ncycles.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        if (tfd >= 0) {
+            ::close(tfd);
+        }
+        stop_req.store(false, std::memory_order_relaxed);
+        return rc;
+#else
+        (void)n;
+        return -1;
+#endif
+    };
+
+        /// @return 0  - O'k
+        ///         -1 - Error, the runner thread is already running
+    int pid_runner::start() {
+        if (thr.joinable()) {
+            return -1;
+        }
+        // Cleared here, not on the thread, so a stop() right after start() is not lost
+        stop_req.store(false, std::memory_order_relaxed);
+        thr = std::thread([this]() { cycles(0); });
+        return 0;
+    };
+
+    void pid_runner::stop() {
+        stop_req.store(true, std::memory_order_relaxed);
+        if (thr.joinable()) {
+            thr.join();
+        }
+    };
+
+        /// @param s - Snapshot to fill, its vectors are reused
+    void pid_runner::snapshot(pid_runner_snapshot& s) const {
+        s.cycles = ncycles.load(std::memory_order_relaxed);
+        s.missed = nmissed.load(std::memory_order_relaxed);
+        s.errors = nerrors.load(std::memory_order_relaxed);
+        wake.snapshot(s.wakeup);
+        jit.snapshot(s.jitter);
+        exec.snapshot(s.exec);
+    };
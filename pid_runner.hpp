@@ -0,0 +1,126 @@
+/**
+ * @file pid_runner.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the real-time periodic runner of a controller or a bank
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ * The runner wakes up on a grid of absolute CLOCK_MONOTONIC deadlines, one period
+ * apart, either with clock_nanosleep(TIMER_ABSTIME) or by reading a periodic timerfd,
+ * and calls the step with the wake-up time in usec as tstamp. Deadlines never drift:
+ * a late cycle does not push the grid. When a step overruns, the next cycle runs at
+ * once for the latest deadline passed and the deadlines before it are counted as
+ * missed. Per cycle the runner records into HDR histograms
+ *   - wake-up latency, the wake-up time minus the deadline,
+ *   - cycle jitter, the change of the wake-up latency from the previous cycle, that
+ *     is how far the interval between two wake-ups is from a whole number of periods,
+ *   - execution time of the step.
+ * The runner thread is the only writer, snapshot() may be called from any thread.
+ */
+#ifndef _PID_RUNNER_H
+#define _PID_RUNNER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "pid.hpp"
+#include "pid_bank.hpp"
+#include "pid_stats.hpp"
+
+#define PID_RT_STACK 65536  // Bytes of stack touched after mlockall, so the first cycles do not fault
+
+/// @brief Settings of the thread running the cycles. The priority and the CPU apply to
+///        the runner thread of start(), or to the caller of run() until run() returns.
+///        The memory lock is process wide: mlockall is called once per process and the
+///        lock is kept for the life of the process.
+struct pid_rt_params {
+    uint64_t period;    // Period, us
+    int priority;       // SCHED_FIFO priority, 0 - keep the scheduling policy of the thread
+    int cpu;            // CPU the thread is pinned to, -1 - no pinning
+    bool lock;          // Lock the process memory with mlockall
+    bool timerfd;       // Wait on a timerfd instead of clock_nanosleep
+};
+
+/// @brief Copy of the runner statistics
+struct pid_runner_snapshot {
+    uint64_t cycles;            // Steps run
+    uint64_t missed;            // Deadlines skipped because a step overran the period
+    uint64_t errors;            // Steps that returned an error
+    pid_hdr_snapshot wakeup;    // Wake-up latency, ns
+    pid_hdr_snapshot jitter;    // Cycle jitter, ns
+    pid_hdr_snapshot exec;      // Execution time of the step, ns
+};
+
+/// @brief Drives a step function, a controller or a bank at a fixed period
+class pid_runner {
+
+    std::function<int(uint64_t)> step;
+    pid_rt_params prm;
+
+    // Outcome of the real-time settings of the last run
+    bool fifo_ok;
+    bool lock_ok;
+    bool pin_ok;
+
+    std::atomic<bool> stop_req;
+    std::thread thr;
+
+    // Written by the runner thread only
+    std::atomic<uint64_t> ncycles;
+    std::atomic<uint64_t> nmissed;
+    std::atomic<uint64_t> nerrors;
+    pid_hdr wake;
+    pid_hdr jit;
+    pid_hdr exec;
+
+    void setup();
+    int cycles(uint64_t n);
+
+    public:
+        /// @brief Constructor, tstamp of every call of stepv is the wake-up time in usec
+        pid_runner(std::function<int(uint64_t)> stepv, const pid_rt_params& p);
+
+        /// @brief Constructor, runs run_pid of a controller
+        template <typename T>
+        pid_runner(basic_pid<T>& pid, const pid_rt_params& p) :
+            pid_runner([&pid](uint64_t t) { return pid.run_pid(t); }, p) {}
+
+        /// @brief Constructor, runs step_all of a bank
+        pid_runner(pid_bank& bank, const pid_rt_params& p) :
+            pid_runner([&bank](uint64_t t) { return bank.step_all(t); }, p) {}
+
+        /// @brief Destructor, stops the runner thread
+        ~pid_runner();
+
+        pid_runner(const pid_runner&) = delete;
+        pid_runner& operator=(const pid_runner&) = delete;
+
+        /// @brief Run ncycles cycles on the calling thread, 0 - until stop(); the priority
+        ///        and the CPU of the caller are restored on return
+        int run(uint64_t ncycles);
+
+        /// @brief Run on a thread of the runner until stop()
+        int start();
+
+        /// @brief Ask run() to return after the current cycle and join the runner thread
+        void stop();
+
+        /// @brief Any thread, copy the statistics
+        void snapshot(pid_runner_snapshot& s) const;
+
+        /// @brief True if the last run got the SCHED_FIFO priority, the memory lock and
+        ///        the CPU it asked for; a setting not asked for counts as granted
+        bool realtime() const { return fifo_ok; }
+        bool locked() const { return lock_ok; }
+        bool pinned() const { return pin_ok; }
+
+        /// @brief CLOCK_MONOTONIC in ns
+        static uint64_t now_ns();
+};
+
+#endif /* _PID_RUNNER_H */
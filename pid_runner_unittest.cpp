@@ -0,0 +1,149 @@
+#include "pid.hpp"
+#include "pid_bank.hpp"
+#include "pid_runner.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace {
+// Both timers step on the period with the monotonic time in usec as tstamp
+TEST(pid_runner, Period) {
+
+  for (bool tfd : {false, true}) {
+    std::vector<uint64_t> ts;
+    pid_rt_params p{1000, 0, -1, false, tfd};
+    pid_runner r([&ts](uint64_t t) { ts.push_back(t); return 0; }, p);
+    uint64_t t0 = pid_runner::now_ns() / 1000;
+    ASSERT_EQ(r.run(50), 0);
+    uint64_t t1 = pid_runner::now_ns() / 1000;
+    ASSERT_EQ(ts.size(), 50u);
+    EXPECT_LE(ts.back(), t1);
+    // No cycle runs before its deadline on the grid
+    for (size_t k = 0; k < ts.size(); k++) {
+      ASSERT_GE(ts[k], t0 + (k + 1) * 1000) << "cycle " << k;
+    }
+
+    pid_runner_snapshot s;
+    r.snapshot(s);
+    EXPECT_EQ(s.cycles, 50u);
+    EXPECT_EQ(s.errors, 0u);
+    EXPECT_EQ(s.wakeup.total, 50u);
+    EXPECT_EQ(s.jitter.total, 49u);
+    EXPECT_EQ(s.exec.total, 50u);
+    EXPECT_TRUE(r.realtime());
+    EXPECT_TRUE(r.locked());
+    EXPECT_TRUE(r.pinned());
+  }
+
+  // A stop() while nothing runs does not cut the next run short
+  pid_rt_params q{1000, 0, -1, false, false};
+  int k = 0;
+  pid_runner rs([&k](uint64_t) { k++; return 0; }, q);
+  rs.stop();
+  ASSERT_EQ(rs.run(3), 0);
+  EXPECT_EQ(k, 3);
+  rs.stop();
+  ASSERT_EQ(rs.start(), 0);
+  pid_runner_snapshot ss;
+  do {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    rs.snapshot(ss);
+  } while (ss.cycles < 6);
+  rs.stop();
+  EXPECT_GE(k, 6);
+
+  pid_rt_params off{0, 0, -1, false, false};
+  pid_runner r([](uint64_t) { return 0; }, off);
+  EXPECT_EQ(r.run(1), -1);
+}
+
+// A step that overruns skips the deadlines it passed, errors are counted
+TEST(pid_runner, Overrun) {
+
+  for (bool tfd : {false, true}) {
+    int k = 0;
+    pid_rt_params p{2000, 0, -1, false, tfd};
+    pid_runner r([&k](uint64_t) {
+      if (++k == 3) {
+        std::this_thread::sleep_for(std::chrono::microseconds(5000));
+        return -1;
+      }
+      return 0;
+    }, p);
+    ASSERT_EQ(r.run(6), 0);
+    pid_runner_snapshot s;
+    r.snapshot(s);
+    EXPECT_EQ(s.cycles, 6u);
+    // 2 deadlines passed, the cycle of the second runs late
+    EXPECT_GE(s.missed, 1u);
+    EXPECT_GE(s.wakeup.max, 500000u);
+    EXPECT_EQ(s.errors, 1u);
+    EXPECT_GE(s.exec.max, 5000000u);
+  }
+}
+
+// A controller and a bank on the runner thread, with the real-time settings asked for;
+// the system may refuse them, the runner goes on
+TEST(pid_runner, Thread) {
+
+  float pv{0}, sp{1}, co{0};
+  base_pid pid(&pv, &sp, &co, nullptr, 1, 0, 0, 0);
+  bool man_sw{false};
+  pid.set_man_param(man_sw);
+  pid_rt_params p{500, 10, 0, false, true};
+  pid_runner r(pid, p);
+  ASSERT_EQ(r.start(), 0);
+  EXPECT_EQ(r.start(), -1);
+  pid_runner_snapshot s;
+  do {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    r.snapshot(s);
+  } while (s.cycles < 20);
+  r.stop();
+  EXPECT_NE(co, 0);
+  pid_state<float> st;
+  pid.get_state(st);
+  EXPECT_GT(st.lts, 0u);
+  EXPECT_TRUE(r.pinned());
+
+  pid_bank bank(4);
+  for (size_t i = 0; i < 4; i++) {
+    bank.set_loop(i, 1, 0, 0, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                  -10, 10, false, false, 10);
+    bank.sp_data()[i] = 1;
+  }
+  pid_rt_params pb{500, 0, -1, false, false};
+  pid_runner rb(bank, pb);
+  ASSERT_EQ(rb.run(3), 0);
+  EXPECT_FLOAT_EQ(bank.co_data()[3], 1);
+}
+
+// run() gives the caller its scheduling policy and CPU affinity back, the memory lock
+// is taken once for the process
+TEST(pid_runner, RestoresCaller) {
+
+  int policy0, policy1;
+  sched_param sp0, sp1;
+  cpu_set_t set0, set1;
+  ASSERT_EQ(pthread_getschedparam(pthread_self(), &policy0, &sp0), 0);
+  ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(set0), &set0), 0);
+
+  pid_rt_params p{500, 10, 0, true, false};
+  pid_runner r([](uint64_t) { return 0; }, p);
+  ASSERT_EQ(r.run(3), 0);
+  pid_runner r2([](uint64_t) { return 0; }, p);
+  ASSERT_EQ(r2.run(3), 0);
+  EXPECT_EQ(r.locked(), r2.locked());
+
+  ASSERT_EQ(pthread_getschedparam(pthread_self(), &policy1, &sp1), 0);
+  ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(set1), &set1), 0);
+  EXPECT_EQ(policy1, policy0);
+  EXPECT_EQ(sp1.sched_priority, sp0.sched_priority);
+  EXPECT_TRUE(CPU_EQUAL(&set0, &set1));
+}
+}  // namespace
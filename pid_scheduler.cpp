@@ -0,0 +1,97 @@
+/**
+ * @file pid_scheduler.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Timing-wheel scheduler of a PID bank
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ */
+
+#include <algorithm>
+
+#include "pid_scheduler.hpp"
+
+    /// @brief The Constructor builds the wheel for the current state of the bank
+    /// @param pbank   The bank to step, it must outlive the scheduler
+    /// @param tick_us Slot width in usec, usually the period run_tick() is called at, 0 is taken as 1
+    /// @param nslots  Number of slots, rounded up to a power of two
+    pid_scheduler::pid_scheduler(pid_bank& pbank, uint64_t tick_us, size_t nslots) :
+        bank(pbank),
+        tick{std::max<uint64_t>(tick_us, 1)},
+        mask{0},
+        now{0},
+        ndue{0},
+        nvisited{0}
+        {
+        size_t size = 1;
+        while (size < nslots) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        slots.resize(size);
+        run.reserve(bank.size());
+        carry.reserve(bank.size());
+        resync();
+    };
+
+    /// @brief Put loop i into the slot of its due tick, or of the current tick if it is overdue
+    void pid_scheduler::insert(uint32_t i) {
+        uint64_t key = std::max(bank.next_due(i) / tick, now);
+        slots[key & mask].push_back(i);
+    };
+
+    void pid_scheduler::resync() {
+        for (std::vector<uint32_t>& s : slots) {
+            s.clear();
+        }
+        for (size_t i = 0; i < bank.size(); i++) {
+            insert((uint32_t)i);
+        }
+    };
+
+        /// @brief Visit the slots of the ticks since the last call up to tstamp and step
+        ///        the loops whose time slice has elapsed, timestamps must not go back
+        /// @param tstamp - Time, when the calculation is performed
+        /// @return 0  - O'k
+        ///         -1 - Error, tstamp is earlier than the last tick
+    int pid_scheduler::run_tick(uint64_t tstamp) {
+        uint64_t cur = tstamp / tick;
+        if (cur < now) {
+            return -1;
+        }
+        // The slot of the current tick is visited again on the next call within the same
+        // tick, it may hold loops that fall due later in the tick
+        uint64_t first = (cur - now > mask) ? cur - mask : now;
+
+        run.clear();
+        carry.clear();
+        nvisited = 0;
+        for (uint64_t k = first; k <= cur; k++) {
+            std::vector<uint32_t>& s = slots[k & mask];
+            for (uint32_t i : s) {
+                if (bank.next_due(i) <= tstamp) {
+                    run.push_back(i);
+                }
+                else {
+                    carry.push_back(i);
+                }
+            }
+            nvisited += s.size();
+            s.clear();
+        }
+        now = cur;
+
+        bank.step_list(tstamp, run.data(), run.size());
+        ndue = run.size();
+
+        for (uint32_t i : run) {
+            insert(i);
+        }
+        for (uint32_t i : carry) {
+            insert(i);
+        }
+        return 0;
+    };
@@ -0,0 +1,64 @@
+/**
+ * @file pid_scheduler.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the timing-wheel scheduler of a PID bank
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ */
+#ifndef _PID_SCHEDULER_H
+#define _PID_SCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pid_bank.hpp"
+
+#define PID_WHEEL_SLOTS 1024 // Default number of timing wheel slots
+
+/// @brief Steps only the loops of a pid_bank that are due. Every loop sits in the
+///        timing wheel slot of its next due time, lts + dtmin, in units of tick usec,
+///        so run_tick() visits the slots of the elapsed ticks and nothing else.
+///        A loop due further than the wheel span is visited once per turn of the
+///        wheel and put back until it is due.
+///        The outputs are the same as step_all() called with the same timestamps;
+///        loops that are not due keep CO = lco, as step_all() would leave them.
+///        After changing the Time Slice of a loop or reconfiguring it with set_loop(),
+///        call resync().
+class pid_scheduler {
+
+    pid_bank& bank;
+    uint64_t tick;      // Slot width, usec
+    size_t mask;        // Number of slots - 1
+    uint64_t now;       // The tick run_tick() visited last, slots before it are empty
+
+    std::vector<std::vector<uint32_t>> slots;
+    std::vector<uint32_t> run;      // Loops due in the current tick
+    std::vector<uint32_t> carry;    // Loops visited early, put back after the tick
+
+    size_t ndue;        // Loops stepped by the last run_tick()
+    size_t nvisited;    // Loops visited by the last run_tick()
+
+    void insert(uint32_t i);
+
+    public:
+        /// @brief Constructor, schedules every loop of the bank
+        pid_scheduler(pid_bank& pbank, uint64_t tick_us, size_t nslots = PID_WHEEL_SLOTS);
+
+        /// @brief Step the loops due at tstamp
+        int run_tick(uint64_t tstamp);
+
+        /// @brief Rebuild the wheel from the Time Slices and timestamps of the bank
+        void resync();
+
+        /// @brief Loops stepped by the last run_tick()
+        size_t last_due() const { return ndue; }
+
+        /// @brief Loops visited by the last run_tick(), due or not
+        size_t last_visited() const { return nvisited; }
+};
+
+#endif /* _PID_SCHEDULER_H */
@@ -0,0 +1,73 @@
+#include "pid_scheduler.hpp"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <random>
+
+namespace {
+// Loop i runs every 100 usec if i % 10 == 0, otherwise every 1000 to 10000 usec
+void setup(pid_bank& bank) {
+
+  for (size_t i = 0; i < bank.size(); i++) {
+    uint64_t dtmin = (i % 10 == 0) ? 100 : 1000 * (1 + i % 10);
+    bank.set_loop(i, 0.7f, 35.0f, 0.002f, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                  -5, 5, false, false, dtmin);
+    bank.sp_data()[i] = (float)(i % 13) - 6.0f;
+  }
+}
+
+// Mixed rates, jittered ticks, the scheduler matches step_all and visits few loops
+TEST(pid_scheduler, MatchesStepAll) {
+
+  const size_t n = 2000;
+  pid_bank ref(n), bank(n);
+  setup(ref);
+  setup(bank);
+  pid_scheduler sched(bank, 100, 256);
+
+  std::mt19937 gen(9);
+  std::uniform_real_distribution<float> val(-10, 10);
+  std::uniform_int_distribution<uint64_t> jitter(0, 60);
+  size_t visited = 0;
+  for (uint64_t t = 1; t < 2000; t++) {
+    for (size_t i = 0; i < n; i++) {
+      ref.pv_data()[i] = bank.pv_data()[i] = val(gen);
+    }
+    uint64_t tstamp = t * 100 + jitter(gen);
+    ref.step_all(tstamp);
+    EXPECT_EQ(sched.run_tick(tstamp), 0);
+    ASSERT_EQ(std::memcmp(ref.co_data(), bank.co_data(), n * sizeof(float)), 0) << "tick " << t;
+    EXPECT_LE(sched.last_due(), sched.last_visited());
+    visited += sched.last_visited();
+  }
+  // About 10 % of the loops run on every tick, the rest every 10 ticks or slower
+  EXPECT_LT(visited, 2000 * n / 4);
+
+  EXPECT_EQ(sched.run_tick(100), -1);
+}
+
+// A Time Slice change takes effect after resync()
+TEST(pid_scheduler, Resync) {
+
+  pid_bank bank(1);
+  setup(bank);
+  bank.set_loop(0, 1, 0, 0, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                -5, 5, false, false, 10000);
+  pid_scheduler sched(bank, 100);
+
+  sched.run_tick(10000);
+  EXPECT_EQ(sched.last_due(), 1u);
+  sched.run_tick(10100);
+  EXPECT_EQ(sched.last_due(), 0u);
+
+  uint64_t dtminv = 100;
+  bank.set_dtmin_param(0, dtminv);
+  sched.resync();
+  sched.run_tick(10200);
+  EXPECT_EQ(sched.last_due(), 1u);
+
+  // A jump longer than the wheel span visits every slot once
+  sched.run_tick(10000000);
+  EXPECT_EQ(sched.last_due(), 1u);
+}
+}  // namespace
@@ -0,0 +1,107 @@
+/**
+ * @file pid_spsc.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the wait-free single-producer single-consumer ring buffer
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ */
+#ifndef _PID_SPSC_H
+#define _PID_SPSC_H
+
+#include <atomic>
+#include <cstddef>
+
+#include "pid_alloc.hpp"
+
+/// @brief Bounded ring buffer for exactly one producer thread and one consumer thread.
+///        try_push and try_pop never block and never loop, each side owns one index
+///        and keeps a cached copy of the other one, so the shared cache lines are only
+///        touched when the cached copy says the ring looks full or empty.
+template <typename T>
+class spsc_ring {
+
+    pid_vector<T> buf;  // Slots, a power of two
+    size_t mask;        // Number of slots - 1
+
+    // Consumer side
+    alignas(PID_CACHE_LINE) std::atomic<size_t> head;   // The next slot to read
+    size_t tail_seen;                                   // The last tail the consumer read
+
+    // Producer side
+    alignas(PID_CACHE_LINE) std::atomic<size_t> tail;   // The next slot to write
+    size_t head_seen;                                   // The last head the producer read
+
+    public:
+        /// @brief Constructor, the capacity is rounded up to a power of two
+        explicit spsc_ring(size_t capacity) :
+            buf(), mask{0}, head{0}, tail_seen{0}, tail{0}, head_seen{0} {
+            size_t size = 1;
+            while (size < capacity) {
+                size <<= 1;
+            }
+            buf.resize(size);
+            mask = size - 1;
+        }
+
+        spsc_ring(const spsc_ring&) = delete;
+        spsc_ring& operator=(const spsc_ring&) = delete;
+
+        /// @brief Producer, append v
+        /// @return true  - O'k
+        ///         false - The ring is full, v is dropped
+        bool try_push(const T& v) {
+            size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head_seen > mask) {
+                head_seen = head.load(std::memory_order_acquire);
+                if (t - head_seen > mask) {
+                    return false;
+                }
+            }
+            buf[t & mask] = v;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// @brief Consumer, take the oldest entry
+        /// @return true  - O'k
+        ///         false - The ring is empty
+        bool try_pop(T& v) {
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail_seen) {
+                tail_seen = tail.load(std::memory_order_acquire);
+                if (h == tail_seen) {
+                    return false;
+                }
+            }
+            v = buf[h & mask];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// @brief Consumer, take up to count entries
+        /// @return Number of entries taken
+        size_t pop_n(T* v, size_t count) {
+            size_t h = head.load(std::memory_order_relaxed);
+            tail_seen = tail.load(std::memory_order_acquire);
+            size_t k = 0;
+            for (; k < count && h + k != tail_seen; k++) {
+                v[k] = buf[(h + k) & mask];
+            }
+            head.store(h + k, std::memory_order_release);
+            return k;
+        }
+
+        /// @brief Number of entries, exact only when called from one of the two sides
+        ///        while the other side is idle
+        size_t size() const {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+
+        /// @brief Number of slots
+        size_t capacity() const { return mask + 1; }
+};
+
+#endif /* _PID_SPSC_H */
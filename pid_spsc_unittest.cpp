@@ -0,0 +1,59 @@
+#include "pid_spsc.hpp"
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <thread>
+
+namespace {
+// Capacity, full and empty rings
+TEST(spsc_ring, Bounds) {
+
+  spsc_ring<int> q(5);
+  int v;
+
+  EXPECT_EQ(q.capacity(), 8u);
+  EXPECT_FALSE(q.try_pop(v));
+  for (int k = 0; k < 8; k++) {
+    EXPECT_TRUE(q.try_push(k));
+  }
+  EXPECT_FALSE(q.try_push(8));
+  EXPECT_EQ(q.size(), 8u);
+  EXPECT_TRUE(q.try_pop(v));
+  EXPECT_EQ(v, 0);
+  EXPECT_TRUE(q.try_push(8));
+
+  int out[16];
+  EXPECT_EQ(q.pop_n(out, 16), 8u);
+  for (int k = 0; k < 8; k++) {
+    EXPECT_EQ(out[k], k + 1);
+  }
+  EXPECT_EQ(q.size(), 0u);
+}
+
+// One producer and one consumer thread, nothing is lost or reordered
+TEST(spsc_ring, Threads) {
+
+  const uint64_t count = 1000000;
+  spsc_ring<uint64_t> q(64);
+
+  std::thread producer([&] {
+    for (uint64_t k = 0; k < count; k++) {
+      while (!q.try_push(k)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint64_t next = 0, v;
+  while (next < count) {
+    if (q.try_pop(v)) {
+      ASSERT_EQ(v, next);
+      next++;
+    }
+    else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+}
+}  // namespace
@@ -0,0 +1,122 @@
+/**
+ * @file pid_stats.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Per-loop execution-time and jitter histograms
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ */
+
+#include <chrono>
+
+#include "pid_stats.hpp"
+
+    pid_hdr::pid_hdr() : vmax{0} {
+        for (std::atomic<uint64_t>& c : counts) {
+            c.store(0, std::memory_order_relaxed);
+        }
+    };
+
+        /// @brief Shift of the values of bucket b
+    static int bucket_shift(size_t b) {
+        return (b < ((size_t)2 << PID_HDR_SUB_BITS)) ? 0 : (int)(b >> PID_HDR_SUB_BITS) - 1;
+    };
+
+        /// @param b - Bucket
+        /// @return The lowest value of the bucket
+    uint64_t pid_hdr::bucket_low(size_t b) {
+        int shift = bucket_shift(b);
+        return (uint64_t)(b - ((size_t)shift << PID_HDR_SUB_BITS)) << shift;
+    };
+
+        /// @param b - Bucket
+        /// @return The highest value of the bucket
+    uint64_t pid_hdr::bucket_high(size_t b) {
+        return bucket_low(b) + (1ull << bucket_shift(b)) - 1;
+    };
+
+        /// @brief Copy the counts, the writer keeps running
+        /// @param s - Snapshot to fill, its vector is reused
+    void pid_hdr::snapshot(pid_hdr_snapshot& s) const {
+        s.counts.resize(PID_HDR_BUCKETS);
+        s.total = 0;
+        s.max = vmax.load(std::memory_order_relaxed);
+        for (size_t b = 0; b < PID_HDR_BUCKETS; b++) {
+            s.counts[b] = counts[b].load(std::memory_order_relaxed);
+            s.total += s.counts[b];
+        }
+    };
+
+        /// @param pct - Percentile, 0..100
+        /// @return The highest value of the bucket the percentile falls into, no more than
+        ///         the largest value recorded, 0 for an empty histogram
+    uint64_t pid_hdr_snapshot::value_at(double pct) const {
+        if (total == 0) {
+            return 0;
+        }
+        pct = (pct < 0) ? 0 : (pct > 100) ? 100 : pct;
+        uint64_t rank = (uint64_t)(pct / 100.0 * (double)total + 0.5);
+        rank = (rank == 0) ? 1 : (rank > total) ? total : rank;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < counts.size(); b++) {
+            seen += counts[b];
+            if (seen >= rank) {
+                uint64_t v = pid_hdr::bucket_high(b);
+                return (v > max) ? max : v;
+            }
+        }
+        return max;
+    };
+
+        /// @return Mean of the values, 0 for an empty histogram
+    double pid_hdr_snapshot::mean() const {
+        if (total == 0) {
+            return 0;
+        }
+        double sum = 0;
+        for (size_t b = 0; b < counts.size(); b++) {
+            if (counts[b] != 0) {
+                double mid = 0.5 * ((double)pid_hdr::bucket_low(b) + (double)pid_hdr::bucket_high(b));
+                sum += mid * (double)counts[b];
+            }
+        }
+        return sum / (double)total;
+    };
+
+    pid_stats::pid_stats(uint32_t everyv, uint64_t budget_ns) :
+        mask{0},
+        budget{budget_ns},
+        ncalls{0},              // The first call is timed
+        nskips{0},
+        ntimed{0},
+        noverruns{0},
+        late_max{0} {
+        uint64_t every = 1;
+        while (every < everyv) {
+            every <<= 1;
+        }
+        mask = every - 1;
+    };
+
+        /// @brief Copy the statistics, the writer keeps running. The counters and the
+        ///        histograms are copied one by one and may differ by the calls made meanwhile.
+        /// @param s - Snapshot to fill, its vectors are reused
+    void pid_stats::snapshot(pid_stats_snapshot& s) const {
+        s.calls = ncalls.load(std::memory_order_relaxed);
+        s.skips = nskips.load(std::memory_order_relaxed);
+        s.timed = ntimed.load(std::memory_order_relaxed);
+        s.overruns = noverruns.load(std::memory_order_relaxed);
+        lat.snapshot(s.latency);
+        late.snapshot(s.lateness);
+        uint64_t lmax = late_max.load(std::memory_order_relaxed);
+        s.lateness.max = (lmax > s.lateness.max) ? lmax : s.lateness.max;
+    };
+
+        /// @return Time of the steady clock, ns
+    uint64_t pid_stats::now_ns() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
@@ -0,0 +1,169 @@
+/**
+ * @file pid_stats.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the per-loop execution-time and jitter histograms
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ * The control thread is the only writer. Every call of run_pid is counted, so are the
+ * Time Slice skips and the largest lateness, dt - dtmin, of a step; the first step of
+ * a controller, lts still 0, has no previous step and no lateness. One call out of a
+ * power of two is timed with the steady clock: its latency goes to one histogram, a
+ * latency above the budget counts as an overrun, and its lateness goes to a second
+ * histogram. Everything but the counters stays off the calls that are not timed, so
+ * the sampling rate sets the cost. Counters are relaxed atomics with a single writer,
+ * a monitor thread copies them at any time without a lock. Every counter only grows,
+ * so a snapshot is a valid histogram of the values recorded somewhere between its
+ * start and its end.
+ */
+#ifndef _PID_STATS_H
+#define _PID_STATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pid_alloc.hpp"
+
+#define PID_HDR_SUB_BITS 5      // Sub-buckets per power of two are 1 << PID_HDR_SUB_BITS, ~3% resolution
+#define PID_HDR_RANGE_BITS 32   // Largest value told apart, larger ones land in the last bucket
+#define PID_HDR_BUCKETS ((PID_HDR_RANGE_BITS - PID_HDR_SUB_BITS + 1) << PID_HDR_SUB_BITS)
+#define PID_STATS_EVERY 256     // Default, time one call of run_pid out of this many, a power of two
+
+/// @brief Copy of a histogram taken by the monitor thread
+struct pid_hdr_snapshot {
+    std::vector<uint64_t> counts;   // Values per bucket
+    uint64_t total;                 // Sum of counts
+    uint64_t max;                   // The largest value recorded
+
+    /// @brief The value below which pct percent of the values fall, upper edge of its bucket
+    uint64_t value_at(double pct) const;
+
+    /// @brief Mean of the values, bucket midpoints
+    double mean() const;
+};
+
+/// @brief High dynamic range histogram of unsigned values, log-linear buckets:
+///        values below 2 << PID_HDR_SUB_BITS have a bucket each, above that every
+///        power of two is split into 1 << PID_HDR_SUB_BITS buckets
+class pid_hdr {
+
+    std::atomic<uint64_t> counts[PID_HDR_BUCKETS];
+    std::atomic<uint64_t> vmax;
+
+    public:
+        pid_hdr();
+
+        pid_hdr(const pid_hdr&) = delete;
+        pid_hdr& operator=(const pid_hdr&) = delete;
+
+        /// @brief Bucket of a value
+        static size_t bucket(uint64_t v) {
+            const uint64_t top = (1ull << PID_HDR_RANGE_BITS) - 1;
+            v = (v > top) ? top : v;
+            int m = 63 - __builtin_clzll(v | 1);
+            int shift = (m > PID_HDR_SUB_BITS) ? m - PID_HDR_SUB_BITS : 0;
+            return ((size_t)shift << PID_HDR_SUB_BITS) + (size_t)(v >> shift);
+        }
+
+        /// @brief The lowest and the highest value of a bucket
+        static uint64_t bucket_low(size_t b);
+        static uint64_t bucket_high(size_t b);
+
+        /// @brief Writer thread, count a value
+        void record(uint64_t v) {
+            std::atomic<uint64_t>& c = counts[bucket(v)];
+            c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            if (v > vmax.load(std::memory_order_relaxed)) {
+                vmax.store(v, std::memory_order_relaxed);
+            }
+        }
+
+        /// @brief Any thread, copy the counts
+        void snapshot(pid_hdr_snapshot& s) const;
+};
+
+/// @brief Copy of the statistics of a loop taken by the monitor thread
+struct pid_stats_snapshot {
+    uint64_t calls;         // Calls of run_pid
+    uint64_t skips;         // Calls skipped by the Time Slice
+    uint64_t timed;         // Calls timed
+    uint64_t overruns;      // Timed calls longer than the budget
+    pid_hdr_snapshot latency;   // Latency of the timed calls, ns
+    pid_hdr_snapshot lateness;  // dt - dtmin of the timed steps, us, max is of every step
+};
+
+/// @brief Execution-time and jitter statistics of one loop, see basic_pid::set_stats
+class alignas(PID_CACHE_LINE) pid_stats {
+
+    // Writer thread
+    uint64_t mask;      // Time the calls whose number has these bits clear
+    uint64_t budget;    // Latency budget, ns, 0 - no budget
+
+    std::atomic<uint64_t> ncalls;
+    std::atomic<uint64_t> nskips;
+    std::atomic<uint64_t> ntimed;
+    std::atomic<uint64_t> noverruns;
+    std::atomic<uint64_t> late_max;
+    pid_hdr lat;
+    pid_hdr late;
+
+    static void bump(std::atomic<uint64_t>& c) {
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    public:
+        /// @brief Constructor, time one call out of everyv rounded up to a power of two
+        explicit pid_stats(uint32_t everyv = PID_STATS_EVERY, uint64_t budget_ns = 0);
+
+        pid_stats(const pid_stats&) = delete;
+        pid_stats& operator=(const pid_stats&) = delete;
+
+        /// @brief Writer thread, count a call
+        /// @return true if the call is to be timed
+        bool call() {
+            uint64_t c = ncalls.load(std::memory_order_relaxed);
+            ncalls.store(c + 1, std::memory_order_relaxed);
+            return (c & mask) == 0;
+        }
+
+        /// @brief Writer thread, count a call skipped by the Time Slice
+        void skip() { bump(nskips); }
+
+        /// @brief Writer thread, a step that was not timed
+        /// @param lateness - dt - dtmin, us
+        void step(uint64_t lateness) {
+            if (lateness > late_max.load(std::memory_order_relaxed)) {
+                late_max.store(lateness, std::memory_order_relaxed);
+            }
+        }
+
+        /// @brief Writer thread, the latency of a timed call
+        /// @param ns - Latency, ns
+        void timed(uint64_t ns) {
+            bump(ntimed);
+            lat.record(ns);
+            if (budget != 0 && ns > budget) {
+                bump(noverruns);
+            }
+        }
+
+        /// @brief Writer thread, the lateness of a timed step
+        /// @param lateness - dt - dtmin, us
+        void timed_step(uint64_t lateness) { late.record(lateness); }
+
+        /// @brief Writer thread, set the latency budget, ns, 0 - no budget
+        void set_budget(uint64_t budget_ns) { budget = budget_ns; }
+
+        /// @brief Any thread, copy the statistics
+        void snapshot(pid_stats_snapshot& s) const;
+
+        /// @brief The steady clock in ns, the clock of the timed calls
+        static uint64_t now_ns();
+};
+
+#endif /* _PID_STATS_H */
@@ -0,0 +1,182 @@
+#include "pid.hpp"
+#include "pid_stats.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+
+namespace {
+// Buckets cover every value with ~3% resolution, percentiles follow the values
+TEST(pid_stats, Hdr) {
+
+  for (uint64_t v = 0; v < 64; v++) {
+    EXPECT_EQ(pid_hdr::bucket(v), v);
+    EXPECT_EQ(pid_hdr::bucket_low(v), v);
+    EXPECT_EQ(pid_hdr::bucket_high(v), v);
+  }
+  std::mt19937_64 gen(21);
+  for (int k = 0; k < 10000; k++) {
+    uint64_t v = gen() >> (gen() % 32 + 32);
+    size_t b = pid_hdr::bucket(v);
+    ASSERT_LT(b, (size_t)PID_HDR_BUCKETS);
+    ASSERT_LE(pid_hdr::bucket_low(b), v);
+    ASSERT_GE(pid_hdr::bucket_high(b), v);
+    ASSERT_LE((double)(pid_hdr::bucket_high(b) - pid_hdr::bucket_low(b)), (double)v / 32.0);
+  }
+  // Adjacent buckets leave no gap, values out of range go to the last one
+  for (size_t b = 1; b < PID_HDR_BUCKETS; b++) {
+    ASSERT_EQ(pid_hdr::bucket_low(b), pid_hdr::bucket_high(b - 1) + 1);
+  }
+  EXPECT_EQ(pid_hdr::bucket(UINT64_MAX), (size_t)PID_HDR_BUCKETS - 1);
+
+  std::unique_ptr<pid_hdr> h(new pid_hdr());
+  pid_hdr_snapshot s;
+  h->snapshot(s);
+  EXPECT_EQ(s.total, 0u);
+  EXPECT_EQ(s.value_at(50), 0u);
+  for (uint64_t v = 1; v <= 10000; v++) {
+    h->record(v);
+  }
+  h->snapshot(s);
+  EXPECT_EQ(s.total, 10000u);
+  EXPECT_EQ(s.max, 10000u);
+  EXPECT_NEAR((double)s.value_at(50), 5000.0, 5000.0 / 32);
+  EXPECT_NEAR((double)s.value_at(99), 9900.0, 9900.0 / 32);
+  EXPECT_EQ(s.value_at(100), 10000u);
+  EXPECT_EQ(s.value_at(0), 1u);
+  EXPECT_NEAR(s.mean(), 5000.5, 5000.5 / 64);
+}
+
+// A controller counts its steps, skips and lateness, and times one call out of n
+TEST(pid_stats, BasePid) {
+
+  float pv{0}, sp{1}, co{0};
+  uint64_t dtm{1000};
+  bool man_sw{false};
+  base_pid pid(&pv, &sp, &co);
+  pid.set_man_param(man_sw);
+  pid.set_dtmin_param(dtm);
+  std::unique_ptr<pid_stats> st(new pid_stats(4));
+  pid_stats_snapshot s;
+
+  pid.run_pid(1000);
+  pid.set_stats(st.get());
+  // 10 calls: 7 steps late by 0 but one by 50 us, 3 skips. Calls 0, 4 and 8 are
+  // timed, only the first of them is a step.
+  uint64_t t[10] = {2000, 2500, 3050, 4050, 4060, 5050, 6050, 7050, 7999, 8050};
+  for (uint64_t ts : t) {
+    EXPECT_EQ(pid.run_pid(ts), 0);
+  }
+  st->snapshot(s);
+  EXPECT_EQ(s.calls, 10u);
+  EXPECT_EQ(s.skips, 3u);
+  EXPECT_EQ(s.timed, 3u);
+  EXPECT_EQ(s.overruns, 0u);
+  EXPECT_EQ(s.latency.total, 3u);
+  EXPECT_EQ(s.lateness.total, 1u);
+  EXPECT_EQ(s.lateness.value_at(50), 0u);
+  EXPECT_EQ(s.lateness.max, 50u);
+
+  // Every call timed against a budget nothing meets
+  std::unique_ptr<pid_stats> all(new pid_stats(1, 1));
+  pid.set_stats(all.get());
+  for (uint64_t k = 1; k <= 100; k++) {
+    pid.run_pid(8050 + k * 1000);
+  }
+  all->snapshot(s);
+  EXPECT_EQ(s.calls, 100u);
+  EXPECT_EQ(s.timed, 100u);
+  EXPECT_EQ(s.lateness.total, 100u);
+  EXPECT_GT(s.overruns, 0u);
+
+  // A call that fails is not a step, detached statistics stay as they were
+  base_pid down;
+  down.set_stats(all.get());
+  EXPECT_EQ(down.run_pid(1000000), -1);
+  pid.set_stats(nullptr);
+  pid.run_pid(1000000);
+  all->snapshot(s);
+  EXPECT_EQ(s.calls, 101u);
+  EXPECT_EQ(s.skips, 0u);
+  EXPECT_EQ(s.lateness.total, 100u);
+
+  // The sampling rate is rounded up to a power of two
+  std::unique_ptr<pid_stats> odd(new pid_stats(3));
+  pid.set_stats(odd.get());
+  for (uint64_t k = 1; k <= 8; k++) {
+    pid.run_pid(1000000 + k * 1000);
+  }
+  odd->snapshot(s);
+  EXPECT_EQ(s.timed, 2u);
+
+  // Attached before the first step, on a monotonic clock far from 0: the first step
+  // has no previous one and is no lateness
+  base_pid first(&pv, &sp, &co);
+  first.set_man_param(man_sw);
+  first.set_dtmin_param(dtm);
+  std::unique_ptr<pid_stats> fst(new pid_stats(1));
+  first.set_stats(fst.get());
+  EXPECT_EQ(first.run_pid(5000000000ull), 0);
+  EXPECT_EQ(first.run_pid(5000001020ull), 0);
+  fst->snapshot(s);
+  EXPECT_EQ(s.timed, 2u);
+  EXPECT_EQ(s.lateness.total, 1u);
+  EXPECT_EQ(s.lateness.max, 20u);
+
+  std::unique_ptr<pid_stats> fst8(new pid_stats(8));
+  base_pid second(&pv, &sp, &co);
+  second.set_man_param(man_sw);
+  second.set_dtmin_param(dtm);
+  second.set_stats(fst8.get());
+  EXPECT_EQ(second.run_pid(5000000000ull), 0);
+  EXPECT_EQ(second.run_pid(5000001020ull), 0);
+  fst8->snapshot(s);
+  EXPECT_EQ(s.lateness.total, 0u);
+  EXPECT_EQ(s.lateness.max, 20u);
+}
+
+// A monitor thread snapshots while the control thread steps
+TEST(pid_stats, Snapshot) {
+
+  float pv{0}, sp{1}, co{0};
+  bool man_sw{false};
+  base_pid pid(&pv, &sp, &co);
+  pid.set_man_param(man_sw);
+  std::unique_ptr<pid_stats> st(new pid_stats(16));
+  pid.set_stats(st.get());
+  const uint64_t steps = 200000;
+  std::atomic<bool> done{false};
+  std::atomic<bool> ok{true};
+
+  std::thread monitor([&]() {
+    pid_stats_snapshot s;
+    uint64_t last = 0;
+    while (!done.load(std::memory_order_acquire)) {
+      st->snapshot(s);
+      if (s.lateness.total < last || s.lateness.total > steps / 16 || s.calls > steps) {
+        ok.store(false);
+      }
+      last = s.lateness.total;
+      std::this_thread::yield();
+    }
+  });
+  for (uint64_t k = 1; k <= steps; k++) {
+    pv = (float)(k % 7);
+    pid.run_pid(k * 1000 + (k % 3));
+  }
+  done.store(true, std::memory_order_release);
+  monitor.join();
+  EXPECT_TRUE(ok.load());
+
+  pid_stats_snapshot s;
+  st->snapshot(s);
+  EXPECT_EQ(s.calls, steps);
+  EXPECT_EQ(s.skips, 0u);
+  EXPECT_EQ(s.timed, steps / 16);
+  // The first call is timed, but the first step has no lateness
+  EXPECT_EQ(s.lateness.total, steps / 16 - 1);
+  EXPECT_LE(s.lateness.max, 1001u);
+}
+}  // namespace
@@ -0,0 +1,85 @@
+/**
+ * @file pid_telemetry.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the per-step controller telemetry ring
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ * The control thread is the only producer: every step that is not skipped by the
+ * Time Slice pushes one pid_sample, and a full ring drops the sample and counts it
+ * instead of waiting. One reader thread drains the ring at its own pace.
+ */
+#ifndef _PID_TELEMETRY_H
+#define _PID_TELEMETRY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "pid_alloc.hpp"
+#include "pid_spsc.hpp"
+
+#define PID_TLM_DEPTH 4096 // Default number of samples in a telemetry ring
+
+// Flags of a sample
+#define PID_TLM_MANUAL   0x01 // Tieback drove CO
+#define PID_TLM_BUMPLESS 0x02 // First step back from Manual mode, Iterm started from the last CO
+#define PID_TLM_DEADBAND 0x04 // The error was in the Deadband, CO was held
+#define PID_TLM_CO_HIGH  0x08 // CO was clamped at the high limit
+#define PID_TLM_CO_LOW   0x10 // CO was clamped at the low limit
+#define PID_TLM_WINDUP   0x20 // The Iterm delta was dropped by the anti-windup
+#define PID_TLM_DRIFT    0x40 // Fixed-rate mode, dt drifted beyond the tolerance
+#define PID_TLM_CLEAN    0x80 // Change-driven mode, the inputs had not changed, p and d are 0 if CO was held
+
+/// @brief Internals of one controller step
+template <typename T>
+struct pid_sample {
+    uint64_t tstamp;    // Time of the step
+    uint64_t dt;        // Time since the previous step, tmp_dt
+    uint32_t loop;      // Loop number in a bank, 0 for a single controller
+    uint32_t flags;     // PID_TLM_* flags
+    T err;              // sp - pv, 0 in Manual mode
+    T p;                // Proportional contribution
+    T d;                // Differential contribution
+    T di;               // Iterm delta, applied unless PID_TLM_WINDUP is set
+    T iterm;            // Integral term after the step
+    T co;               // Control Output
+};
+
+/// @brief Telemetry ring of one controller or one bank
+template <typename T>
+class pid_telemetry {
+
+    spsc_ring<pid_sample<T>> ring;
+    alignas(PID_CACHE_LINE) std::atomic<uint64_t> ndropped;  // Written by the producer only
+
+    public:
+        explicit pid_telemetry(size_t capacity = PID_TLM_DEPTH) : ring(capacity), ndropped{0} {}
+
+        /// @brief Control thread, append a sample or drop it if the ring is full
+        void push(const pid_sample<T>& s) {
+            if (!ring.try_push(s)) {
+                ndropped.store(ndropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+        }
+
+        /// @brief Reader thread, take the oldest sample
+        /// @return true  - O'k
+        ///         false - The ring is empty
+        bool pop(pid_sample<T>& s) { return ring.try_pop(s); }
+
+        /// @brief Reader thread, take up to count samples
+        /// @return Number of samples taken
+        size_t drain(pid_sample<T>* s, size_t count) { return ring.pop_n(s, count); }
+
+        /// @brief Samples dropped because the ring was full
+        uint64_t dropped() const { return ndropped.load(std::memory_order_relaxed); }
+
+        /// @brief Number of samples the ring holds
+        size_t capacity() const { return ring.capacity(); }
+};
+
+#endif /* _PID_TELEMETRY_H */
@@ -0,0 +1,175 @@
+#include "pid_bank.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+// A single controller reports its internals, flags follow the path taken
+TEST(pid_telemetry, BasePid) {
+
+  float pv{0}, sp{1}, co{0}, tb{5};
+  float kpv{2}, kiv{1000}, kdv{0}, ll{-3}, hl{3};
+  bool man_sw{true};
+  base_pid pid(&pv, &sp, &co, &tb);
+  pid.set_gain_param(kpv, kiv, kdv);
+  pid.set_cp_limits(ll, hl);
+  pid_telemetry<float> tlm(16);
+  pid_sample<float> s;
+
+  pid.run_pid(1000);
+  EXPECT_FALSE(tlm.pop(s));
+  pid.set_telemetry(&tlm);
+
+  // Manual mode, Tieback above the CO limit
+  pid.run_pid(2000);
+  ASSERT_TRUE(tlm.pop(s));
+  EXPECT_EQ(s.tstamp, 2000u);
+  EXPECT_EQ(s.dt, 1000u);
+  EXPECT_EQ(s.flags, (uint32_t)(PID_TLM_MANUAL | PID_TLM_CO_HIGH));
+  EXPECT_FLOAT_EQ(s.co, 3);
+
+  // Skipped by the Time Slice, no sample
+  pid.run_pid(2005);
+  EXPECT_FALSE(tlm.pop(s));
+
+  // Back to Auto, bumpless, Iterm starts from 3 and the PI sum saturates
+  man_sw = false;
+  pid.set_man_param(man_sw);
+  pid.run_pid(3000);
+  ASSERT_TRUE(tlm.pop(s));
+  EXPECT_EQ(s.flags, (uint32_t)(PID_TLM_BUMPLESS | PID_TLM_WINDUP | PID_TLM_CO_HIGH));
+  EXPECT_FLOAT_EQ(s.err, 1);
+  EXPECT_FLOAT_EQ(s.p, 2);
+  EXPECT_FLOAT_EQ(s.d, 0);
+  EXPECT_FLOAT_EQ(s.di, 1);
+  EXPECT_FLOAT_EQ(s.iterm, 3);
+  EXPECT_FLOAT_EQ(s.co, 3);
+
+  // Inside the limits
+  pv = 2;
+  pid.run_pid(4000);
+  ASSERT_TRUE(tlm.pop(s));
+  EXPECT_EQ(s.flags, 0u);
+  EXPECT_FLOAT_EQ(s.p, -2);
+  EXPECT_FLOAT_EQ(s.di, -1);
+  EXPECT_FLOAT_EQ(s.iterm, 2);
+  EXPECT_FLOAT_EQ(s.co, 0);
+
+  // A full ring drops and counts
+  for (uint64_t t = 5000; t < 30000; t += 1000) {
+    pid.run_pid(t);
+  }
+  EXPECT_EQ(tlm.dropped(), 25u - 16u);
+}
+
+// Traced bank loops report the same samples as base_pid
+TEST(pid_telemetry, BankMatchesBasePid) {
+
+  const size_t n = 200;
+  std::mt19937 gen(13);
+  std::uniform_real_distribution<float> val(-10, 10);
+  std::uniform_int_distribution<int> coin(0, 99);
+
+  std::vector<float> pv(n), sp(n), tb(n), co(n);
+  std::vector<base_pid> ref;
+  std::vector<std::unique_ptr<pid_telemetry<float>>> rings;
+  pid_bank bank(n);
+  pid_telemetry<float> tlm(n * 4);
+  ref.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    float kdv = (i % 3 == 0) ? 0.002f : 0.0f;
+    bool db_on = i % 5 == 0;
+    ref.emplace_back(&pv[i], &sp[i], &co[i], &tb[i], 0.7f, 35.0f, kdv, 0.5f,
+                     -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__, -5.0f, 5.0f, db_on, false, 1 + i % 4);
+    bank.set_loop(i, 0.7f, 35.0f, kdv, 0.5f, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                  -5.0f, 5.0f, db_on, false, 1 + i % 4);
+    rings.emplace_back(new pid_telemetry<float>(16));
+    // More traced loops than one trace chunk
+    if (i % 2 == 0) {
+      bank.trace_loop(i, true);
+      ref[i].set_telemetry(rings[i].get());
+    }
+  }
+  bank.trace_loop(0, false);
+  ref[0].set_telemetry(nullptr);
+  bank.set_telemetry(&tlm);
+  EXPECT_EQ(bank.trace_loop(n, true), -1);
+
+  for (uint64_t t = 1; t < 300; t++) {
+    for (size_t i = 0; i < n; i++) {
+      pv[i] = bank.pv_data()[i] = val(gen);
+      sp[i] = bank.sp_data()[i] = val(gen);
+      tb[i] = bank.tb_data()[i] = val(gen);
+      if (coin(gen) < 3) {
+        bool man_sw = coin(gen) < 50;
+        ref[i].set_man_param(man_sw);
+        bank.set_man_param(i, man_sw);
+      }
+      ref[i].run_pid(t * 3);
+    }
+    bank.step_all(t * 3);
+
+    pid_sample<float> s, r;
+    while (tlm.pop(s)) {
+      ASSERT_EQ(s.loop % 2, 0u);
+      ASSERT_NE(s.loop, 0u);
+      ASSERT_TRUE(rings[s.loop]->pop(r)) << "loop " << s.loop << " step " << t;
+      r.loop = s.loop;
+      ASSERT_EQ(std::memcmp(&s, &r, sizeof(s)), 0) << "loop " << s.loop << " step " << t;
+    }
+    for (size_t i = 0; i < n; i++) {
+      ASSERT_FALSE(rings[i]->pop(r)) << "loop " << i << " step " << t;
+    }
+  }
+  EXPECT_EQ(tlm.dropped(), 0u);
+}
+
+// A reader thread drains while the controller runs, nothing is lost but the counted drops
+TEST(pid_telemetry, Reader) {
+
+  float pv{0}, sp{1}, co{0}, kpv{1}, kiv{1}, kdv{0};
+  bool man_sw{false};
+  base_pid pid(&pv, &sp, &co);
+  pid.set_gain_param(kpv, kiv, kdv);
+  pid.set_man_param(man_sw);
+  pid_telemetry<float> tlm(256);
+  pid.set_telemetry(&tlm);
+  std::atomic<bool> done{false};
+  uint64_t received = 0, last = 0;
+  bool ordered = true;
+
+  std::thread reader([&] {
+    pid_sample<float> s[64];
+    for (;;) {
+      bool stop = done.load();
+      size_t k = tlm.drain(s, 64);
+      for (size_t j = 0; j < k; j++) {
+        ordered = ordered && s[j].tstamp > last;
+        last = s[j].tstamp;
+      }
+      received += k;
+      if (stop && k == 0) {
+        break;
+      }
+      if (k == 0) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  const uint64_t steps = 200000;
+  for (uint64_t t = 1; t <= steps; t++) {
+    pid.run_pid(t * 10);
+  }
+  done = true;
+  reader.join();
+
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(received + tlm.dropped(), steps);
+}
+}  // namespace
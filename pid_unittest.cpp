@@ -1,6 +1,14 @@
 #include "pid.hpp"
 #include "gtest/gtest.h"
 
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace {
 // Constructors
 TEST(base_pid, Constructors) {
@@ -84,4 +92,499 @@ TEST(base_pid, Execution) {
   EXPECT_FLOAT_EQ(tco2, 2000);
   EXPECT_FLOAT_EQ(tco3, -2001);
 }
+// Gain limits, a large kp passes, a kd that overflows when reduced to usec does not
+TEST(base_pid, GainLimits) {
+
+  float pv{0}, sp{1}, co{0};
+  float kpv{1.0e33f}, kiv{1}, kdv{1}, kdbig{1.0e33f}, kpv1{1};
+  base_pid pid(&pv, &sp, &co);
+  EXPECT_EQ(pid.set_gain_param(kpv, kiv, kdv), 0);
+  EXPECT_EQ(pid.set_gain_param(kpv1, kiv, kdbig), -1);
+  kdbig = -kdbig;
+  EXPECT_EQ(pid.set_gain_param(kpv1, kiv, kdbig), -1);
+}
+
+// Double precision runs the same scenario as float
+TEST(base_pid, Double) {
+
+  double tpv{0}, tsp{1}, tco{0}, ttb{2};
+  bool man_sw{false};
+
+  base_pid_d pidPID(&tpv, &tsp, &tco, &ttb, 1, 1, 1, 0);
+  pidPID.set_man_param(man_sw);
+  pidPID.run_pid(1000);
+  EXPECT_DOUBLE_EQ(tco, 1001.001);
+
+  tsp = -1;
+  pidPID.run_pid(2000);
+  EXPECT_NEAR(tco, -2001, 1.0e-9);
+}
+
+// Saturating Q-format arithmetic
+TEST(base_pid, FixedPointArithmetic) {
+
+  q15 half(0.5), quarter(0.25), one(1.0), mone(-1.0);
+
+  EXPECT_EQ(one, q15::max());
+  EXPECT_EQ(mone, q15::lowest());
+  EXPECT_EQ((half * half).v, quarter.v);
+  EXPECT_EQ(half + half, q15::max());
+  EXPECT_EQ(mone - half, q15::lowest());
+  EXPECT_EQ(mone * mone, q15::max());
+  EXPECT_EQ(-mone, q15::max());
+  EXPECT_EQ(q15(NAN), q15());
+  EXPECT_NEAR((double)q31(-0.3), -0.3, 1.0e-9);
+}
+
+// Q15 and Q31 controllers, signals and gains in [-1, 1)
+TEST(base_pid, FixedPoint) {
+
+  q15 pv15(0.0), sp15(0.5), co15, tb15(0.25);
+  q31 pv31(0.0), sp31(0.5), co31, tb31(0.25);
+  bool man_sw{false};
+
+  // Manual mode, CO == Tieback
+  base_pid_q15 pid15(&pv15, &sp15, &co15, &tb15, q15(0.5), q15(0.5), q15(0.0), q15(0.0));
+  base_pid_q31 pid31(&pv31, &sp31, &co31, &tb31, q31(0.5), q31(0.5), q31(0.0), q31(0.0));
+  EXPECT_EQ(pid15.run_pid(1000), 0);
+  EXPECT_EQ(pid31.run_pid(1000), 0);
+  EXPECT_EQ(co15, tb15);
+  EXPECT_EQ(co31, tb31);
+
+  // Bumpless switch to Auto: CO = Iterm + kp * err + ki * err * dt
+  //                              = 0.25 + 0.25 + 0.5 * 0.5 * 0.1 = 0.525
+  pid15.set_man_param(man_sw);
+  pid31.set_man_param(man_sw);
+  pid15.run_pid(101000);
+  pid31.run_pid(101000);
+  EXPECT_NEAR((double)co15, 0.525, 1.0e-4);
+  EXPECT_NEAR((double)co31, 0.525, 1.0e-8);
+
+  // The integrator saturates instead of wrapping around
+  for (uint64_t t = 1; t <= 100; t++) {
+    pid15.run_pid(101000 + t * 1000000);
+    pid31.run_pid(101000 + t * 1000000);
+  }
+  EXPECT_EQ(co15, q15::max());
+  EXPECT_EQ(co31, q31::max());
+
+  // Gains are kept unscaled
+  q15 kpv, kiv, kdv;
+  pid15.get_gain_param(kpv, kiv, kdv);
+  EXPECT_EQ(kiv, q15(0.5));
+}
+
+// Fixed-rate mode, precomputed coefficients on the period, fallback or fault on drift
+TEST(base_pid, FixedRate) {
+
+  float pv{0}, sp{1}, co{0}, pvv{0}, cov{0};
+  float kpv{1}, kiv{2}, kdv{0.01f};
+  uint64_t per{1000}, tol{50}, off{DT_RATE_OFF}, rp, rt;
+  bool fault{false}, rf, man_sw{false};
+  base_pid fixed(&pv, &sp, &co);
+  base_pid var(&pvv, &sp, &cov);
+  for (base_pid* p : {&fixed, &var}) {
+    p->set_gain_param(kpv, kiv, kdv);
+    p->set_man_param(man_sw);
+  }
+
+  EXPECT_EQ(fixed.set_rate_param(per, per, fault), -1);
+  ASSERT_EQ(fixed.set_rate_param(per, tol, fault), 0);
+  fixed.get_rate_param(rp, rt, rf);
+  EXPECT_EQ(rp, per);
+  EXPECT_EQ(rt, tol);
+  EXPECT_FALSE(rf);
+
+  // Jitter within the tolerance steps on the nominal period, the same result up
+  // to rounding as the measured dt of a strict clock
+  uint64_t t = 5000;
+  for (int k = 0; k < 200; k++) {
+    t += 1000;
+    pv = pvv = std::sin((float)k * 0.1f);
+    EXPECT_EQ(fixed.run_pid(t + (uint64_t)(k % 5) * 10), 0);
+    var.run_pid(t);
+    ASSERT_NEAR(co, cov, 1.0e-4f * (1.0f + std::fabs(cov))) << "step " << k;
+  }
+
+  // New gains recalculate the coefficients
+  kiv = 4;
+  fixed.set_gain_param(kpv, kiv, kdv);
+  var.set_gain_param(kpv, kiv, kdv);
+  t += 1000;
+  fixed.run_pid(t);
+  var.run_pid(t);
+  EXPECT_NEAR(co, cov, 1.0e-4f * (1.0f + std::fabs(cov)));
+
+  // Drifted steps fall back to the measured dt, bit-identical from the same state
+  pid_state<float> st;
+  var.get_state(st);
+  fixed.set_state(st);
+  for (int k = 0; k < 20; k++) {
+    t += 3000 + (uint64_t)k;
+    pv = pvv = (float)k;
+    EXPECT_EQ(fixed.run_pid(t), 0);
+    var.run_pid(t);
+    ASSERT_EQ(co, cov) << "step " << k;
+  }
+  EXPECT_EQ(fixed.get_rate_faults(), 0u);
+
+  // The drift fault holds CO and resynchronises on the late step
+  fault = true;
+  ASSERT_EQ(fixed.set_rate_param(per, tol, fault), 0);
+  float held = co;
+  pv = 100;
+  EXPECT_EQ(fixed.run_pid(t + 5000), -1);
+  EXPECT_EQ(co, held);
+  EXPECT_EQ(fixed.get_rate_faults(), 1u);
+  EXPECT_EQ(fixed.run_pid(t + 6000), 0);
+  EXPECT_NE(co, held);
+
+  // Off again, any dt runs on the measured dt
+  ASSERT_EQ(fixed.set_rate_param(off, tol, fault), 0);
+  EXPECT_EQ(fixed.run_pid(t + 60000), 0);
+  EXPECT_EQ(fixed.get_rate_faults(), 1u);
+
+  // Q15 on the period stays close to the variable path
+  q15 qpv(0.0), qsp(0.5), qco, qcov, qkp(0.5), qki(0.5), qkd(0.0);
+  base_pid_q15 qf(&qpv, &qsp, &qco, nullptr, qkp, qki, qkd, q15(0.0));
+  base_pid_q15 qv(&qpv, &qsp, &qcov, nullptr, qkp, qki, qkd, q15(0.0));
+  uint64_t qper{100000};
+  fault = false;
+  ASSERT_EQ(qf.set_rate_param(qper, tol, fault), 0);
+  qf.set_man_param(man_sw);
+  qv.set_man_param(man_sw);
+  for (uint64_t k = 1; k <= 5; k++) {
+    qf.run_pid(k * qper);
+    qv.run_pid(k * qper);
+    EXPECT_NEAR((double)qco, (double)qcov, 1.0e-3);
+  }
+}
+
+// A trace through process() gives bit-identical outputs and state to run_pid per sample
+TEST(base_pid, Process) {
+
+  const size_t n = 600;
+  float pv{0}, sp{0}, co{0}, tb{1.5f}, cov[n];
+  float kpv{1.5f}, kiv{2}, kdv{0.01f}, dbv{0.05f};
+  uint64_t t[n], dtm{300}, per{1000}, tol{50};
+  float pvs[n], sps[n];
+  bool man_sw{true}, db_sw{true}, fault{true};
+  base_pid ref(&pv, &sp, &co, &tb);
+  base_pid blk(&pv, &sp, &co, &tb);
+  for (base_pid* p : {&ref, &blk}) {
+    p->set_gain_param(kpv, kiv, kdv);
+    p->set_db_param(dbv, db_sw);
+    p->set_dtmin_param(dtm);
+    p->set_rate_param(per, tol, fault);
+  }
+
+  // Irregular time, skipped steps and drifted ones
+  uint64_t ts = 1000;
+  for (size_t k = 0; k < n; k++) {
+    ts += (k % 7 == 0) ? 100 : (k % 11 == 0) ? 2500 : 1000 + (uint64_t)(k % 3) * 20;
+    t[k] = ts;
+    pvs[k] = std::sin((float)k * 0.05f);
+    sps[k] = (k % 200 < 100) ? 0.5f : -0.5f;
+  }
+
+  // Manual for the first half, then Auto
+  for (size_t h = 0; h < 2; h++) {
+    size_t k0 = h * n / 2, k1 = k0 + n / 2;
+    ref.set_man_param(man_sw);
+    blk.set_man_param(man_sw);
+    int rc = 0;
+    for (size_t k = k0; k < k1; k++) {
+      pv = pvs[k];
+      sp = sps[k];
+      rc |= ref.run_pid(t[k]);
+      cov[k] = co;
+    }
+    float want[n / 2];
+    std::memcpy(want, cov + k0, sizeof(want));
+    co = -7;
+    EXPECT_EQ(blk.process(t + k0, pvs + k0, sps + k0, cov + k0, n / 2), rc);
+    EXPECT_EQ(co, -7);
+    EXPECT_EQ(std::memcmp(want, cov + k0, sizeof(want)), 0);
+    man_sw = false;
+  }
+  EXPECT_EQ(blk.get_rate_faults(), ref.get_rate_faults());
+  EXPECT_GT(ref.get_rate_faults(), 0u);
+
+  pid_state<float> sr, sb;
+  ref.get_state(sr);
+  blk.get_state(sb);
+  EXPECT_EQ(sr.lts, sb.lts);
+  EXPECT_EQ(sr.Iterm, sb.Iterm);
+  EXPECT_EQ(sr.lerr, sb.lerr);
+  EXPECT_EQ(sr.lco, sb.lco);
+  EXPECT_EQ(sr.lman_on, sb.lman_on);
+
+  // Null arrays are rejected, an empty trace is not
+  EXPECT_EQ(blk.process(nullptr, pvs, sps, cov, 1), -1);
+  EXPECT_EQ(blk.process(nullptr, nullptr, nullptr, nullptr, 0), 0);
+
+  // A controller that cannot step leaves CO as run_pid does
+  float cob{2.5f};
+  base_pid bad(&pv, &sp, &cob, &tb, 1, 0, 0, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+               -__FLT_MAX__, __FLT_MAX__, false, false, 0);
+  EXPECT_EQ(bad.process(t, pvs, sps, cov, 2), -1);
+  EXPECT_EQ(cov[0], 2.5f);
+  EXPECT_EQ(cov[1], 2.5f);
+}
+
+// pid_step on a plain config and state is bit-identical to run_pid, states stepped on
+// several threads at once do not disturb each other
+TEST(base_pid, Step) {
+
+  const size_t n = 400;
+  float pv{0}, sp{0}, co{0}, tb{1.5f};
+  float kpv{1.5f}, kiv{2}, kdv{0.01f}, dbv{0.05f}, lo{-1}, hi{1};
+  uint64_t dtm{300};
+  bool man_sw{true}, db_sw{true};
+  base_pid ref(&pv, &sp, &co, &tb);
+  ref.set_gain_param(kpv, kiv, kdv);
+  ref.set_db_param(dbv, db_sw);
+  ref.set_dtmin_param(dtm);
+  ref.set_cp_limits(lo, hi);
+
+  pid_step_config<float> c{dtm, kpv, pid_traits<float>::ki_set(kiv), pid_traits<float>::kd_set(kdv),
+                           dbv, lo, hi, db_sw, man_sw};
+  pid_state<float> s, s0;
+  ref.get_state(s);
+  s0 = s;
+
+  // Manual for the first quarter, then Auto through the limits, the Deadband and
+  // skipped steps
+  std::vector<uint64_t> t(n);
+  std::vector<float> pvs(n), sps(n), want(n);
+  uint64_t ts = 1000;
+  for (size_t k = 0; k < n; k++) {
+    ts += (k % 7 == 0) ? 100 : 1000 + (uint64_t)(k % 3) * 20;
+    t[k] = ts;
+    pvs[k] = std::sin((float)k * 0.05f);
+    sps[k] = (k % 100 < 50) ? 2.0f : -0.5f;
+  }
+  for (size_t k = 0; k < n; k++) {
+    if (k == n / 4) {
+      man_sw = c.man_on = false;
+      ref.set_man_param(man_sw);
+    }
+    pv = pvs[k];
+    sp = sps[k];
+    EXPECT_EQ(ref.run_pid(t[k]), 0);
+    want[k] = co;
+    pid_outputs<float> o = pid_step(c, s, pid_inputs<float>{t[k], pvs[k], sps[k], tb, false, false});
+    EXPECT_EQ(o.rc, 0);
+    ASSERT_EQ(o.co, co) << "step " << k;
+  }
+  pid_state<float> sr;
+  ref.get_state(sr);
+  EXPECT_EQ(sr.lts, s.lts);
+  EXPECT_EQ(sr.Iterm, s.Iterm);
+  EXPECT_EQ(sr.lerr, s.lerr);
+  EXPECT_EQ(sr.lco, s.lco);
+  EXPECT_EQ(sr.lman_on, s.lman_on);
+
+  // The same trace on four threads, each with its own state
+  std::vector<std::vector<float>> got(4, std::vector<float>(n));
+  std::vector<std::thread> thr;
+  for (size_t j = 0; j < got.size(); j++) {
+    thr.emplace_back([&, j]() {
+      pid_step_config<float> cj = c;
+      pid_state<float> sj = s0;
+      for (size_t k = 0; k < n; k++) {
+        cj.man_on = k < n / 4;
+        got[j][k] = pid_step(cj, sj, pid_inputs<float>{t[k], pvs[k], sps[k], tb, false, false}).co;
+      }
+    });
+  }
+  for (std::thread& th : thr) {
+    th.join();
+  }
+  for (size_t j = 0; j < got.size(); j++) {
+    EXPECT_EQ(std::memcmp(got[j].data(), want.data(), n * sizeof(float)), 0) << "thread " << j;
+  }
+
+  // Traced and clean steps give the CO and the state of the plain step, a clean step
+  // has the inputs of the last one
+  pid_inputs<float> in{s.lts + 1000, 0.25f, 0.5f, tb, false, false};
+  pid_step(c, s, in);
+  in.tstamp += 1000;
+  pid_state<float> sa = s, sb = s, sc = s;
+  pid_outputs<float> oa = pid_step(c, sa, in);
+  pid_outputs<float> ob = pid_step<true>(c, sb, in);
+  in.clean = true;
+  pid_outputs<float> oc = pid_step<true>(c, sc, in);
+  EXPECT_EQ(oa.co, ob.co);
+  EXPECT_EQ(oa.co, oc.co);
+  EXPECT_EQ(sa.Iterm, sb.Iterm);
+  EXPECT_EQ(sa.Iterm, sc.Iterm);
+  EXPECT_EQ(sa.lerr, sc.lerr);
+  EXPECT_EQ(oa.flags, 0u);
+  EXPECT_EQ(ob.err, 0.25f);
+  EXPECT_EQ(ob.flags & PID_TLM_CLEAN, 0u);
+  EXPECT_NE(oc.flags & PID_TLM_CLEAN, 0u);
+  // Held, only CO is kept
+  in.tstamp += 1000;
+  in.hold = true;
+  oc = pid_step(c, sc, in);
+  EXPECT_EQ(oc.co, sc.lco);
+  EXPECT_EQ(sc.Iterm, sb.Iterm);
+
+  // A step inside the Time Slice keeps CO and the state
+  pid_state<float> held = s;
+  pid_outputs<float> o = pid_step(c, s, pid_inputs<float>{s.lts + 1, 5.0f, 0.0f, tb, false, false});
+  EXPECT_FALSE(o.stepped);
+  EXPECT_EQ(o.co, held.lco);
+  EXPECT_EQ(s.lts, held.lts);
+  EXPECT_EQ(s.Iterm, held.Iterm);
+}
+
+// Change-driven modes give the outputs of every-step recomputation on sparse inputs
+TEST(base_pid, EventDriven) {
+
+  const int n = 3000;
+  float pv{0}, sp{0.5f}, co[3], tb{0.2f};
+  float kpv{0.8f}, kiv{3}, kdv{0.002f}, ll{-1}, hl{1}, dbv{0.3f}, ki0{0};
+  uint8_t modes[3] = {PID_EV_OFF, PID_EV_COMPARE, PID_EV_DIRTY}, bad{3}, got;
+  bool man_sw{true}, db_sw{false};
+  base_pid pid[3] = {base_pid(&pv, &sp, &co[0], &tb), base_pid(&pv, &sp, &co[1], &tb),
+                     base_pid(&pv, &sp, &co[2], &tb)};
+  pid_telemetry<float> tlm(8192);
+  for (int j = 0; j < 3; j++) {
+    pid[j].set_gain_param(kpv, kiv, kdv);
+    pid[j].set_cp_limits(ll, hl);
+    pid[j].set_man_param(man_sw);
+    ASSERT_EQ(pid[j].set_event_param(modes[j]), 0);
+  }
+  EXPECT_EQ(pid[1].set_event_param(bad), -1);
+  pid[1].get_event_param(got);
+  EXPECT_EQ(got, PID_EV_COMPARE);
+  pid[1].set_telemetry(&tlm);
+
+  std::mt19937 gen(23);
+  std::uniform_real_distribution<float> val(-1, 1);
+  for (int k = 0; k < n; k++) {
+    // PV moves one step out of 10, SP now and then
+    bool moved = false;
+    if (k % 10 == 0) {
+      pv = 0.3f * val(gen);
+      moved = true;
+    }
+    if (k % 700 == 350) {
+      sp = (k < 1500) ? 5.0f : 0.5f;   // Saturated, then back
+      moved = true;
+    }
+    for (int j = 0; j < 3; j++) {
+      if (k == 100) {
+        man_sw = false;
+        pid[j].set_man_param(man_sw);
+      }
+      if (k == 1800) {
+        db_sw = true;
+        pid[j].set_db_param(dbv, db_sw);
+      }
+      if (k == 2400) {
+        pid[j].set_gain_param(kpv, ki0, kdv);
+      }
+      if (moved && j == 2) {
+        pid[j].set_dirty();
+      }
+      pid[j].run_pid((uint64_t)(k + 1) * 1000 + (uint64_t)(k % 3) * 7);
+    }
+    ASSERT_EQ(std::memcmp(&co[0], &co[1], sizeof(float)), 0) << "step " << k;
+    ASSERT_EQ(std::memcmp(&co[0], &co[2], sizeof(float)), 0) << "step " << k;
+  }
+  pid_state<float> s0, s1;
+  pid[0].get_state(s0);
+  for (int j = 1; j < 3; j++) {
+    pid[j].get_state(s1);
+    EXPECT_EQ(s0.Iterm, s1.Iterm);
+    EXPECT_EQ(s0.lerr, s1.lerr);
+    EXPECT_EQ(s0.lco, s1.lco);
+  }
+
+  // Most steps were clean, many of them only kept CO
+  pid_sample<float> smp;
+  int nclean = 0, nheld = 0;
+  while (tlm.pop(smp)) {
+    nclean += (smp.flags & PID_TLM_CLEAN) ? 1 : 0;
+    nheld += ((smp.flags & PID_TLM_CLEAN) && smp.p == 0 && smp.err != 0) ? 1 : 0;
+  }
+  EXPECT_GT(nclean, n * 8 / 10);
+  EXPECT_GT(nheld, n / 4);
+}
+
+// The plain step over the hot line, with CO before PV, follows the full step of a traced
+// controller bit by bit, in and out of Manual mode and within the Time Slice
+TEST(base_pid, PlainStep) {
+
+  float io[3] = {0, 0, 0.5f};   // CO, PV, SP
+  float pv{0}, sp{0.5f}, co{0}, tb{0.25f};
+  float kpv{0.8f}, kiv{3}, kdv{0.002f}, ll{-1}, hl{1};
+  bool man_sw{false};
+  base_pid plain(&io[1], &io[2], &io[0], &tb), full(&pv, &sp, &co, &tb);
+  pid_telemetry<float> tlm(16);
+  full.set_telemetry(&tlm);
+  for (base_pid* p : {&plain, &full}) {
+    p->set_gain_param(kpv, kiv, kdv);
+    p->set_cp_limits(ll, hl);
+    p->set_man_param(man_sw);
+  }
+
+  std::mt19937 gen(5);
+  std::uniform_real_distribution<float> val(-1, 1);
+  pid_sample<float> smp;
+  for (int k = 0; k < 2000; k++) {
+    if (k == 700 || k == 900) {
+      man_sw = (k == 700);
+      plain.set_man_param(man_sw);
+      full.set_man_param(man_sw);
+    }
+    io[1] = pv = 0.3f * val(gen);
+    // Every other step comes within the Time Slice
+    uint64_t t = (uint64_t)(k / 2 + 1) * 1000 + (uint64_t)(k % 2) * 5;
+    EXPECT_EQ(plain.run_pid(t), full.run_pid(t));
+    ASSERT_EQ(std::memcmp(&io[0], &co, sizeof(float)), 0) << "step " << k;
+    while (tlm.pop(smp)) {}
+  }
+}
+
+// Every object is one cache line, copies and moves take a cold block of their own
+TEST(base_pid, Layout) {
+
+  std::vector<base_pid> v(5);
+  for (const base_pid& p : v) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(&p) % PID_CACHE_LINE, 0u);
+  }
+
+  float pv{0}, sp{1}, co{0};
+  float ll{-5}, hl{5}, ll2{-1}, hl2{1}, rl, rh;
+  uint64_t per{1000}, tol{10}, rp, rt;
+  bool fault{true}, rf;
+  base_pid a(&pv, &sp, &co);
+  a.set_pv_limits(ll, hl);
+  a.set_rate_param(per, tol, fault);
+  base_pid b(a);
+  b.set_pv_limits(ll2, hl2);
+  a.get_pv_limits(rl, rh);
+  EXPECT_EQ(rl, ll);
+  EXPECT_EQ(rh, hl);
+  b.get_rate_param(rp, rt, rf);
+  EXPECT_EQ(rp, per);
+  EXPECT_EQ(rt, tol);
+  EXPECT_TRUE(rf);
+
+  base_pid c(std::move(b));
+  base_pid d(b);
+  d.get_rate_param(rp, rt, rf);
+  EXPECT_EQ(rp, per);
+  a = c;
+  a.get_pv_limits(rl, rh);
+  EXPECT_EQ(rl, ll2);
+  EXPECT_EQ(rh, hl2);
+  b = std::move(a);
+  b.get_pv_limits(rl, rh);
+  EXPECT_EQ(rh, hl2);
+}
 }  // namespace
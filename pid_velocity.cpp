@@ -0,0 +1,315 @@
+/**
+ * @file pid_velocity.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Velocity (incremental) form PID controller and bank
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ */
+
+#include "pid_bank.hpp"
+#include "pid_velocity.hpp"
+
+    /// @brief The Default constructor creates a controller that unable to run
+    ///        without farther configuration
+    template <typename T>
+    basic_vpid<T>::basic_vpid() :
+        basic_vpid(nullptr, nullptr, nullptr, nullptr)
+        {};
+
+    /// @brief The Constructor creates a velocity-form controller with zero gains and
+    ///        Manual mode enabled, the same defaults as basic_pid
+    /// @param ppv  Process variable pointer
+    /// @param psp  Setpoint pointer
+    /// @param pdco Control output increment pointer
+    /// @param ptie Tieback variable pointer, Default value is nullptr
+    template <typename T>
+    basic_vpid<T>::basic_vpid(T* ppv, T* psp, T* pdco, T* ptie) :
+        pv{ppv},            // Process variable Input
+        sp{psp},            // Setpoint Input
+        tb{ptie},           // Tieback Input
+        dco{pdco},          // Control Output increment
+        kp{},               // Proportional Gain
+        ki{},               // Integral Gain
+        kd{},               // Differential Gain
+        db{},               // Deadband
+        pvll{traits::lowest()}, // Process variable low limit
+        pvhl{traits::max()}, // Process variable high limit
+        spll{traits::lowest()}, // Setpoint low limit
+        sphl{traits::max()}, // Setpoint high limit
+        coll{traits::lowest()}, // Control output low limit
+        cohl{traits::max()}, // Control output high limit
+        dtmin{DT_MIN_PID},  // Minimum time interval between adjacent PID calculations expressed in usec
+        db_on{false},       // Deadband On/Off
+        man_on{true},       // Manual Mode On/Off
+
+        lts{0},             // The last calculation timestamp
+        lman_on{true},      // The last run Manual Mode On/Off
+        lerr{},             // The last calculated Error (sp - pv)
+        ld{},               // The last Differential term
+        lco{}               // Position
+        {};
+
+        /// @brief Get all tuning parameters
+        /// @param p - Referense to the parameter block
+    template <typename T>
+    void basic_vpid<T>::get_params(pid_params<T>& p) {
+        p.kp = kp;
+        p.ki = traits::ki_get(ki);
+        p.kd = traits::kd_get(kd);
+        p.db = db;
+        p.pvll = pvll;
+        p.pvhl = pvhl;
+        p.spll = spll;
+        p.sphl = sphl;
+        p.coll = coll;
+        p.cohl = cohl;
+        p.dtmin = dtmin;
+        p.db_on = db_on;
+    };
+
+        /// @brief Set all tuning parameters at once, the same checks as basic_pid::set_params
+        /// @param p - Referense to the parameter block
+        /// @return 0  - O'k
+        ///         -1 - Error, nothing is changed
+    template <typename T>
+    int basic_vpid<T>::set_params(const pid_params<T>& p) {
+        if (!pid_params_valid(p)) {
+            return -1;
+        }
+        kp = p.kp;
+        ki = traits::ki_set(p.ki);
+        kd = traits::kd_set(p.kd);
+        db = p.db;
+        pvll = p.pvll;
+        pvhl = p.pvhl;
+        spll = p.spll;
+        sphl = p.sphl;
+        coll = p.coll;
+        cohl = p.cohl;
+        dtmin = p.dtmin;
+        db_on = p.db_on;
+        return 0;
+    };
+
+        /// @brief Get Manual mode parameter
+        /// @param man_onv - Referense to the Manual mode switch
+    template <typename T>
+    void basic_vpid<T>::get_man_param(bool& man_onv) {
+        man_onv = man_on;
+    };
+
+        /// @brief Set Manual mode parameter
+        /// @param man_onv - Referense to the Manual mode switch
+    template <typename T>
+    void basic_vpid<T>::set_man_param(bool& man_onv) {
+        man_on = man_onv;
+    };
+
+        /// @brief Process the velocity-form calculation, *dco is the increment of this call
+        /// @param tstamp - Time, when the calculation is performed
+        /// @return 0  - O'k
+        ///         -1 - Error
+    template <typename T>
+    int basic_vpid<T>::run_pid(uint64_t tstamp) {
+        // Check process variables
+        if (pv == nullptr || sp == nullptr || dco == nullptr) {
+            return -1;
+        }
+
+        // No increment if no minimal time slice elapsed
+        uint64_t tmp_dt = tstamp - lts;
+        if (tmp_dt < dtmin) {
+            *dco = T();
+            return 0;
+        }
+
+        // Update lts
+        lts = tstamp;
+
+        // Manual mode, the position tracks the Tieback
+        if (man_on) {
+            T tmp_co = (tb == nullptr) ? lco : *tb;
+            lco = (tmp_co < coll) ? coll : (tmp_co > cohl) ? cohl : tmp_co;
+            *dco = T();
+            lman_on = true;
+            return 0;
+        }
+
+        T tmp_err = *sp - *pv;
+
+        // Bumpless, no P and D kick on the first step back from Manual mode
+        if (lman_on) {
+            lman_on = false;
+            lerr = tmp_err;
+            ld = T();
+        }
+
+        // Deadband, no increment
+        if (db_on && tmp_err < db) {
+            lerr = tmp_err;
+            *dco = T();
+            return 0;
+        }
+
+        // Increments of the P and D terms and the I term itself
+        T derr = tmp_err - lerr;
+        T d_term = traits::dterm(kd, derr, tmp_dt);
+        T delta = kp * derr;
+        delta += d_term - ld;
+        delta += traits::iterm(ki, tmp_err, tmp_dt);
+        lerr = tmp_err;
+        ld = d_term;
+
+        // The clamped position is the anti-windup
+        T pos = lco + delta;
+        pos = (pos < coll) ? coll : (pos > cohl) ? cohl : pos;
+        *dco = pos - lco;
+        lco = pos;
+        return 0;
+    };
+
+// Supported arithmetic types
+template class basic_vpid<float>;
+template class basic_vpid<double>;
+template class basic_vpid<q15>;
+template class basic_vpid<q31>;
+
+    /// @brief The Constructor creates a bank of nloops velocity-form controllers, every
+    ///        loop is configured as the vel_pid constructor does, Tieback is 0
+    /// @param nloops Number of loops
+    pid_vbank::pid_vbank(size_t nloops) :
+        n{nloops},
+        npad{(nloops + PID_BANK_LANES - 1) / PID_BANK_LANES * PID_BANK_LANES},
+        pv(npad, 0.0f),
+        sp(npad, 0.0f),
+        tb(npad, 0.0f),
+        dco(npad, 0.0f),
+        kp(npad, 0.0f),
+        ki(npad, 0.0f),
+        kd(npad, 0.0f),
+        db(npad, 0.0f),
+        pvll(npad, -__FLT_MAX__),
+        pvhl(npad, __FLT_MAX__),
+        spll(npad, -__FLT_MAX__),
+        sphl(npad, __FLT_MAX__),
+        coll(npad, -__FLT_MAX__),
+        cohl(npad, __FLT_MAX__),
+        dtmin(npad, DT_MIN_PID),
+        db_on(npad, 0),
+        man_on(npad, 1),
+        lts(npad, 0),
+        lman_on(npad, 1),
+        lerr(npad, 0.0f),
+        ld(npad, 0.0f),
+        lco(npad, 0.0f)
+        {};
+
+        /// @brief Get all tuning parameters
+        /// @param i - Loop number
+        /// @param p - Referense to the parameter block
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_vbank::get_params(size_t i, pid_params<float>& p) {
+        if (i >= n) {
+            return -1;
+        }
+        p.kp = kp[i];
+        p.ki = pid_traits<float>::ki_get(ki[i]);
+        p.kd = pid_traits<float>::kd_get(kd[i]);
+        p.db = db[i];
+        p.pvll = pvll[i];
+        p.pvhl = pvhl[i];
+        p.spll = spll[i];
+        p.sphl = sphl[i];
+        p.coll = coll[i];
+        p.cohl = cohl[i];
+        p.dtmin = dtmin[i];
+        p.db_on = db_on[i];
+        return 0;
+    };
+
+        /// @brief Set all tuning parameters at once, the loop state is kept
+        /// @param i - Loop number
+        /// @param p - Referense to the parameter block
+        /// @return 0  - O'k
+        ///         -1 - Error, nothing is changed
+    int pid_vbank::set_params(size_t i, const pid_params<float>& p) {
+        if (i >= n || !pid_params_valid(p)) {
+            return -1;
+        }
+        kp[i] = p.kp;
+        ki[i] = pid_traits<float>::ki_set(p.ki);
+        kd[i] = pid_traits<float>::kd_set(p.kd);
+        db[i] = p.db;
+        pvll[i] = p.pvll;
+        pvhl[i] = p.pvhl;
+        spll[i] = p.spll;
+        sphl[i] = p.sphl;
+        coll[i] = p.coll;
+        cohl[i] = p.cohl;
+        dtmin[i] = p.dtmin;
+        db_on[i] = p.db_on;
+        return 0;
+    };
+
+        /// @brief Get Manual mode parameter
+        /// @param i       - Loop number
+        /// @param man_onv - Referense to the Manual mode switch
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_vbank::get_man_param(size_t i, bool& man_onv) {
+        if (i >= n) {
+            return -1;
+        }
+        man_onv = man_on[i];
+        return 0;
+    };
+
+        /// @brief Set Manual mode parameter
+        /// @param i       - Loop number
+        /// @param man_onv - Referense to the Manual mode switch
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_vbank::set_man_param(size_t i, bool& man_onv) {
+        if (i >= n) {
+            return -1;
+        }
+        man_on[i] = man_onv;
+        return 0;
+    };
+
+        /// @brief Process all loops of the bank
+        /// @param tstamp - Time, when the calculation is performed
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_vbank::step_all(uint64_t tstamp) {
+        return step_range(tstamp, 0, n);
+    };
+
+        /// @brief Process loops [first, last) of the bank, the outputs are bit-identical
+        ///        to a vel_pid per loop
+        /// @param tstamp - Time, when the calculation is performed
+        /// @param first  - The first loop number
+        /// @param last   - The loop number after the last one
+        /// @return 0  - O'k
+        ///         -1 - Error
+    int pid_vbank::step_range(uint64_t tstamp, size_t first, size_t last) {
+        if (first > last || last > n) {
+            return -1;
+        }
+        pid_vkernel_run(view(), tstamp, first, last);
+        return 0;
+    };
+
+        /// @brief Raw column pointers for the stepping kernels
+        /// @return View of the bank columns
+    pid_vbank_view pid_vbank::view() {
+        return pid_vbank_view{pv.data(), sp.data(), tb.data(), dco.data(),
+                              kp.data(), ki.data(), kd.data(), db.data(),
+                              coll.data(), cohl.data(), dtmin.data(), db_on.data(), man_on.data(),
+                              lts.data(), lman_on.data(), lerr.data(), ld.data(), lco.data()};
+    };
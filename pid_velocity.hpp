@@ -0,0 +1,177 @@
+/**
+ * @file pid_velocity.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the velocity (incremental) form PID controller and bank
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ * The velocity form outputs the increment of CO for an actuator that integrates it
+ * downstream (a stepper, a motorised valve, a setpoint of another integrator):
+ *
+ *   dco = kp * (err - lerr) + (D - lD) + ki * err * dt,   D = kd * (err - lerr) / dt
+ *
+ * There is no Integral term to wind up. The controller tracks the position the
+ * increments add up to and clamps it to the CO limits, an increment is what is left
+ * after the clamp. The first step back from Manual mode starts the error history
+ * from the current error, so only the I part moves the actuator. Manual mode and the
+ * steps skipped by the Time Slice or the Deadband output 0.
+ */
+#ifndef _PID_VELOCITY_H
+#define _PID_VELOCITY_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pid.hpp"
+#include "pid_alloc.hpp"
+#include "pid_kernels.hpp"
+
+/// @brief Velocity-form PID controller over an arithmetic type T, see pid_traits
+template <typename T>
+class basic_vpid {
+
+    typedef pid_traits<T> traits;
+
+    protected :
+        T* pv;      // Process variable Input
+        T* sp;      // Setpoint Input
+        T* tb;      // Tieback Input, the actuator position tracked in Manual mode
+        T* dco;     // Control Output increment
+
+        T kp;       // Proportional Gain
+        T ki;       // Integral Gain, redused to usec by dividing by 1.0e+6
+        T kd;       // Differential Gain, redused to usec by multiplying by 1.0e+6
+        T db;       // Deadband
+        T pvll;     // Process variable low limit
+        T pvhl;     // Process variable high limit
+        T spll;     // Setpoint low limit
+        T sphl;     // Setpoint high limit
+        T coll;     // Control output low limit, of the position
+        T cohl;     // Control output high limit, of the position
+        uint64_t dtmin; // Minimum time interval between adjacent PID calculations expressed in us
+        bool db_on;     // Deadband On/Off
+        bool man_on;    // Manual Mode On/Off
+
+        uint64_t lts;   // The last calculation timestamp
+        bool lman_on;   // The last run Manual Mode On/Off
+        T lerr;     // The last calculated Error (sp - pv)
+        T ld;       // The last Differential term
+        T lco;      // Position the increments add up to
+
+    public:
+        typedef T value_type;
+
+        /// @brief Constructors
+        basic_vpid();
+        basic_vpid(T* ppv, T* psp, T* pdco, T* ptie = nullptr);
+
+        /// @brief Get all tuning parameters
+        void get_params(pid_params<T>& p);
+
+        /// @brief Set all tuning parameters at once, nothing is set if any of them is rejected
+        int set_params(const pid_params<T>& p);
+
+        /// @brief Get Manual mode parameter
+        void get_man_param(bool& man_onv);
+
+        /// @brief Set Manual mode parameter
+        void set_man_param(bool& man_onv);
+
+        /// @brief Position the increments add up to
+        T position() const { return lco; }
+
+        /// @brief Process the velocity-form calculation
+        int run_pid(uint64_t tstamp);
+};
+
+// The controller is instantiated once in pid_velocity.cpp for every supported type
+extern template class basic_vpid<float>;
+extern template class basic_vpid<double>;
+extern template class basic_vpid<q15>;
+extern template class basic_vpid<q31>;
+
+typedef basic_vpid<float> vel_pid;      // Velocity-form float-point PID controller
+typedef basic_vpid<double> vel_pid_d;   // Double precision
+
+/// @brief A bank of velocity-form float-point controllers stored as structure-of-arrays,
+///        every loop behaves exactly like a vel_pid and all of them are stepped by the
+///        SIMD kernel tier of pid_vkernel_run
+class pid_vbank {
+
+    size_t n;       // Number of loops
+    size_t npad;    // Number of loops rounded up to PID_BANK_LANES
+
+    protected :
+        // IO, owned by the bank
+        pid_vector<float> pv;       // Process variable Input
+        pid_vector<float> sp;       // Setpoint Input
+        pid_vector<float> tb;       // Tieback Input, 0 when not connected
+        pid_vector<float> dco;      // Control Output increment
+
+        // Configuration
+        pid_vector<float> kp;       // Proportional Gain
+        pid_vector<float> ki;       // Integral Gain, redused to usec by dividing by 1.0e+6
+        pid_vector<float> kd;       // Differential Gain, redused to usec by multiplying by 1.0e+6
+        pid_vector<float> db;       // Deadband
+        pid_vector<float> pvll;     // Process variable low limit
+        pid_vector<float> pvhl;     // Process variable high limit
+        pid_vector<float> spll;     // Setpoint low limit
+        pid_vector<float> sphl;     // Setpoint high limit
+        pid_vector<float> coll;     // Control output low limit, of the position
+        pid_vector<float> cohl;     // Control output high limit, of the position
+        pid_vector<uint64_t> dtmin; // Minimum time interval between adjacent PID calculations expressed in us
+        pid_vector<uint8_t> db_on;  // Deadband On/Off
+        pid_vector<uint8_t> man_on; // Manual Mode On/Off
+
+        // Dynamic state
+        pid_vector<uint64_t> lts;   // The last calculation timestamp
+        pid_vector<uint8_t> lman_on;// The last run Manual Mode On/Off
+        pid_vector<float> lerr;     // The last calculated Error (sp - pv)
+        pid_vector<float> ld;       // The last Differential term
+        pid_vector<float> lco;      // Position the increments add up to
+
+    public:
+        /// @brief Constructor
+        explicit pid_vbank(size_t nloops);
+
+        /// @brief Number of loops in the bank
+        size_t size() const { return n; }
+
+        /// @brief Column length including the padding loops
+        size_t padded_size() const { return npad; }
+
+        /// @brief IO columns, indexed by loop number
+        float* pv_data() { return pv.data(); }
+        float* sp_data() { return sp.data(); }
+        float* tb_data() { return tb.data(); }
+        const float* dco_data() const { return dco.data(); }
+
+        /// @brief Positions the increments add up to, indexed by loop number
+        const float* position_data() const { return lco.data(); }
+
+        /// @brief Get all tuning parameters
+        int get_params(size_t i, pid_params<float>& p);
+
+        /// @brief Set all tuning parameters at once, nothing is set if any of them is rejected
+        int set_params(size_t i, const pid_params<float>& p);
+
+        /// @brief Get Manual mode parameter
+        int get_man_param(size_t i, bool& man_onv);
+
+        /// @brief Set Manual mode parameter
+        int set_man_param(size_t i, bool& man_onv);
+
+        /// @brief Process all loops of the bank
+        int step_all(uint64_t tstamp);
+
+        /// @brief Process loops [first, last) of the bank
+        int step_range(uint64_t tstamp, size_t first, size_t last);
+
+        /// @brief Raw column pointers for the stepping kernels
+        pid_vbank_view view();
+};
+
+#endif /* _PID_VELOCITY_H */
@@ -0,0 +1,154 @@
+#include "pid_velocity.hpp"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+pid_params<float> params(float kpv, float kiv, float kdv, float collv, float cohlv) {
+
+  pid_params<float> p{kpv, kiv, kdv, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                      collv, cohlv, DT_MIN_PID, false};
+  return p;
+}
+
+// Bumpless start, increments add up to the positional terms, the clamp is the anti-windup
+TEST(vel_pid, Execution) {
+
+  float pv{0}, sp{0}, dco{0}, tb{2};
+  bool man_sw{false};
+  vel_pid pid(&pv, &sp, &dco, &tb);
+  ASSERT_EQ(pid.set_params(params(2, 1, 0, -10, 10)), 0);
+  EXPECT_EQ(pid.set_params(params(2, 1, 0, 10, -10)), -1);
+
+  // Manual mode tracks the Tieback and outputs no increment
+  EXPECT_EQ(pid.run_pid(1000), 0);
+  EXPECT_EQ(dco, 0);
+  EXPECT_EQ(pid.position(), 2);
+
+  // The first step back has no P kick, only ki * err * dt
+  pid.set_man_param(man_sw);
+  sp = 1;
+  EXPECT_EQ(pid.run_pid(2000), 0);
+  EXPECT_NEAR(dco, 0.001f, 1.0e-6f);
+
+  // Without D the position is the start, kp * (err - err0) and the sum of the I parts
+  float pos = 2.0f + dco, isum = 0.001f, err0 = 1;
+  for (uint64_t k = 1; k <= 50; k++) {
+    sp = std::sin((float)k * 0.3f);
+    pid.run_pid(2000 + k * 1000);
+    pos += dco;
+    isum += sp * 0.001f;
+  }
+  EXPECT_NEAR(pos, pid.position(), 1.0e-5f);
+  EXPECT_NEAR(pid.position(), 2.0f + 2.0f * (sp - err0) + isum, 1.0e-4f);
+
+  // The Time Slice gives a zero increment
+  EXPECT_EQ(pid.run_pid(52000), 0);
+  EXPECT_EQ(dco, 0);
+
+  // Saturation, the position stops at the limit and nothing winds up
+  sp = 1000;
+  for (uint64_t k = 1; k <= 100; k++) {
+    pid.run_pid(52000 + k * 1000);
+  }
+  EXPECT_EQ(pid.position(), 10);
+  EXPECT_EQ(dco, 0);
+  // and the way back starts on the next step
+  sp = -1;
+  pid.run_pid(153000);
+  EXPECT_EQ(dco, -20);
+  EXPECT_EQ(pid.position(), -10);
+
+  // No IO connected
+  vel_pid none;
+  EXPECT_EQ(none.run_pid(1000), -1);
+}
+
+// D acts on the change of the D term, a constant error rate gives no D increment
+TEST(vel_pid, Derivative) {
+
+  double pv{0}, sp{0}, dco{0};
+  bool man_sw{false};
+  vel_pid_d pid(&pv, &sp, &dco);
+  pid_params<double> p{0, 0, 1, 0, -__DBL_MAX__, __DBL_MAX__, -__DBL_MAX__, __DBL_MAX__,
+                       -__DBL_MAX__, __DBL_MAX__, DT_MIN_PID, false};
+  ASSERT_EQ(pid.set_params(p), 0);
+  pid.set_man_param(man_sw);
+  pid.run_pid(1000);
+
+  // Error ramps by 1 per msec, D jumps to kd * 1000 once
+  sp = 1;
+  pid.run_pid(2000);
+  EXPECT_NEAR(dco, 1000, 1.0e-9);
+  sp = 2;
+  pid.run_pid(3000);
+  EXPECT_NEAR(dco, 0, 1.0e-9);
+  sp = 2;
+  pid.run_pid(4000);
+  EXPECT_NEAR(dco, -1000, 1.0e-9);
+}
+
+// The bank matches vel_pid bit by bit on every kernel tier
+TEST(pid_vbank, MatchesVelPid) {
+
+  const size_t nloops = 45;
+  const pid_isa all[] = {pid_isa::scalar, pid_isa::sse42, pid_isa::avx2, pid_isa::avx512};
+  for (pid_isa isa : all) {
+    if (pid_isa_force(isa) != 0) {
+      continue;
+    }
+    std::mt19937 gen(19);
+    std::uniform_real_distribution<float> val(-10, 10);
+    std::uniform_real_distribution<float> gain(0, 2);
+    std::uniform_int_distribution<int> coin(0, 3);
+    std::uniform_int_distribution<uint64_t> step(1, 400);
+
+    pid_vbank bank(nloops);
+    std::vector<float> pv(nloops), sp(nloops), tb(nloops), dco(nloops);
+    std::vector<vel_pid> ref;
+    ref.reserve(nloops);
+    for (size_t i = 0; i < nloops; i++) {
+      pid_params<float> p = params(gain(gen), (coin(gen) == 0) ? 0 : gain(gen) * 100, gain(gen) * 1.0e-3f,
+                                   -5 - gain(gen), 5 + gain(gen));
+      p.db = gain(gen);
+      p.db_on = coin(gen) == 0;
+      p.dtmin = step(gen);
+      ref.emplace_back(&pv[i], &sp[i], &dco[i], &tb[i]);
+      ASSERT_EQ(ref[i].set_params(p), 0);
+      ASSERT_EQ(bank.set_params(i, p), 0);
+    }
+
+    // The first step sees a dt of about 2^40, beyond the fast int32 conversion
+    uint64_t tstamp = 1ULL << 40;
+    for (int cycle = 0; cycle < 1000; cycle++) {
+      tstamp += step(gen);
+      for (size_t i = 0; i < nloops; i++) {
+        pv[i] = bank.pv_data()[i] = (cycle == 500 && i % 7 == 0) ? NAN : val(gen);
+        sp[i] = bank.sp_data()[i] = (coin(gen) == 0) ? val(gen) * 1000 : val(gen);
+        tb[i] = bank.tb_data()[i] = val(gen);
+        if (coin(gen) == 0 && cycle % 50 == 0) {
+          bool man_sw = coin(gen) == 0;
+          ref[i].set_man_param(man_sw);
+          bank.set_man_param(i, man_sw);
+        }
+      }
+      for (size_t i = 0; i < nloops; i++) {
+        ref[i].run_pid(tstamp);
+      }
+      ASSERT_EQ(bank.step_all(tstamp), 0);
+      for (size_t i = 0; i < nloops; i++) {
+        float pos = ref[i].position();
+        ASSERT_EQ(std::memcmp(&dco[i], &bank.dco_data()[i], sizeof(float)), 0)
+            << pid_isa_name(isa) << " loop " << i << " cycle " << cycle;
+        ASSERT_EQ(std::memcmp(&pos, &bank.position_data()[i], sizeof(float)), 0)
+            << pid_isa_name(isa) << " loop " << i << " cycle " << cycle;
+      }
+    }
+    EXPECT_EQ(bank.step_range(tstamp, 3, nloops + 1), -1);
+  }
+  pid_isa_force(pid_isa_detect());
+}
+}  // namespace
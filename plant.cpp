@@ -0,0 +1,219 @@
+/**
+ * @file plant.cpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Process models used to test PID loops in closed loop
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "plant.hpp"
+
+    /// @brief Dead time in whole samples
+    static uint32_t delay_samples(double theta, double ts) {
+        return (theta > 0.0) ? (uint32_t)std::lround(theta / ts) : 0;
+    };
+
+    /// @brief Smallest power of two greater than ndelay
+    static uint32_t ring_size(uint32_t ndelay) {
+        uint32_t size = 1;
+        while (size <= ndelay) {
+            size <<= 1;
+        }
+        return size;
+    };
+
+        /// @param k     Process gain
+        /// @param tau   Time constant, sec
+        /// @param theta Dead time, sec
+        /// @param ts    Sample period, sec
+        /// @return The discrete model
+    plant_model plant_fopdt(double k, double tau, double theta, double ts) {
+        double c = 2.0 * tau / ts;
+        double b = k / (c + 1.0);
+        return plant_model{(float)b, (float)b, 0.0f, (float)((1.0 - c) / (1.0 + c)), 0.0f,
+                           delay_samples(theta, ts)};
+    };
+
+        /// @param k     Process gain
+        /// @param wn    Natural frequency, rad/sec
+        /// @param zeta  Damping ratio
+        /// @param theta Dead time, sec
+        /// @param ts    Sample period, sec
+        /// @return The discrete model
+    plant_model plant_sopdt(double k, double wn, double zeta, double theta, double ts) {
+        double c = 2.0 / ts;
+        double d0 = c * c + 2.0 * zeta * wn * c + wn * wn;
+        double d1 = 2.0 * (wn * wn - c * c);
+        double d2 = c * c - 2.0 * zeta * wn * c + wn * wn;
+        double b = k * wn * wn / d0;
+        return plant_model{(float)b, (float)(2.0 * b), (float)b, (float)(d1 / d0), (float)(d2 / d0),
+                           delay_samples(theta, ts)};
+    };
+
+        /// @param k     Process gain, output units per input unit per sec
+        /// @param theta Dead time, sec
+        /// @param ts    Sample period, sec
+        /// @return The discrete model
+    plant_model plant_integrating(double k, double theta, double ts) {
+        float b = (float)(k * ts / 2.0);
+        return plant_model{b, b, 0.0f, -1.0f, 0.0f, delay_samples(theta, ts)};
+    };
+
+        /// @param theta Dead time, sec
+        /// @param ts    Sample period, sec
+        /// @return The discrete model
+    plant_model plant_dead_time(double theta, double ts) {
+        return plant_model{1.0f, 0.0f, 0.0f, 0.0f, 0.0f, delay_samples(theta, ts)};
+    };
+
+    delay_line::delay_line(uint32_t ndelay) :
+        buf(ring_size(ndelay), 0.0f),
+        mask{ring_size(ndelay) - 1},
+        head{0},
+        delay{ndelay}
+        {};
+
+    void delay_line::reset() {
+        std::fill(buf.begin(), buf.end(), 0.0f);
+        head = 0;
+    };
+
+    plant::plant(const plant_model& model) :
+        m(model),
+        dl(model.delay),
+        s1{0.0f},
+        s2{0.0f}
+        {};
+
+    void plant::reset() {
+        dl.reset();
+        s1 = 0.0f;
+        s2 = 0.0f;
+    };
+
+    /// @brief The Constructor creates nplants plants, the delay rows are sized for max_delay
+    /// @param nplants   Number of plants
+    /// @param max_delay The longest dead time set_plant accepts, in samples
+    plant_bank::plant_bank(size_t nplants, uint32_t max_delay) :
+        n{nplants},
+        dmax{max_delay},
+        mask{ring_size(max_delay) - 1},
+        head{0},
+        b0(nplants, 0.0f),
+        b1(nplants, 0.0f),
+        b2(nplants, 0.0f),
+        a1(nplants, 0.0f),
+        a2(nplants, 0.0f),
+        s1(nplants, 0.0f),
+        s2(nplants, 0.0f),
+        delay(nplants, 0),
+        rows((size_t)ring_size(max_delay) * nplants, 0.0f),
+        x(nplants, 0.0f)
+        {};
+
+        /// @param i     Plant number
+        /// @param model The discrete model
+        /// @return 0  - O'k
+        ///         -1 - Error, no such plant or the dead time is longer than max_delay
+    int plant_bank::set_plant(size_t i, const plant_model& model) {
+        if (i >= n || model.delay > dmax) {
+            return -1;
+        }
+        b0[i] = model.b0;
+        b1[i] = model.b1;
+        b2[i] = model.b2;
+        a1[i] = model.a1;
+        a2[i] = model.a2;
+        delay[i] = model.delay;
+        s1[i] = 0.0f;
+        s2[i] = 0.0f;
+        for (size_t r = 0; r <= mask; r++) {
+            rows[r * n + i] = 0.0f;
+        }
+        return 0;
+    };
+
+        /// @param u Inputs, n values
+        /// @param y Outputs, n values, may be u
+    void plant_bank::step(const float* u, float* y) {
+        // row and base both point into rows, neither is restrict
+        float* row = &rows[(size_t)(head & mask) * n];
+        float* __restrict xs = x.data();
+        const float* base = rows.data();
+        const uint32_t* __restrict d = delay.data();
+
+        // Delay lines, the current row is written in full then every plant reads its own row
+        std::copy(u, u + n, row);
+        for (size_t i = 0; i < n; i++) {
+            xs[i] = base[(size_t)((head - d[i]) & mask) * n + i];
+        }
+        head++;
+
+        // Biquads, transposed direct form II
+        const float* __restrict pb0 = b0.data();
+        const float* __restrict pb1 = b1.data();
+        const float* __restrict pb2 = b2.data();
+        const float* __restrict pa1 = a1.data();
+        const float* __restrict pa2 = a2.data();
+        float* __restrict ps1 = s1.data();
+        float* __restrict ps2 = s2.data();
+        for (size_t i = 0; i < n; i++) {
+            float yi = pb0[i] * xs[i] + ps1[i];
+            ps1[i] = pb1[i] * xs[i] - pa1[i] * yi + ps2[i];
+            ps2[i] = pb2[i] * xs[i] - pa2[i] * yi;
+            y[i] = yi;
+        }
+    };
+
+    void plant_bank::reset() {
+        std::fill(s1.begin(), s1.end(), 0.0f);
+        std::fill(s2.begin(), s2.end(), 0.0f);
+        std::fill(rows.begin(), rows.end(), 0.0f);
+        head = 0;
+    };
+
+        /// @param pids    Controllers, at least plants.size() loops
+        /// @param plants  Plants
+        /// @param tstart  Timestamp of the first step, usec
+        /// @param period  Sample period, usec
+        /// @param nsteps  Number of steps
+        /// @return 0  - O'k
+        ///         -1 - Error, the bank is smaller than the plant bank
+    int run_closed_loop(pid_bank& pids, plant_bank& plants, uint64_t tstart, uint64_t period, size_t nsteps) {
+        if (pids.size() < plants.size()) {
+            return -1;
+        }
+        uint64_t tstamp = tstart;
+        for (size_t k = 0; k < nsteps; k++) {
+            pids.step_all(tstamp);
+            plants.step(pids.co_data(), pids.pv_data());
+            tstamp += period;
+        }
+        return 0;
+    };
+
+        /// @param pid     Controller
+        /// @param pv      Process variable the controller reads
+        /// @param co      Control Output the controller writes
+        /// @param p       Plant
+        /// @param tstart  Timestamp of the first step, usec
+        /// @param period  Sample period, usec
+        /// @param nsteps  Number of steps
+        /// @return 0  - O'k
+    int run_closed_loop(base_pid& pid, float& pv, const float& co, plant& p,
+                        uint64_t tstart, uint64_t period, size_t nsteps) {
+        uint64_t tstamp = tstart;
+        for (size_t k = 0; k < nsteps; k++) {
+            pid.run_pid(tstamp);
+            pv = p.step(co);
+            tstamp += period;
+        }
+        return 0;
+    };
@@ -0,0 +1,135 @@
+/**
+ * @file plant.hpp
+ * @author Yauheni Kalosha (kevmn07@gmail.com)
+ * @brief Header for the process models used to test PID loops in closed loop
+ * @version 0.1
+ * @date 2026-10-15
+ *
+ * SPDX_licencs_Identifier: GPL-3.0-or-later
+ * @copyright Copyright (c) 2023 Yauheni Kalosha
+ *
+ * Every model is a dead time (ring-buffer delay line on the input) followed by
+ * one biquad section, discretized with the bilinear transform at a fixed sample
+ * period Ts. First-order, second-order and integrating processes all fit that form.
+ */
+#ifndef _PLANT_H
+#define _PLANT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pid.hpp"
+#include "pid_alloc.hpp"
+#include "pid_bank.hpp"
+
+/// @brief Discrete process model, y = biquad(u delayed by delay samples)
+struct plant_model {
+    float b0, b1, b2;   // Numerator
+    float a1, a2;       // Denominator, a0 == 1
+    uint32_t delay;     // Dead time in samples
+};
+
+/// @brief First-order plus dead time, K / (tau*s + 1) * exp(-theta*s)
+plant_model plant_fopdt(double k, double tau, double theta, double ts);
+
+/// @brief Second-order plus dead time, K*wn^2 / (s^2 + 2*zeta*wn*s + wn^2) * exp(-theta*s)
+plant_model plant_sopdt(double k, double wn, double zeta, double theta, double ts);
+
+/// @brief Integrating process plus dead time, K / s * exp(-theta*s)
+plant_model plant_integrating(double k, double theta, double ts);
+
+/// @brief Pure dead time, exp(-theta*s)
+plant_model plant_dead_time(double theta, double ts);
+
+/// @brief Delay line of a fixed number of samples on a power-of-two ring buffer
+class delay_line {
+
+    pid_vector<float> buf;  // Ring buffer
+    uint32_t mask;          // Ring buffer size - 1
+    uint32_t head;          // Next write position
+    uint32_t delay;         // Delay in samples
+
+    public:
+        /// @brief Constructor, the line is filled with 0
+        explicit delay_line(uint32_t ndelay = 0);
+
+        /// @brief Push a sample and return the sample pushed ndelay steps ago
+        float step(float u) {
+            buf[head & mask] = u;
+            float y = buf[(head - delay) & mask];
+            head++;
+            return y;
+        }
+
+        /// @brief Refill the line with 0
+        void reset();
+};
+
+/// @brief A single process model, scalar form
+class plant {
+
+    plant_model m;  // Model
+    delay_line dl;  // Dead time
+    float s1, s2;   // Biquad state, transposed direct form II
+
+    public:
+        /// @brief Constructor, the process starts at rest
+        explicit plant(const plant_model& model);
+
+        /// @brief Apply the input of one sample period and return the new output
+        float step(float u) {
+            float x = dl.step(u);
+            float y = m.b0 * x + s1;
+            s1 = m.b1 * x - m.a1 * y + s2;
+            s2 = m.b2 * x - m.a2 * y;
+            return y;
+        }
+
+        /// @brief Bring the process back to rest
+        void reset();
+};
+
+/// @brief Many process models stepped together, structure-of-arrays form.
+///        The biquad loop vectorizes, the delay lines share one ring of rows,
+///        one row per sample with a column per plant.
+class plant_bank {
+
+    size_t n;           // Number of plants
+    uint32_t dmax;      // The longest dead time, in samples
+    uint32_t mask;      // Number of delay rows - 1
+    uint32_t head;      // Next row to write
+
+    pid_vector<float> b0, b1, b2, a1, a2;   // Biquad coefficients
+    pid_vector<float> s1, s2;               // Biquad state
+    pid_vector<uint32_t> delay;             // Dead time in samples
+    pid_vector<float> rows;                 // Delay rows, row r of plant i is rows[r * n + i]
+    pid_vector<float> x;                    // Delayed inputs of the current sample
+
+    public:
+        /// @brief Constructor, all plants are pure gains of 0 and at rest
+        plant_bank(size_t nplants, uint32_t max_delay);
+
+        /// @brief Number of plants
+        size_t size() const { return n; }
+
+        /// @brief Set the model of a plant and bring it to rest
+        int set_plant(size_t i, const plant_model& model);
+
+        /// @brief Apply u[i] for one sample period to every plant and write the new outputs to y[i]
+        void step(const float* u, float* y);
+
+        /// @brief Bring every plant back to rest
+        void reset();
+};
+
+/// @brief Run a PID bank against a plant bank in closed loop, plant i feeds PV of loop i
+///        and CO of loop i drives plant i. No IO is copied, the plants read CO and write
+///        PV in place.
+int run_closed_loop(pid_bank& pids, plant_bank& plants, uint64_t tstart, uint64_t period, size_t nsteps);
+
+/// @brief Run one controller against one plant in closed loop, pv and co are the variables
+///        the controller is connected to
+int run_closed_loop(base_pid& pid, float& pv, const float& co, plant& p,
+                    uint64_t tstart, uint64_t period, size_t nsteps);
+
+#endif /* _PLANT_H */
@@ -0,0 +1,123 @@
+#include "plant.hpp"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+// The delay line returns what was pushed exactly ndelay steps ago
+TEST(plant, DelayLine) {
+
+  delay_line d0(0), d5(5);
+
+  for (int k = 0; k < 20; k++) {
+    EXPECT_EQ(d0.step((float)k), (float)k);
+    EXPECT_EQ(d5.step((float)k), (k < 5) ? 0.0f : (float)(k - 5));
+  }
+  d5.reset();
+  EXPECT_EQ(d5.step(1), 0.0f);
+}
+
+// Step responses against the continuous models
+TEST(plant, StepResponse) {
+
+  const double ts = 0.001;
+
+  // FOPDT reaches 63.2 % of K one time constant after the dead time
+  plant fopdt(plant_fopdt(2.0, 0.1, 0.05, ts));
+  float y = 0;
+  for (int k = 0; k < 50; k++) {
+    EXPECT_EQ(fopdt.step(1), 0.0f);
+  }
+  for (int k = 0; k < 100; k++) {
+    y = fopdt.step(1);
+  }
+  EXPECT_NEAR(y, 2.0 * (1.0 - std::exp(-1.0)), 1e-2);
+
+  // Second order settles at K
+  plant sopdt(plant_sopdt(3.0, 20.0, 0.7, 0.0, ts));
+  for (int k = 0; k < 5000; k++) {
+    y = sopdt.step(1);
+  }
+  EXPECT_NEAR(y, 3.0, 1e-3);
+
+  // Integrating process ramps at K per sec
+  plant integ(plant_integrating(4.0, 0.0, ts));
+  for (int k = 0; k < 1000; k++) {
+    y = integ.step(1);
+  }
+  EXPECT_NEAR(y, 4.0, 1e-2);
+
+  plant dead(plant_dead_time(0.003, ts));
+  EXPECT_EQ(dead.step(1), 0.0f);
+  EXPECT_EQ(dead.step(2), 0.0f);
+  EXPECT_EQ(dead.step(3), 0.0f);
+  EXPECT_EQ(dead.step(4), 1.0f);
+}
+
+// The bank follows the scalar plants bit by bit
+TEST(plant, BankMatchesScalar) {
+
+  const double ts = 0.001;
+  plant_model models[] = {
+    plant_fopdt(2.0, 0.1, 0.05, ts),
+    plant_sopdt(3.0, 20.0, 0.3, 0.01, ts),
+    plant_integrating(4.0, 0.002, ts),
+    plant_dead_time(0.007, ts),
+  };
+  const size_t n = 4;
+  plant_bank bank(n, 64);
+  std::vector<plant> ref;
+  EXPECT_EQ(bank.set_plant(0, plant_dead_time(0.1, ts)), -1);
+  for (size_t i = 0; i < n; i++) {
+    EXPECT_EQ(bank.set_plant(i, models[i]), 0);
+    ref.emplace_back(models[i]);
+  }
+  EXPECT_EQ(bank.set_plant(n, models[0]), -1);
+
+  float u[n], y[n];
+  for (int k = 0; k < 1000; k++) {
+    for (size_t i = 0; i < n; i++) {
+      u[i] = std::sin(0.01f * (float)(k + i));
+    }
+    bank.step(u, y);
+    for (size_t i = 0; i < n; i++) {
+      float yr = ref[i].step(u[i]);
+      ASSERT_EQ(std::memcmp(&yr, &y[i], sizeof(float)), 0) << "plant " << i << " step " << k;
+    }
+  }
+}
+
+// PI loops bring FOPDT plants to the setpoint, the bank and base_pid agree
+TEST(plant, ClosedLoop) {
+
+  const double ts = 0.001;
+  const uint64_t period = 1000;
+  const size_t n = 20;
+  plant_model model = plant_fopdt(2.0, 0.1, 0.02, ts);
+
+  pid_bank pids(n);
+  plant_bank plants(n, 32);
+  for (size_t i = 0; i < n; i++) {
+    pids.set_loop(i, 0.5f, 2.0f, 0, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+                  -10, 10, false, false, 1);
+    pids.sp_data()[i] = 1.0f + (float)i * 0.1f;
+    plants.set_plant(i, model);
+  }
+  EXPECT_EQ(run_closed_loop(pids, plants, period, period, 5000), 0);
+  for (size_t i = 0; i < n; i++) {
+    EXPECT_NEAR(pids.pv_data()[i], 1.0f + (float)i * 0.1f, 1e-3);
+  }
+
+  float pv{0}, sp{1.5f}, co{0}, tb{0};
+  base_pid pid(&pv, &sp, &co, &tb, 0.5f, 2.0f, 0, 0, -__FLT_MAX__, __FLT_MAX__, -__FLT_MAX__, __FLT_MAX__,
+               -10, 10, false, false, 1);
+  plant p(model);
+  EXPECT_EQ(run_closed_loop(pid, pv, co, p, period, period, 5000), 0);
+  EXPECT_EQ(pv, pids.pv_data()[5]);
+
+  plant_bank small(n + 1, 0);
+  EXPECT_EQ(run_closed_loop(pids, small, 0, period, 1), -1);
+}
+}  // namespace